@@ -3,11 +3,15 @@
 
 #include <pybind11/eigen.h>
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/stl_bind.h>
 
+#include <interpolator/AntiCollisionScan.hpp>
 #include <interpolator/InterpolatorFactory.hpp>
+#include <interpolator/TrajectoryCursor.hpp>
+#include <interpolator/TrajectoryIndex.hpp>
 
 using namespace splines;
 namespace py = pybind11;
@@ -77,6 +81,45 @@ class PyIInterpolator : public IInterpolator
         PYBIND11_OVERLOAD_PURE(std::vector<double>, IInterpolator, num_points, num_threads);
     }
 
+    TrajectoryPoint point_at_position(double position) const override
+    {
+        PYBIND11_OVERLOAD_PURE(TrajectoryPoint, IInterpolator, point_at_position, position);
+    }
+
+    // the override of GeneratePoints returns a table, as the binding does, see below
+    std::vector<TrajectoryPoint> generate_points(std::size_t num_points, unsigned num_threads) const override;
+
+    // the consumer receives std::span, which has no type caster: the override of GenerateChunks gets a consumer of
+    // arrays, see below
+    void generate_chunks(
+        std::size_t num_points, std::size_t chunk_size, const ChunkConsumer &consumer, unsigned num_threads,
+        bool prefetch) const override;
+
+    // the overrides of GenerateVertices and GeneratePoints return tables, see below
+    std::vector<Vertex> generate_vertices(const PositionGrid &grid, unsigned num_threads) const override;
+
+    std::vector<TrajectoryPoint> generate_points(const PositionGrid &grid, unsigned num_threads) const override;
+
+    void generate_chunks(
+        const PositionGrid &grid, std::size_t chunk_size, const ChunkConsumer &consumer, unsigned num_threads,
+        bool prefetch) const override;
+
+    // the override of GenerateAdaptivePoints returns a table, see below
+    std::vector<TrajectoryPoint> generate_adaptive_points(
+        double max_chord_deviation, double max_angle, unsigned num_threads) const override;
+
+    // there is no type caster for std::span: the override of Evaluate gets and returns arrays, see below
+    void evaluate(
+        std::span<const double> positions, std::span<Vertex> vertices, std::span<Point> points,
+        unsigned num_threads) const override;
+
+    IntervalAggregates interval_aggregates(double first_position, double last_position) const override
+    {
+        PYBIND11_OVERLOAD_PURE_NAME(
+            IntervalAggregates, IInterpolator, "IntervalAggregates", interval_aggregates, first_position,
+            last_position);
+    }
+
     void add_n_drop(const Vertex &vertex) override
     {
         PYBIND11_OVERLOAD_PURE(void, IInterpolator, add_n_drop, vertex);
@@ -86,44 +129,321 @@ class PyIInterpolator : public IInterpolator
     {
         PYBIND11_OVERLOAD_PURE(void, IInterpolator, drop_n_add, vertex);
     }
+
+    void slide(const Vertex &vertex) override
+    {
+        PYBIND11_OVERLOAD_PURE_NAME(void, IInterpolator, "Slide", slide, vertex);
+    }
+
+  private:
+    /**
+     * @brief generate_points_table
+     * Calls the Python override of GeneratePoints, which returns the (N,6) table of the points
+     */
+    py::object generate_points_table(std::size_t num_points, unsigned num_threads) const
+    {
+        PYBIND11_OVERLOAD_PURE_NAME(
+            py::object, IInterpolator, "GeneratePoints", generate_points, num_points, num_threads);
+    }
+
+    py::object generate_points_table(const PositionGrid &grid, unsigned num_threads) const
+    {
+        PYBIND11_OVERLOAD_PURE_NAME(py::object, IInterpolator, "GeneratePoints", generate_points, grid, num_threads);
+    }
+
+    /**
+     * @brief generate_vertices_table
+     * Calls the Python override of GenerateVertices, which returns the (N,3) table of the vertices
+     */
+    py::object generate_vertices_table(const PositionGrid &grid, unsigned num_threads) const
+    {
+        PYBIND11_OVERLOAD_PURE_NAME(
+            py::object, IInterpolator, "GenerateVertices", generate_vertices, grid, num_threads);
+    }
+
+    /**
+     * @brief generate_adaptive_points_table
+     * Calls the Python override of GenerateAdaptivePoints, which returns the (N,6) table of the points
+     */
+    py::object generate_adaptive_points_table(double max_chord_deviation, double max_angle, unsigned num_threads) const
+    {
+        PYBIND11_OVERLOAD_PURE_NAME(
+            py::object, IInterpolator, "GenerateAdaptivePoints", generate_adaptive_points, max_chord_deviation,
+            max_angle, num_threads);
+    }
+
+    /**
+     * @brief evaluate_tables
+     * Calls the Python override of Evaluate, which returns the vertex and point tables of the positions
+     */
+    py::tuple evaluate_tables(const py::array_t<double> &positions, unsigned num_threads) const
+    {
+        PYBIND11_OVERLOAD_PURE_NAME(py::tuple, IInterpolator, "Evaluate", evaluate, positions, num_threads);
+    }
 };
 
-class PyBaseInterpolator : public BaseInterpolator
+/**
+ * @brief to_array
+ * Moves a std::vector into a NumPy array which takes the ownership of the buffer (no copy is made)
+ *
+ * @param values
+ * @return
+ * The (N,) array
+ */
+template <typename T> py::array_t<T> to_array(std::vector<T> &&values)
 {
-  public:
-    using BaseInterpolator::BaseInterpolator;
+    auto *buffer = new std::vector<T>(std::move(values));
+    auto owner = py::capsule(buffer, [](void *ptr) { delete static_cast<std::vector<T> *>(ptr); });
+    return py::array_t<T>(buffer->size(), buffer->data(), owner);
+}
 
-    double calculate_delta_x_projection(double position, const AdjacentVertices &adjacent_vertices) const override
+/**
+ * @brief to_arrays
+ * Moves every vector into a NumPy array (@see to_array)
+ *
+ * @param values
+ * @return
+ * A list with an array for each vector
+ */
+py::list to_arrays(std::vector<std::vector<double>> &&values)
+{
+    py::list arrays;
+    for (auto &array : values)
     {
-        PYBIND11_OVERLOAD_PURE(double, BaseInterpolator, calculate_delta_x_projection, position, adjacent_vertices);
+        arrays.append(to_array(std::move(array)));
     }
+    return arrays;
+}
+
+/**
+ * @brief to_table
+ * Moves records made only of doubles (Vertex, TrajectoryPoint) into a (N,M) NumPy array, M being the number of
+ * doubles of a record, e.g. the columns position, inclination and azimuth (rad) for Vertex. The array takes the
+ * ownership of the buffer (no copy is made)
+ *
+ * @param records
+ * @return
+ * The (N,M) array
+ */
+template <typename Record> py::array_t<double> to_table(std::vector<Record> &&records)
+{
+    static_assert(std::is_standard_layout_v<Record> && sizeof(Record) % sizeof(double) == 0);
+
+    auto *buffer = new std::vector<Record>(std::move(records));
+    auto owner = py::capsule(buffer, [](void *ptr) { delete static_cast<std::vector<Record> *>(ptr); });
+    return py::array_t<double>(
+        {buffer->size(), sizeof(Record) / sizeof(double)}, {sizeof(Record), sizeof(double)},
+        reinterpret_cast<const double *>(buffer->data()), owner);
+}
+
+/**
+ * @brief without_gil
+ * Runs a computation with the GIL released, so other Python threads run meanwhile. The computation must not touch
+ * Python objects; its result is converted afterwards, with the GIL held again
+ *
+ * @param computation
+ * @return
+ * The computation result
+ */
+template <typename Computation> auto without_gil(Computation computation)
+{
+    py::gil_scoped_release release;
+    return computation();
+}
+
+typedef py::array_t<double, py::array::c_style | py::array::forcecast> DoubleArray;
+
+/**
+ * @brief to_span
+ *
+ * @param array
+ * A contiguous float64 array
+ *
+ * @return
+ * A view of the array data
+ */
+std::span<const double> to_span(const DoubleArray &array)
+{
+    return {array.data(), static_cast<std::size_t>(array.size())};
+}
 
-    double calculate_delta_y_projection(double position, const AdjacentVertices &adjacent_vertices) const override
+/**
+ * @brief make_vertices
+ * Builds the trajectory from a (N,3) array with the columns position, inclination and azimuth
+ */
+Vertices make_vertices(const DoubleArray &table, AngleUnit angle_unit)
+{
+    if (table.ndim() != 2 || table.shape(1) != 3)
     {
-        PYBIND11_OVERLOAD_PURE(double, BaseInterpolator, calculate_delta_y_projection, position, adjacent_vertices);
+        throw std::invalid_argument("Vertices: the array must have the shape (N,3): position, inclination, azimuth");
     }
 
-    double calculate_delta_z_projection(double position, const AdjacentVertices &adjacent_vertices) const override
+    auto const rows = table.unchecked<2>();
+    std::vector<double> positions(rows.shape(0)), inclinations(rows.shape(0)), azimuths(rows.shape(0));
+    for (py::ssize_t i = 0; i < rows.shape(0); ++i)
     {
-        PYBIND11_OVERLOAD_PURE(double, BaseInterpolator, calculate_delta_z_projection, position, adjacent_vertices);
+        positions[i] = rows(i, 0);
+        inclinations[i] = rows(i, 1);
+        azimuths[i] = rows(i, 2);
     }
+    return Vertices(positions, inclinations, azimuths, angle_unit);
+}
 
-    double inclination_at_position(double position, const AdjacentVertices &adjacent_vertices) const override
+/**
+ * @brief make_points
+ * Builds the points from a (N,3) array with the columns x, y and z
+ */
+std::vector<Point> make_points(const DoubleArray &table)
+{
+    if (table.ndim() != 2 || table.shape(1) != 3)
     {
-        PYBIND11_OVERLOAD_PURE(double, BaseInterpolator, inclination_at_position, position, adjacent_vertices);
+        throw std::invalid_argument("Points: the array must have the shape (N,3): x, y, z");
     }
 
-    double azimuth_at_position(double position, const AdjacentVertices &adjacent_vertices) const override
+    auto const rows = table.unchecked<2>();
+    std::vector<Point> points(rows.shape(0));
+    for (py::ssize_t i = 0; i < rows.shape(0); ++i)
     {
-        PYBIND11_OVERLOAD_PURE(double, BaseInterpolator, azimuth_at_position, position, adjacent_vertices);
+        points[i] = {rows(i, 0), rows(i, 1), rows(i, 2)};
     }
+    return points;
+}
+
+/**
+ * @brief to_records
+ * A view of a (N,M) array as records made only of doubles, the inverse of to_table
+ *
+ * @param table
+ * @return
+ * The N records
+ */
+template <typename Record> std::span<const Record> to_records(const DoubleArray &table)
+{
+    static_assert(std::is_standard_layout_v<Record> && sizeof(Record) % sizeof(double) == 0);
 
-    double angle_at_position(
-        double position, const AdjacentVertices &adjacent_vertices, AngleType angle_type) const override
+    if (table.ndim() != 2 || table.shape(1) != static_cast<py::ssize_t>(sizeof(Record) / sizeof(double)))
     {
-        PYBIND11_OVERLOAD_PURE(double, BaseInterpolator, angle_at_position, position, adjacent_vertices, angle_type);
+        throw std::invalid_argument("to_records: the array must have a column per record value");
     }
-};
+    return {reinterpret_cast<const Record *>(table.data()), static_cast<std::size_t>(table.shape(0))};
+}
+
+/**
+ * @brief from_table
+ * Copies the records of a (N,M) table returned by a Python override, the inverse of to_table
+ *
+ * @param table
+ * @return
+ * The N records
+ */
+template <typename Record> std::vector<Record> from_table(const py::object &table)
+{
+    auto const array = table.cast<DoubleArray>();
+    auto const records = to_records<Record>(array);
+    return {records.begin(), records.end()};
+}
+
+std::vector<TrajectoryPoint> PyIInterpolator::generate_points(std::size_t num_points, unsigned num_threads) const
+{
+    // the C++ callers may have released the GIL (@see without_gil)
+    py::gil_scoped_acquire acquire;
+    return from_table<TrajectoryPoint>(this->generate_points_table(num_points, num_threads));
+}
+
+std::vector<Vertex> PyIInterpolator::generate_vertices(const PositionGrid &grid, unsigned num_threads) const
+{
+    py::gil_scoped_acquire acquire;
+    return from_table<Vertex>(this->generate_vertices_table(grid, num_threads));
+}
+
+std::vector<TrajectoryPoint> PyIInterpolator::generate_points(const PositionGrid &grid, unsigned num_threads) const
+{
+    py::gil_scoped_acquire acquire;
+    return from_table<TrajectoryPoint>(this->generate_points_table(grid, num_threads));
+}
+
+std::vector<TrajectoryPoint> PyIInterpolator::generate_adaptive_points(
+    double max_chord_deviation, double max_angle, unsigned num_threads) const
+{
+    py::gil_scoped_acquire acquire;
+    return from_table<TrajectoryPoint>(
+        this->generate_adaptive_points_table(max_chord_deviation, max_angle, num_threads));
+}
+
+void PyIInterpolator::evaluate(
+    std::span<const double> positions, std::span<Vertex> vertices, std::span<Point> points, unsigned num_threads) const
+{
+    // the C++ callers may have released the GIL (@see without_gil)
+    py::gil_scoped_acquire acquire;
+
+    auto const tables =
+        this->evaluate_tables(to_array(std::vector<double>(positions.begin(), positions.end())), num_threads);
+    auto const vertex_table = tables[0].cast<DoubleArray>();
+    auto const point_table = tables[1].cast<DoubleArray>();
+    auto const evaluated_vertices = to_records<Vertex>(vertex_table);
+    auto const evaluated_points = to_records<Point>(point_table);
+    if (evaluated_vertices.size() != positions.size() || evaluated_points.size() != positions.size())
+    {
+        throw std::invalid_argument("Evaluate: the override must return a vertex and a point per position");
+    }
+
+    if (!vertices.empty())
+    {
+        std::copy(evaluated_vertices.begin(), evaluated_vertices.end(), vertices.begin());
+    }
+    if (!points.empty())
+    {
+        std::copy(evaluated_points.begin(), evaluated_points.end(), points.begin());
+    }
+}
+
+/**
+ * @brief to_chunk_consumer
+ * Wraps a Python callable as the consumer of IInterpolator::generate_chunks. The callable gets the offset and arrays
+ * which own a copy of the chunk, since the buffers are reused; the GIL is acquired for every call
+ */
+ChunkConsumer to_chunk_consumer(const py::function &consumer)
+{
+    return [&consumer](std::size_t offset, std::span<const Vertex> vertices, std::span<const Point> points) {
+        py::gil_scoped_acquire acquire;
+        consumer(
+            offset, to_table(std::vector<Vertex>(vertices.begin(), vertices.end())),
+            to_table(std::vector<Point>(points.begin(), points.end())));
+    };
+}
+
+/**
+ * @brief from_chunk_consumer
+ * The inverse of to_chunk_consumer: wraps consumer as a callable for a Python override of GenerateChunks, which calls
+ * it with the offset and the (N,3) vertex and point tables of a chunk. It must not be kept after the GenerateChunks
+ * call, since consumer may refer to the state of the C++ caller
+ */
+auto from_chunk_consumer(const ChunkConsumer &consumer)
+{
+    return [consumer](std::size_t offset, const DoubleArray &vertices, const DoubleArray &points) {
+        consumer(offset, to_records<Vertex>(vertices), to_records<Point>(points));
+    };
+}
+
+void PyIInterpolator::generate_chunks(
+    std::size_t num_points, std::size_t chunk_size, const ChunkConsumer &consumer, unsigned num_threads,
+    bool prefetch) const
+{
+    auto const chunk_consumer = from_chunk_consumer(consumer);
+    PYBIND11_OVERLOAD_PURE_NAME(
+        void, IInterpolator, "GenerateChunks", generate_chunks, num_points, chunk_size,
+        py::cpp_function(chunk_consumer), num_threads, prefetch);
+}
+
+void PyIInterpolator::generate_chunks(
+    const PositionGrid &grid, std::size_t chunk_size, const ChunkConsumer &consumer, unsigned num_threads,
+    bool prefetch) const
+{
+    auto const chunk_consumer = from_chunk_consumer(consumer);
+    PYBIND11_OVERLOAD_PURE_NAME(
+        void, IInterpolator, "GenerateChunks", generate_chunks, grid, chunk_size, py::cpp_function(chunk_consumer),
+        num_threads, prefetch);
+}
 
 PYBIND11_MODULE(_interpolator, m)
 {
@@ -144,15 +464,44 @@ PYBIND11_MODULE(_interpolator, m)
                 ss << vt;
                 return ss.str();
             })
-        .def("Delimiter", &Vertex::delimiter)
+        .def("Delimiter", [](const Vertex &) { return VertexFormatter().delimiter(); })
         .def("ApproxEqual", &Vertex::approx_equal, py::arg("other"), py::arg("tol_radius") = 1E-6);
 
+    py::class_<VertexFormatter>(m, "VertexFormatter")
+        .def(py::init<std::string>(), py::arg("delimiter") = ",")
+        .def("Delimiter", &VertexFormatter::delimiter)
+        .def("Format", &VertexFormatter::to_string, py::arg("vertex"));
+
+    py::class_<Point>(m, "Point")
+        .def_readonly("x", &Point::x)
+        .def_readonly("y", &Point::y)
+        .def_readonly("z", &Point::z);
+
+    py::class_<TrajectoryPoint>(m, "TrajectoryPoint")
+        .def_readonly("vertex", &TrajectoryPoint::vertex)
+        .def_readonly("point", &TrajectoryPoint::point);
+
+    py::class_<IntervalAggregates>(m, "IntervalAggregates")
+        .def_readonly("lower", &IntervalAggregates::lower)
+        .def_readonly("upper", &IntervalAggregates::upper)
+        .def_readonly("max_dogleg", &IntervalAggregates::max_dogleg)
+        .def_readonly("max_dogleg_severity", &IntervalAggregates::max_dogleg_severity);
+
     py::class_<Vertices>(m, "Vertices")
         .def(py::init<>())
         .def(
             py::init<const std::vector<Vertex> &, AngleUnit>(), py::arg("vertex"),
             py::arg("angle_unit") = AngleUnit::rad)
-        .def("Vertices", &Vertices::vertices)
+        .def(
+            py::init([](const DoubleArray &positions, const DoubleArray &inclinations, const DoubleArray &azimuths,
+                        AngleUnit angle_unit) {
+                return without_gil([&]() {
+                    return Vertices(to_span(positions), to_span(inclinations), to_span(azimuths), angle_unit);
+                });
+            }),
+            py::arg("positions"), py::arg("inclinations"), py::arg("azimuths"), py::arg("angle_unit") = AngleUnit::rad)
+        .def(py::init(&make_vertices), py::arg("table"), py::arg("angle_unit") = AngleUnit::rad)
+        .def("Vertices", &Vertices::vertices_python)
         .def("VerticesSorted", &Vertices::vertices_python)
         .def(
             "SetVertices", &Vertices::set_vertices<std::vector<Vertex>>, py::arg("vertices"),
@@ -162,12 +511,49 @@ PYBIND11_MODULE(_interpolator, m)
             py::arg("angle_unit") = AngleUnit::rad)
         .def("AddNDrop", &Vertices::add_n_drop, py::arg("vertex"))
         .def("DropNAdd", &Vertices::drop_n_add, py::arg("vertex"))
+        .def("Slide", &Vertices::slide, py::arg("vertex"))
+        .def("SetCapacity", &Vertices::set_capacity, py::arg("capacity"))
+        .def("Capacity", &Vertices::capacity)
         .def("Size", &Vertices::size)
-        .def("Positions", &Vertices::positions)
-        .def("Inclinations", &Vertices::inclinations, py::arg("AngleUnit"))
-        .def("Azimuths", &Vertices::azimuths, py::arg("AngleUnit"))
+        .def("Positions", [](const Vertices &vertices) { return to_array(vertices.positions()); })
+        .def(
+            "Inclinations",
+            [](const Vertices &vertices, AngleUnit angle_unit) { return to_array(vertices.inclinations(angle_unit)); },
+            py::arg("AngleUnit"))
+        .def(
+            "Azimuths",
+            [](const Vertices &vertices, AngleUnit angle_unit) { return to_array(vertices.azimuths(angle_unit)); },
+            py::arg("AngleUnit"))
         .def("ApproxEqual", &Vertices::approx_equal, py::arg("other"), py::arg("tol_radius") = 1E-6);
 
+    py::class_<PositionGrid>(m, "PositionGrid")
+        .def_static("Uniform", &PositionGrid::uniform, py::arg("first"), py::arg("step"), py::arg("size"))
+        .def_static("FixedStep", &PositionGrid::fixed_step, py::arg("first"), py::arg("last"), py::arg("step"))
+        .def_static("Logarithmic", &PositionGrid::logarithmic, py::arg("first"), py::arg("last"), py::arg("size"))
+        .def(
+            "WithStations",
+            [](const PositionGrid &grid, const DoubleArray &stations) { return grid.with_stations(to_span(stations)); },
+            py::arg("stations"))
+        .def("Size", &PositionGrid::size)
+        .def("__len__", &PositionGrid::size)
+        .def(
+            "__getitem__",
+            [](const PositionGrid &grid, std::size_t index) {
+                if (index >= grid.size())
+                {
+                    throw py::index_error("PositionGrid: index out of range");
+                }
+                return grid[index];
+            },
+            py::arg("index"))
+        .def(
+            "Positions",
+            [](const PositionGrid &grid) {
+                std::vector<double> positions(grid.size());
+                grid.fill(0, positions);
+                return to_array(std::move(positions));
+            });
+
     py::class_<IInterpolator, PyIInterpolator>(m, "IInterpolator")
         .def(py::init<>())
         .def("VertexAtPosition", &IInterpolator::vertex_at_position, py::arg("position"))
@@ -176,22 +562,104 @@ PYBIND11_MODULE(_interpolator, m)
         .def("XAtPosition", &IInterpolator::x_at_position, py::arg("position"))
         .def("YAtPosition", &IInterpolator::y_at_position, py::arg("position"))
         .def("ZAtPosition", &IInterpolator::z_at_position, py::arg("position"))
+        .def("PointAtPosition", &IInterpolator::point_at_position, py::arg("position"))
         .def("AddNDrop", &IInterpolator::add_n_drop, py::arg("vertex"))
         .def("DropNAdd", &IInterpolator::drop_n_add, py::arg("vertex"))
+        .def("Slide", &IInterpolator::slide, py::arg("vertex"))
         .def(
-            "GenerateVertices", &IInterpolator::generate_vertices, py::arg("num_vertices"),
-            py::arg("num_threads") = std::numeric_limits<unsigned>::max())
+            "GenerateVertices",
+            [](const IInterpolator &interpolator, std::size_t num_vertices, unsigned num_threads) {
+                return to_table(
+                    without_gil([&]() { return interpolator.generate_vertices(num_vertices, num_threads); }));
+            },
+            py::arg("num_vertices"), py::arg("num_threads") = std::numeric_limits<unsigned>::max())
         .def(
-            "GenerateXProjections", &IInterpolator::generate_x_projections, py::arg("num_points"),
-            py::arg("num_threads") = std::numeric_limits<unsigned>::max())
+            "GenerateVertices",
+            [](const IInterpolator &interpolator, const PositionGrid &grid, unsigned num_threads) {
+                return to_table(without_gil([&]() { return interpolator.generate_vertices(grid, num_threads); }));
+            },
+            py::arg("grid"), py::arg("num_threads") = std::numeric_limits<unsigned>::max())
         .def(
-            "GenerateYProjections", &IInterpolator::generate_y_projections, py::arg("num_points"),
+            "GenerateXProjections",
+            [](const IInterpolator &interpolator, std::size_t num_points, unsigned num_threads) {
+                return to_array(
+                    without_gil([&]() { return interpolator.generate_x_projections(num_points, num_threads); }));
+            },
+            py::arg("num_points"), py::arg("num_threads") = std::numeric_limits<unsigned>::max())
+        .def(
+            "GenerateYProjections",
+            [](const IInterpolator &interpolator, std::size_t num_points, unsigned num_threads) {
+                return to_array(
+                    without_gil([&]() { return interpolator.generate_y_projections(num_points, num_threads); }));
+            },
+            py::arg("num_points"), py::arg("num_threads") = std::numeric_limits<unsigned>::max())
+        .def(
+            "GenerateZProjections",
+            [](const IInterpolator &interpolator, std::size_t num_points, unsigned num_threads) {
+                return to_array(
+                    without_gil([&]() { return interpolator.generate_z_projections(num_points, num_threads); }));
+            },
+            py::arg("num_points"), py::arg("num_threads") = std::numeric_limits<unsigned>::max())
+        .def(
+            "GeneratePoints",
+            [](const IInterpolator &interpolator, std::size_t num_points, unsigned num_threads) {
+                return to_table(
+                    without_gil([&]() { return interpolator.generate_points(num_points, num_threads); }));
+            },
+            py::arg("num_points"), py::arg("num_threads") = std::numeric_limits<unsigned>::max())
+        .def(
+            "GeneratePoints",
+            [](const IInterpolator &interpolator, const PositionGrid &grid, unsigned num_threads) {
+                return to_table(without_gil([&]() { return interpolator.generate_points(grid, num_threads); }));
+            },
+            py::arg("grid"), py::arg("num_threads") = std::numeric_limits<unsigned>::max())
+        .def(
+            "GenerateChunks",
+            [](const IInterpolator &interpolator, std::size_t num_points, std::size_t chunk_size,
+               const py::function &consumer, unsigned num_threads, bool prefetch) {
+                without_gil([&]() {
+                    interpolator.generate_chunks(
+                        num_points, chunk_size, to_chunk_consumer(consumer), num_threads, prefetch);
+                });
+            },
+            py::arg("num_points"), py::arg("chunk_size"), py::arg("consumer"),
+            py::arg("num_threads") = std::numeric_limits<unsigned>::max(), py::arg("prefetch") = false)
+        .def(
+            "GenerateChunks",
+            [](const IInterpolator &interpolator, const PositionGrid &grid, std::size_t chunk_size,
+               const py::function &consumer, unsigned num_threads, bool prefetch) {
+                without_gil([&]() {
+                    interpolator.generate_chunks(grid, chunk_size, to_chunk_consumer(consumer), num_threads, prefetch);
+                });
+            },
+            py::arg("grid"), py::arg("chunk_size"), py::arg("consumer"),
+            py::arg("num_threads") = std::numeric_limits<unsigned>::max(), py::arg("prefetch") = false)
+        .def(
+            "GenerateAdaptivePoints",
+            [](const IInterpolator &interpolator, double max_chord_deviation, double max_angle, unsigned num_threads) {
+                return to_table(without_gil([&]() {
+                    return interpolator.generate_adaptive_points(max_chord_deviation, max_angle, num_threads);
+                }));
+            },
+            py::arg("max_chord_deviation"), py::arg("max_angle") = std::numeric_limits<double>::max(),
             py::arg("num_threads") = std::numeric_limits<unsigned>::max())
         .def(
-            "GenerateZProjections", &IInterpolator::generate_z_projections, py::arg("num_points"),
-            py::arg("num_threads") = std::numeric_limits<unsigned>::max());
+            "Evaluate",
+            [](const IInterpolator &interpolator, const DoubleArray &positions, unsigned num_threads) {
+                auto const positions_span = to_span(positions);
+                std::vector<Vertex> vertices(positions_span.size());
+                std::vector<Point> points(positions_span.size());
+                without_gil([&]() { interpolator.evaluate(positions_span, vertices, points, num_threads); });
+                return py::make_tuple(to_table(std::move(vertices)), to_table(std::move(points)));
+            },
+            py::arg("positions"), py::arg("num_threads") = std::numeric_limits<unsigned>::max())
+        .def(
+            "IntervalAggregates", &IInterpolator::interval_aggregates, py::arg("first_position"),
+            py::arg("last_position"));
 
-    py::class_<BaseInterpolator, PyBaseInterpolator, IInterpolator>(m, "BaseInterpolator")
+    // the interpolation types are bound at compile time (@see InterpolatorEngine), so BaseInterpolator can not be
+    // extended from Python
+    py::class_<BaseInterpolator, IInterpolator>(m, "BaseInterpolator")
         .def("Trajectory", &BaseInterpolator::trajectory)
         .def("SetTrajectory", &BaseInterpolator::set_trajectory, py::arg("trajectory"));
 
@@ -202,12 +670,96 @@ PYBIND11_MODULE(_interpolator, m)
     py::class_<CubicInterpolator, BaseInterpolator>(m, "CubicInterpolator")
         .def(py::init<const Vertices &>(), py::arg("trajectory"));
 
+    py::class_<TrajectoryCursor>(m, "TrajectoryCursor")
+        .def(py::init<const BaseInterpolator &>(), py::arg("interpolator"), py::keep_alive<1, 2>())
+        .def("VertexAtPosition", &TrajectoryCursor::vertex_at_position, py::arg("position"))
+        .def("PointAtPosition", &TrajectoryCursor::point_at_position, py::arg("position"))
+        .def("Reset", &TrajectoryCursor::reset)
+        .def("UpperIndex", &TrajectoryCursor::upper_index);
+
+    py::class_<ClosestPoint>(m, "ClosestPoint")
+        .def_readonly("point", &ClosestPoint::point)
+        .def_readonly("distance", &ClosestPoint::distance);
+
+    py::class_<TrajectoryIndex>(m, "TrajectoryIndex")
+        .def(py::init<const BaseInterpolator &>(), py::arg("interpolator"), py::keep_alive<1, 2>())
+        .def("Update", &TrajectoryIndex::update)
+        .def(
+            "ClosestPoint",
+            [](const TrajectoryIndex &index, double x, double y, double z, double max_distance) {
+                return index.closest_point({x, y, z}, max_distance);
+            },
+            py::arg("x"), py::arg("y"), py::arg("z"), py::arg("max_distance") = std::numeric_limits<double>::max())
+        .def(
+            "ClosestPoints",
+            [](const TrajectoryIndex &index, const DoubleArray &points, unsigned num_threads) {
+                // the columns position, inclination, azimuth, x, y, z and distance
+                auto const query = make_points(points);
+                return to_table(without_gil([&]() { return index.closest_points(query, num_threads); }));
+            },
+            py::arg("points"), py::arg("num_threads") = std::numeric_limits<unsigned>::max())
+        .def(
+            "NearestSegments",
+            [](const TrajectoryIndex &index, double x, double y, double z, std::size_t k) {
+                return index.nearest_segments({x, y, z}, k);
+            },
+            py::arg("x"), py::arg("y"), py::arg("z"), py::arg("k"))
+        .def(
+            "PositionsAtPlane",
+            [](const TrajectoryIndex &index, double normal_x, double normal_y, double normal_z, double offset) {
+                return to_array(index.positions_at_plane(Plane{{normal_x, normal_y, normal_z}, offset}));
+            },
+            py::arg("normal_x"), py::arg("normal_y"), py::arg("normal_z"), py::arg("offset"))
+        .def(
+            "PositionsAtX",
+            [](const TrajectoryIndex &index, const DoubleArray &values, unsigned num_threads) {
+                return to_arrays(without_gil([&]() { return index.positions_at_x(to_span(values), num_threads); }));
+            },
+            py::arg("values"), py::arg("num_threads") = std::numeric_limits<unsigned>::max())
+        .def(
+            "PositionsAtY",
+            [](const TrajectoryIndex &index, const DoubleArray &values, unsigned num_threads) {
+                return to_arrays(without_gil([&]() { return index.positions_at_y(to_span(values), num_threads); }));
+            },
+            py::arg("values"), py::arg("num_threads") = std::numeric_limits<unsigned>::max())
+        .def(
+            "PositionsAtZ",
+            [](const TrajectoryIndex &index, const DoubleArray &values, unsigned num_threads) {
+                return to_arrays(without_gil([&]() { return index.positions_at_z(to_span(values), num_threads); }));
+            },
+            py::arg("values"), py::arg("num_threads") = std::numeric_limits<unsigned>::max());
+
+    py::class_<SeparationProfile>(m, "SeparationProfile")
+        .def_property_readonly(
+            "offset_points",
+            // the columns position, inclination, azimuth, x, y, z and distance of the offset
+            [](const SeparationProfile &profile) { return to_table(std::vector<ClosestPoint>(profile.offset_points)); })
+        .def_readonly("minimum_index", &SeparationProfile::minimum_index);
+
+    py::class_<AntiCollisionScan>(m, "AntiCollisionScan")
+        .def(
+            py::init<const BaseInterpolator &, double>(), py::arg("reference"),
+            py::arg("scan_radius") = std::numeric_limits<double>::max(), py::keep_alive<1, 2>())
+        .def(
+            "AddOffset",
+            [](AntiCollisionScan &scan, const BaseInterpolator &offset, double x, double y, double z) {
+                scan.add_offset(offset, {x, y, z});
+            },
+            py::arg("offset"), py::arg("x") = 0.0, py::arg("y") = 0.0, py::arg("z") = 0.0, py::keep_alive<1, 2>())
+        .def(
+            "Scan", &AntiCollisionScan::scan, py::arg("grid"),
+            py::arg("num_threads") = std::numeric_limits<unsigned>::max(), py::call_guard<py::gil_scoped_release>());
+
     py::class_<InterpolatorFactory>(m, "InterpolatorFactory")
-        .def_static("MakeLinearInterpolator", &InterpolatorFactory::make<LinearInterpolator>, py::arg("trajectory"))
+        .def_static(
+            "MakeLinearInterpolator", &InterpolatorFactory::make<LinearInterpolator>, py::arg("trajectory"),
+            py::arg("capacity") = 0, py::call_guard<py::gil_scoped_release>())
         .def_static(
             "MakeMinimumCurvatureInterpolator", &InterpolatorFactory::make<MinimumCurvatureInterpolator>,
-            py::arg("trajectory"))
-        .def_static("MakeCubicInterpolator", &InterpolatorFactory::make<CubicInterpolator>, py::arg("trajectory"));
+            py::arg("trajectory"), py::arg("capacity") = 0, py::call_guard<py::gil_scoped_release>())
+        .def_static(
+            "MakeCubicInterpolator", &InterpolatorFactory::make<CubicInterpolator>, py::arg("trajectory"),
+            py::arg("capacity") = 0, py::call_guard<py::gil_scoped_release>());
 }
 
 #endif // HPP_INTERPOLATOR_BINDINGS
@@ -0,0 +1,455 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+#include <tuple>
+
+#include <interpolator/AntiCollisionScan.hpp>
+#include <interpolator/InterpolatorFactory.hpp>
+#include <interpolator/TrajectoryIndex.hpp>
+
+using namespace splines;
+
+// Every heap allocation of the process is counted, so the benchmarks can report the allocations per call
+static std::atomic<std::size_t> num_allocations = 0;
+
+void *operator new(std::size_t size)
+{
+    ++num_allocations;
+    if (auto *ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+enum class InterpolationType
+{
+    linear,
+    minimum_curvature,
+    cubic,
+};
+
+std::string interpolation_type_str(InterpolationType interpolation_type)
+{
+    switch (interpolation_type)
+    {
+    case InterpolationType::linear:
+        return "linear";
+    case InterpolationType::minimum_curvature:
+        return "minimum_curvature";
+    case InterpolationType::cubic:
+        return "cubic";
+    default:
+        return "";
+    }
+}
+
+/**
+ * @brief make_trajectory
+ * A synthetic trajectory with a station every 30 meters, slowly building and turning, so every segment has
+ * dogleg
+ *
+ * @param num_stations
+ * @return
+ */
+Vertices make_trajectory(std::size_t num_stations)
+{
+    std::vector<Vertex> vertices;
+    vertices.reserve(num_stations);
+    for (std::size_t i = 0; i < num_stations; ++i)
+    {
+        auto const position = 30.0 * static_cast<double>(i);
+        auto const inclination = 0.1 + 1.4 * (0.5 + 0.5 * sin(1E-3 * position));
+        auto const azimuth = fmod(0.5 + 2E-4 * position + 0.3 * sin(7E-4 * position), 2 * M_PI);
+        vertices.emplace_back(position, inclination, azimuth);
+    }
+    return Vertices(vertices);
+}
+
+/**
+ * @brief interpolator
+ * The interpolators are built once per type and number of stations and shared by the benchmarks
+ */
+const BaseInterpolator &interpolator(InterpolationType interpolation_type, std::size_t num_stations)
+{
+    static std::map<std::tuple<InterpolationType, std::size_t>, std::unique_ptr<BaseInterpolator>> interpolators;
+
+    auto &interpolator = interpolators[{interpolation_type, num_stations}];
+    if (!interpolator)
+    {
+        auto const trajectory = make_trajectory(num_stations);
+        switch (interpolation_type)
+        {
+        case InterpolationType::linear:
+            interpolator = InterpolatorFactory::make<LinearInterpolator>(trajectory);
+            break;
+        case InterpolationType::minimum_curvature:
+            interpolator = InterpolatorFactory::make<MinimumCurvatureInterpolator>(trajectory);
+            break;
+        case InterpolationType::cubic:
+            interpolator = InterpolatorFactory::make<CubicInterpolator>(trajectory);
+            break;
+        }
+    }
+    return *interpolator;
+}
+
+/**
+ * @brief report
+ * Sets the throughput (points/s) and the allocations per call
+ *
+ * @param num_points
+ * The points processed by all the iterations
+ */
+void report(benchmark::State &state, std::size_t num_points, std::size_t allocations)
+{
+    state.SetItemsProcessed(static_cast<int64_t>(num_points));
+    state.counters["allocs_per_call"] =
+        benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+typedef std::function<double(const BaseInterpolator &, double)> PointQuery;
+
+/**
+ * @brief bm_query
+ * A single position query (e.g. vertex_at_position), sweeping positions spread over the whole trajectory
+ *
+ * Arguments: number of stations
+ */
+void bm_query(benchmark::State &state, InterpolationType interpolation_type, PointQuery query)
+{
+    auto const &current = interpolator(interpolation_type, state.range(0));
+    auto const length = current.trajectory().back().position();
+
+    // a fixed pseudo-random walk, so the queries are not sorted
+    constexpr std::size_t num_positions = 4096;
+    std::vector<double> positions(num_positions);
+    for (std::size_t i = 0; i < num_positions; ++i)
+    {
+        positions[i] = length * fmod(0.6180339887 * static_cast<double>(i), 1.0);
+    }
+
+    std::size_t i = 0;
+    auto const allocations = num_allocations.load();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(query(current, positions[i++ % num_positions]));
+    }
+    report(state, state.iterations(), num_allocations.load() - allocations);
+}
+
+typedef std::function<std::size_t(const BaseInterpolator &, std::size_t, unsigned)> GenerateCall;
+
+/**
+ * @brief bm_generate
+ * A generate_* call
+ *
+ * Arguments: number of stations, number of points, number of threads
+ */
+void bm_generate(benchmark::State &state, InterpolationType interpolation_type, GenerateCall generate)
+{
+    auto const &current = interpolator(interpolation_type, state.range(0));
+    auto const num_points = static_cast<std::size_t>(state.range(1));
+    auto const num_threads = static_cast<unsigned>(state.range(2));
+
+    // fewer points than stations return the stations, so the points are the ones returned
+    std::size_t num_generated = 0;
+    auto const allocations = num_allocations.load();
+    for (auto _ : state)
+    {
+        num_generated += generate(current, num_points, num_threads);
+    }
+    report(state, num_generated, num_allocations.load() - allocations);
+}
+
+/**
+ * @brief bm_closest_point
+ * A closest point query (@see TrajectoryIndex), from points scattered up to 100 meters around the trajectory
+ *
+ * Arguments: number of stations
+ */
+void bm_closest_point(benchmark::State &state, InterpolationType interpolation_type)
+{
+    auto const &current = interpolator(interpolation_type, state.range(0));
+    auto const index = TrajectoryIndex(current);
+    auto const length = current.trajectory().back().position();
+
+    constexpr std::size_t num_points = 4096;
+    std::vector<Point> points(num_points);
+    for (std::size_t i = 0; i < num_points; ++i)
+    {
+        auto const point = current.point_at_position(length * fmod(0.6180339887 * static_cast<double>(i), 1.0)).point;
+        auto const offset = 100.0 * fmod(0.7548776662 * static_cast<double>(i), 1.0) - 50.0;
+        points[i] = {point.x + offset, point.y - offset, point.z + 2.0 * offset};
+    }
+
+    std::size_t i = 0;
+    auto const allocations = num_allocations.load();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(index.closest_point(points[i++ % num_points]).distance);
+    }
+    report(state, state.iterations(), num_allocations.load() - allocations);
+}
+
+/**
+ * @brief bm_positions_at_z
+ * An inverse query (@see TrajectoryIndex::positions_at_plane), for depths spread over the whole trajectory
+ *
+ * Arguments: number of stations
+ */
+void bm_positions_at_z(benchmark::State &state, InterpolationType interpolation_type)
+{
+    auto const &current = interpolator(interpolation_type, state.range(0));
+    auto const index = TrajectoryIndex(current);
+    auto const depth = current.trajectory().back().position() / 2.0;
+
+    std::size_t i = 0;
+    auto const allocations = num_allocations.load();
+    for (auto _ : state)
+    {
+        auto const z = depth * fmod(0.6180339887 * static_cast<double>(i++), 1.0);
+        benchmark::DoNotOptimize(index.positions_at_plane(Plane{{0.0, 0.0, 1.0}, z}).size());
+    }
+    report(state, state.iterations(), num_allocations.load() - allocations);
+}
+
+/**
+ * @brief bm_generate_adaptive_points
+ * The whole trajectory sampled by its bending (@see IInterpolator::generate_adaptive_points). The points per call are
+ * the ones generated, so the throughput compares with bm_generate
+ *
+ * Arguments: number of stations, maximum chord deviation (mm), number of threads
+ */
+void bm_generate_adaptive_points(benchmark::State &state, InterpolationType interpolation_type)
+{
+    auto const &current = interpolator(interpolation_type, state.range(0));
+    auto const max_chord_deviation = static_cast<double>(state.range(1)) / 1000.0;
+    auto const num_threads = static_cast<unsigned>(state.range(2));
+
+    std::size_t num_points = 0;
+    auto const allocations = num_allocations.load();
+    for (auto _ : state)
+    {
+        num_points += current.generate_adaptive_points(max_chord_deviation, M_PI, num_threads).size();
+    }
+    report(state, num_points, num_allocations.load() - allocations);
+    state.counters["points"] = benchmark::Counter(static_cast<double>(num_points), benchmark::Counter::kAvgIterations);
+}
+
+/**
+ * @brief bm_interval_aggregates
+ * A range query (@see IInterpolator::interval_aggregates), for ranges spread over the whole trajectory
+ *
+ * Arguments: number of stations
+ */
+void bm_interval_aggregates(benchmark::State &state, InterpolationType interpolation_type)
+{
+    auto const &current = interpolator(interpolation_type, state.range(0));
+    auto const length = current.trajectory().back().position();
+
+    std::size_t i = 0;
+    auto const allocations = num_allocations.load();
+    for (auto _ : state)
+    {
+        auto const first = length * fmod(0.6180339887 * static_cast<double>(i), 1.0);
+        auto const last = first + (length - first) * fmod(0.7548776662 * static_cast<double>(i++), 1.0);
+        benchmark::DoNotOptimize(current.interval_aggregates(first, last).max_dogleg);
+    }
+    report(state, state.iterations(), num_allocations.load() - allocations);
+}
+
+/**
+ * @brief bm_anti_collision_scan
+ * The separation profile between the trajectory and itself moved 40 meters aside (@see AntiCollisionScan)
+ *
+ * Arguments: number of stations, number of reference points, number of threads
+ */
+void bm_anti_collision_scan(benchmark::State &state, InterpolationType interpolation_type)
+{
+    auto const &current = interpolator(interpolation_type, state.range(0));
+    auto const grid = PositionGrid::uniform(
+        current.trajectory().front().position(),
+        (current.trajectory().back().position() - current.trajectory().front().position()) /
+            static_cast<double>(state.range(1)),
+        static_cast<std::size_t>(state.range(1)));
+
+    auto scan = AntiCollisionScan(current, 100.0);
+    scan.add_offset(current, {30.0, -20.0, 20.0});
+
+    auto const allocations = num_allocations.load();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(scan.scan(grid, static_cast<unsigned>(state.range(2))).front().minimum_index);
+    }
+    report(state, state.iterations() * static_cast<std::size_t>(state.range(1)), num_allocations.load() - allocations);
+}
+
+int main(int argc, char **argv)
+{
+    auto const interpolation_types = {
+        InterpolationType::linear, InterpolationType::minimum_curvature, InterpolationType::cubic};
+    auto const num_stations = {10, 1000, 100000, 1000000};
+    auto const num_points = {1000, 100000};
+
+    std::vector<int64_t> num_threads;
+    auto const hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned n = 1; n < hardware_threads; n *= 2)
+    {
+        num_threads.push_back(n);
+    }
+    num_threads.push_back(hardware_threads);
+
+    auto const queries = std::map<std::string, PointQuery>{
+        {"vertex_at_position",
+         [](const BaseInterpolator &current, double position) {
+             return current.vertex_at_position(position).inclination();
+         }},
+        {"x_at_position",
+         [](const BaseInterpolator &current, double position) { return current.x_at_position(position); }},
+        {"y_at_position",
+         [](const BaseInterpolator &current, double position) { return current.y_at_position(position); }},
+        {"z_at_position",
+         [](const BaseInterpolator &current, double position) { return current.z_at_position(position); }},
+    };
+
+    auto const generate_calls = std::map<std::string, GenerateCall>{
+        {"generate_vertices",
+         [](const BaseInterpolator &current, std::size_t num_points, unsigned num_threads) {
+             return current.generate_vertices(num_points, num_threads).size();
+         }},
+        {"generate_points",
+         [](const BaseInterpolator &current, std::size_t num_points, unsigned num_threads) {
+             return current.generate_points(num_points, num_threads).size();
+         }},
+        {"generate_x_projections",
+         [](const BaseInterpolator &current, std::size_t num_points, unsigned num_threads) {
+             return current.generate_x_projections(num_points, num_threads).size();
+         }},
+        {"generate_y_projections",
+         [](const BaseInterpolator &current, std::size_t num_points, unsigned num_threads) {
+             return current.generate_y_projections(num_points, num_threads).size();
+         }},
+        {"generate_z_projections",
+         [](const BaseInterpolator &current, std::size_t num_points, unsigned num_threads) {
+             return current.generate_z_projections(num_points, num_threads).size();
+         }},
+    };
+
+    for (auto interpolation_type : interpolation_types)
+    {
+        for (auto const &[name, query] : queries)
+        {
+            auto *benchmark = benchmark::RegisterBenchmark(
+                (interpolation_type_str(interpolation_type) + "/" + name).c_str(), bm_query, interpolation_type,
+                query);
+            benchmark->ArgName("stations");
+            for (auto stations : num_stations)
+            {
+                benchmark->Arg(stations);
+            }
+        }
+
+        auto *closest_point = benchmark::RegisterBenchmark(
+            (interpolation_type_str(interpolation_type) + "/closest_point").c_str(), bm_closest_point,
+            interpolation_type);
+        closest_point->ArgName("stations");
+        for (auto stations : num_stations)
+        {
+            closest_point->Arg(stations);
+        }
+
+        auto *positions_at_z = benchmark::RegisterBenchmark(
+            (interpolation_type_str(interpolation_type) + "/positions_at_z").c_str(), bm_positions_at_z,
+            interpolation_type);
+        positions_at_z->ArgName("stations");
+        for (auto stations : num_stations)
+        {
+            positions_at_z->Arg(stations);
+        }
+
+        auto *generate_adaptive_points = benchmark::RegisterBenchmark(
+            (interpolation_type_str(interpolation_type) + "/generate_adaptive_points").c_str(),
+            bm_generate_adaptive_points, interpolation_type);
+        generate_adaptive_points->ArgNames({"stations", "tolerance_mm", "threads"})
+            ->Unit(benchmark::kMicrosecond)
+            ->UseRealTime();
+        for (auto stations : num_stations)
+        {
+            for (auto tolerance_mm : {10, 100})
+            {
+                for (auto threads : num_threads)
+                {
+                    generate_adaptive_points->Args({stations, tolerance_mm, threads});
+                }
+            }
+        }
+
+        auto *interval_aggregates = benchmark::RegisterBenchmark(
+            (interpolation_type_str(interpolation_type) + "/interval_aggregates").c_str(), bm_interval_aggregates,
+            interpolation_type);
+        interval_aggregates->ArgName("stations");
+        for (auto stations : num_stations)
+        {
+            interval_aggregates->Arg(stations);
+        }
+
+        auto *anti_collision_scan = benchmark::RegisterBenchmark(
+            (interpolation_type_str(interpolation_type) + "/anti_collision_scan").c_str(), bm_anti_collision_scan,
+            interpolation_type);
+        anti_collision_scan->ArgNames({"stations", "points", "threads"})->Unit(benchmark::kMicrosecond)->UseRealTime();
+        for (auto stations : num_stations)
+        {
+            for (auto points : num_points)
+            {
+                for (auto threads : num_threads)
+                {
+                    anti_collision_scan->Args({stations, points, threads});
+                }
+            }
+        }
+
+        for (auto const &[name, generate] : generate_calls)
+        {
+            auto *benchmark = benchmark::RegisterBenchmark(
+                (interpolation_type_str(interpolation_type) + "/" + name).c_str(), bm_generate, interpolation_type,
+                generate);
+            benchmark->ArgNames({"stations", "points", "threads"})->Unit(benchmark::kMicrosecond)->UseRealTime();
+            for (auto stations : num_stations)
+            {
+                for (auto points : num_points)
+                {
+                    for (auto threads : num_threads)
+                    {
+                        benchmark->Args({stations, points, threads});
+                    }
+                }
+            }
+        }
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -11,10 +11,16 @@ namespace data = boost::unit_test::data;
 
 #include <algorithm>
 #include <map>
+#include <numeric>
 #include <sstream>
 #include <typeinfo>
 
+#include <interpolator/AntiCollisionScan.hpp>
 #include <interpolator/InterpolatorFactory.hpp>
+#include <interpolator/TrajectoryCursor.hpp>
+#include <interpolator/TrajectoryIndex.hpp>
+#include <interpolator/utils/Multithreading.hpp>
+#include <interpolator/utils/VectorMath.hpp>
 
 using namespace splines;
 
@@ -28,6 +34,17 @@ std::string message_error_vertices_compare(const Vertex &v_1, const Vertex &v_2)
            to_string(v_2.position()) + ", " + to_string(v_2.inclination()) + ", " + to_string(v_2.azimuth()) + "}";
 }
 
+/**
+ * @brief close
+ * Whether value is within ulp units in the last place of expected, relative to the magnitude of expected or to a
+ * larger scale (absolute below 1 by default)
+ */
+bool close(double value, double expected, double ulp, double scale = 1.0)
+{
+    return std::fabs(value - expected) <=
+           ulp * std::numeric_limits<double>::epsilon() * std::max(std::fabs(expected), scale);
+}
+
 enum class InterpolationType
 {
     linear,
@@ -55,16 +72,17 @@ std::string interpolation_type_str(const BaseInterpolator &interpolator)
     }
 }
 
-std::unique_ptr<BaseInterpolator> make_interpolator(const Vertices &trajectory, InterpolationType interpolation_type)
+std::unique_ptr<BaseInterpolator> make_interpolator(
+    const Vertices &trajectory, InterpolationType interpolation_type, std::size_t capacity = 0)
 {
     switch (interpolation_type)
     {
     case InterpolationType::linear:
-        return InterpolatorFactory::make<LinearInterpolator>(trajectory);
+        return InterpolatorFactory::make<LinearInterpolator>(trajectory, capacity);
     case InterpolationType::minimum_curvature:
-        return InterpolatorFactory::make<MinimumCurvatureInterpolator>(trajectory);
+        return InterpolatorFactory::make<MinimumCurvatureInterpolator>(trajectory, capacity);
     case InterpolationType::cubic:
-        return InterpolatorFactory::make<CubicInterpolator>(trajectory);
+        return InterpolatorFactory::make<CubicInterpolator>(trajectory, capacity);
     default:
         return nullptr;
     }
@@ -332,6 +350,131 @@ BOOST_AUTO_TEST_CASE(test_add_and_drop)
     }
 }
 
+BOOST_DATA_TEST_CASE(
+    test_projections_after_add_and_drop, data::make(Samples::interpolation_types), interpolation_type)
+{
+    auto tol = 1E-9;
+    auto interpolator = make_interpolator(Samples::SPE84246, interpolation_type);
+
+    interpolator->add_n_drop({1000.0, 0.4, 1.2});
+    interpolator->drop_n_add({3100.0, 2.1, 4.9});
+
+    // an interpolator built from scratch must have the same cumulative projections and segment tables
+    auto expected = make_interpolator(interpolator->trajectory(), interpolation_type);
+
+    for (auto position : {100.0, 598.800936, 1000.0, 1200.0, 2000.0, 3018.032064, 3050.0, 3100.0, 3200.0})
+    {
+        auto const vertex = interpolator->vertex_at_position(position);
+        auto const vertex_expected = expected->vertex_at_position(position);
+        BOOST_TEST(fabs(vertex.inclination() - vertex_expected.inclination()) < tol);
+        BOOST_TEST(fabs(vertex.azimuth() - vertex_expected.azimuth()) < tol);
+        BOOST_TEST(fabs(interpolator->x_at_position(position) - expected->x_at_position(position)) < tol);
+        BOOST_TEST(fabs(interpolator->y_at_position(position) - expected->y_at_position(position)) < tol);
+        BOOST_TEST(fabs(interpolator->z_at_position(position) - expected->z_at_position(position)) < tol);
+    }
+}
+
+/**
+ * @brief check_rebuilt
+ * The tables of an interpolator updated incrementally must match the ones of an interpolator built from scratch
+ */
+void check_rebuilt(const BaseInterpolator &interpolator, InterpolationType interpolation_type, double tol)
+{
+    auto expected = make_interpolator(interpolator.trajectory(), interpolation_type);
+    auto const positions = interpolator.trajectory().positions();
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        for (auto position : {positions[i], i ? 0.5 * (positions[i - 1] + positions[i]) : 0.0})
+        {
+            auto const point = interpolator.point_at_position(position);
+            auto const point_expected = expected->point_at_position(position);
+            BOOST_TEST(fabs(point.vertex.inclination() - point_expected.vertex.inclination()) < tol);
+            BOOST_TEST(fabs(point.vertex.azimuth() - point_expected.vertex.azimuth()) < tol);
+            BOOST_TEST(fabs(point.point.x - point_expected.point.x) < tol);
+            BOOST_TEST(fabs(point.point.y - point_expected.point.y) < tol);
+            BOOST_TEST(fabs(point.point.z - point_expected.point.z) < tol);
+        }
+    }
+
+    // and so the segment aggregates, over the whole trajectory and from the middle of a segment
+    auto const middle = 0.5 * (positions[0] + positions[1]);
+    for (auto first_position : {positions.front(), middle})
+    {
+        auto const aggregates = interpolator.interval_aggregates(first_position, positions.back());
+        auto const aggregates_expected = expected->interval_aggregates(first_position, positions.back());
+        for (auto axis : {&Point::x, &Point::y, &Point::z})
+        {
+            BOOST_TEST(fabs(aggregates.lower.*axis - aggregates_expected.lower.*axis) < tol);
+            BOOST_TEST(fabs(aggregates.upper.*axis - aggregates_expected.upper.*axis) < tol);
+        }
+        BOOST_TEST(fabs(aggregates.max_dogleg - aggregates_expected.max_dogleg) < tol);
+        BOOST_TEST(fabs(aggregates.max_dogleg_severity - aggregates_expected.max_dogleg_severity) < tol);
+    }
+}
+
+BOOST_DATA_TEST_CASE(test_sliding_window, data::make(Samples::interpolation_types), interpolation_type)
+{
+    auto tol = 1E-8;
+    auto interpolator = make_interpolator(Samples::SPE84246, interpolation_type);
+
+    // a real-time window: the oldest station is dropped for each new one
+    for (int i = 1; i <= 50; ++i)
+    {
+        interpolator->drop_n_add({3100.0 + 30.0 * i, 1.2 + 0.01 * i, 4.9 - 0.02 * i});
+    }
+    check_rebuilt(*interpolator, interpolation_type, tol);
+
+    // a station in the middle, one before the first and one repeated (ignored, only the last station is dropped)
+    interpolator->add_n_drop({3500.0, 1.0, 2.0});
+    check_rebuilt(*interpolator, interpolation_type, tol);
+    interpolator->add_n_drop({1000.0, 0.4, 1.2});
+    check_rebuilt(*interpolator, interpolation_type, tol);
+    interpolator->add_n_drop(interpolator->trajectory()[2]);
+    check_rebuilt(*interpolator, interpolation_type, tol);
+    interpolator->drop_n_add({5000.0, 1.0, 1.0});
+    check_rebuilt(*interpolator, interpolation_type, tol);
+}
+
+BOOST_DATA_TEST_CASE(test_trajectory_window, data::make(Samples::interpolation_types), interpolation_type)
+{
+    auto tol = 1E-8;
+    std::size_t const capacity = 8;
+    auto interpolator = make_interpolator(Samples::SPE84246, interpolation_type, capacity);
+    BOOST_TEST(interpolator->trajectory().capacity() == capacity);
+
+    // the window grows up to its capacity, then the oldest station is dropped for each new one
+    auto const *storage = interpolator->trajectory().positions_view().data();
+    for (int i = 1; i <= 100; ++i)
+    {
+        interpolator->slide({3100.0 + 30.0 * i, 1.2 + 0.01 * (i % 7), 4.9 - 0.02 * (i % 5)});
+        BOOST_TEST(interpolator->trajectory().size() == std::min<std::size_t>(4 + i, capacity));
+
+        // the window slides inside the storage reserved at first, so nothing is allocated
+        auto const *first = interpolator->trajectory().positions_view().data();
+        BOOST_TEST((first >= storage && first + capacity <= storage + 2 * (capacity + 1)));
+    }
+    BOOST_TEST(interpolator->trajectory().front().position() == 3100.0 + 30.0 * 93);
+    check_rebuilt(*interpolator, interpolation_type, tol);
+
+    // out of order: the slow path keeps the trajectory sorted
+    interpolator->slide({3100.0 + 30.0 * 95.5, 1.0, 2.0});
+    BOOST_TEST(interpolator->trajectory().size() == capacity);
+    BOOST_TEST(interpolator->trajectory()[1].position() == 3100.0 + 30.0 * 95);
+    BOOST_TEST(interpolator->trajectory()[2].position() == 3100.0 + 30.0 * 95.5);
+    check_rebuilt(*interpolator, interpolation_type, tol);
+
+    interpolator->drop_n_add({6500.0, 1.0, 1.0});
+    interpolator->add_n_drop({6400.0, 1.0, 1.0});
+    BOOST_TEST(interpolator->trajectory().size() == capacity);
+    check_rebuilt(*interpolator, interpolation_type, tol);
+
+    // a copy keeps the window, which keeps the last vertices
+    auto trajectory = interpolator->trajectory();
+    BOOST_TEST(trajectory.capacity() == capacity);
+    trajectory.set_vertices(Samples::SPE84246);
+    BOOST_TEST(trajectory.approx_equal(interpolator->trajectory()));
+}
+
 typedef std::map<std::array<double, 3>, Vertex> MapArrVt;
 BOOST_TEST_DONT_PRINT_LOG_VALUE(MapArrVt)
 
@@ -401,6 +544,15 @@ BOOST_AUTO_TEST_CASE(test_operator_ostream)
     BOOST_TEST(str_vertices == str_operator);
 }
 
+BOOST_AUTO_TEST_CASE(test_vertex_formatter)
+{
+    auto vertex = Vertex{1.5, 0.25, 0.75};
+
+    BOOST_TEST(VertexFormatter().to_string(vertex) == "1.5,0.25,0.75");
+    BOOST_TEST(VertexFormatter("; ").to_string(vertex) == "1.5; 0.25; 0.75");
+    BOOST_TEST(std::is_trivially_copyable_v<Vertex>);
+}
+
 BOOST_AUTO_TEST_CASE(test_trajectory_class, *utf::tolerance(1E-6))
 {
 
@@ -436,6 +588,51 @@ BOOST_AUTO_TEST_CASE(test_trajectory_class, *utf::tolerance(1E-6))
     compare_trajectory(trajectory, trajectory_set);
 }
 
+BOOST_AUTO_TEST_CASE(test_vertices_storage)
+{
+    auto trajectory = Samples::SPE84246;
+    trajectory.set_vertices(std::vector<Vertex>{{598.800936, 0.1, 0.1}, {100.0, 0.2, 0.3}});
+
+    auto const positions = trajectory.positions_view();
+    BOOST_TEST(positions.size() == 5);
+    BOOST_TEST(std::is_sorted(positions.begin(), positions.end()));
+    // the stored vertex wins against a new one at the same position
+    BOOST_TEST(trajectory[2].inclination() == 0.519235377499999);
+    BOOST_TEST(trajectory.inclinations_view()[0] == 0.2);
+    BOOST_TEST(trajectory.azimuths_view()[0] == 0.3);
+
+    for (auto position : {0.0, 100.0, 150.0, 214.13724, 598.800936, 1000.0, 3018.032064, 4000.0})
+    {
+        auto const expected = std::upper_bound(positions.begin(), positions.end(), position) - positions.begin();
+        BOOST_TEST(trajectory.upper_bound_index(position) == static_cast<std::size_t>(expected));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_vertices_from_columns, *utf::tolerance(1E-12))
+{
+    auto const trajectory = Samples::SPE84246;
+    auto const positions = trajectory.positions();
+    auto const inclinations = trajectory.inclinations(AngleUnit::deg);
+    auto const azimuths = trajectory.azimuths(AngleUnit::deg);
+
+    auto const sorted = Vertices(positions, inclinations, azimuths, AngleUnit::deg);
+    BOOST_TEST(sorted.approx_equal(trajectory, 1E-9));
+
+    // unsorted columns with a repeated position: the first one wins
+    std::vector<double> unsorted_positions = {3018.032064, 214.13724, 598.800936, 1550.31948, 214.13724};
+    std::vector<double> unsorted_inclinations = {
+        inclinations[3], inclinations[0], inclinations[1], inclinations[2], 9.0};
+    std::vector<double> unsorted_azimuths = {azimuths[3], azimuths[0], azimuths[1], azimuths[2], 9.0};
+    auto const unsorted = Vertices(unsorted_positions, unsorted_inclinations, unsorted_azimuths, AngleUnit::deg);
+    BOOST_TEST(unsorted.size() == trajectory.size());
+    BOOST_TEST(unsorted.approx_equal(trajectory, 1E-9));
+    BOOST_TEST(unsorted.front().inclination() == trajectory.front().inclination());
+
+    BOOST_CHECK_THROW(
+        Vertices(positions, inclinations, std::vector<double>(azimuths.size() - 1), AngleUnit::deg),
+        std::invalid_argument);
+}
+
 BOOST_DATA_TEST_CASE(test_move_semantics, data::make(Samples::interpolation_types), interpolation_type)
 {
     auto move_object = [](std::unique_ptr<BaseInterpolator> interpolator) -> void {};
@@ -528,3 +725,904 @@ BOOST_DATA_TEST_CASE(
         vertices_cmp(vertices_expected, projs, projection_type);
     }
 }
+
+BOOST_DATA_TEST_CASE(test_evaluate, data::make(Samples::interpolation_types), interpolation_type)
+{
+    auto interpolator = make_interpolator(Samples::SPE84246, interpolation_type);
+
+    // unsorted, repeated and out of range positions
+    std::vector<double> positions = {2690.786592, 100.0, 598.800936, 1295.4, 1295.4, 3500.0, 214.13724, 2000.0};
+    for (double position = 0.0; position < 3100.0; position += 13.7)
+    {
+        positions.push_back(position);
+    }
+
+    std::vector<Vertex> vertices(positions.size());
+    std::vector<Point> points(positions.size());
+    interpolator->evaluate(positions, vertices, points, 1);
+
+    std::vector<Point> points_mt(positions.size());
+    interpolator->evaluate(positions, {}, points_mt, 4);
+
+    // the batch kernels differ from the scalar path by the VectorMath error (@see VectorMath): a few ULP of the
+    // angles, and of the position for the projections, which are sums of the increments along the trajectory
+    auto constexpr angle_ulp = 8.0;
+    auto constexpr projection_ulp = 4.0;
+
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        auto const vertex = interpolator->vertex_at_position(positions[i]);
+        BOOST_TEST(vertices[i].position() == vertex.position());
+        BOOST_TEST(close(vertices[i].inclination(), vertex.inclination(), angle_ulp));
+        BOOST_TEST(close(vertices[i].azimuth(), vertex.azimuth(), angle_ulp));
+
+        BOOST_TEST(close(points[i].x, interpolator->x_at_position(positions[i]), projection_ulp, positions[i]));
+        BOOST_TEST(close(points[i].y, interpolator->y_at_position(positions[i]), projection_ulp, positions[i]));
+        BOOST_TEST(close(points[i].z, interpolator->z_at_position(positions[i]), projection_ulp, positions[i]));
+        BOOST_TEST(points_mt[i].x == points[i].x);
+    }
+
+    std::vector<Vertex> wrong_size(positions.size() - 1);
+    BOOST_CHECK_THROW(interpolator->evaluate(positions, wrong_size, {}, 1), std::invalid_argument);
+}
+
+BOOST_DATA_TEST_CASE(test_generate_points, data::make(Samples::interpolation_types), interpolation_type)
+{
+    auto interpolator = make_interpolator(Samples::SPE84246, interpolation_type);
+
+    auto const num_points = 500;
+    auto const points = interpolator->generate_points(num_points);
+    auto const vertices = interpolator->generate_vertices(num_points);
+    auto const x_projections = interpolator->generate_x_projections(num_points);
+    auto const z_projections = interpolator->generate_z_projections(num_points);
+    BOOST_TEST(points.size() == num_points);
+
+    // the ULP bounds of test_evaluate
+    auto constexpr angle_ulp = 8.0;
+    auto constexpr projection_ulp = 4.0;
+
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        auto const position = points[i].vertex.position();
+        BOOST_TEST(position == vertices[i].position());
+        BOOST_TEST(points[i].vertex.inclination() == vertices[i].inclination());
+        BOOST_TEST(points[i].vertex.azimuth() == vertices[i].azimuth());
+        BOOST_TEST(close(points[i].point.x, x_projections[i], projection_ulp, position));
+        BOOST_TEST(close(points[i].point.z, z_projections[i], projection_ulp, position));
+
+        auto const [vertex, point] = interpolator->point_at_position(position);
+        BOOST_TEST(close(points[i].vertex.inclination(), vertex.inclination(), angle_ulp));
+        BOOST_TEST(close(points[i].vertex.azimuth(), vertex.azimuth(), angle_ulp));
+        BOOST_TEST(close(points[i].point.x, point.x, projection_ulp, position));
+        BOOST_TEST(close(points[i].point.y, point.y, projection_ulp, position));
+        BOOST_TEST(close(points[i].point.z, point.z, projection_ulp, position));
+    }
+
+    BOOST_TEST(interpolator->generate_points(num_points, 0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_position_grid)
+{
+    auto const check_fill = [](const PositionGrid &grid) {
+        std::vector<double> positions(grid.size());
+        grid.fill(0, positions);
+        for (std::size_t i = 0; i < grid.size(); ++i)
+        {
+            BOOST_TEST(positions[i] == grid[i]);
+            BOOST_TEST((i == 0 || positions[i - 1] < positions[i]));
+        }
+
+        // any range is computed on its own
+        auto const offset = grid.size() / 3;
+        std::vector<double> middle(grid.size() / 2);
+        grid.fill(offset, middle);
+        for (std::size_t i = 0; i < middle.size(); ++i)
+        {
+            BOOST_TEST(middle[i] == positions[offset + i]);
+        }
+    };
+
+    // closed form: no accumulated rounding error
+    auto const uniform = PositionGrid::uniform(214.13724, 0.1, 1000000);
+    BOOST_TEST(uniform.size() == 1000000);
+    BOOST_TEST(uniform[999999] == 214.13724 + 999999 * 0.1);
+    check_fill(PositionGrid::uniform(0.0, 0.25, 1000));
+
+    BOOST_TEST(PositionGrid::fixed_step(0.0, 90.0, 30.0).size() == 4);
+    BOOST_TEST(PositionGrid::fixed_step(0.0, 0.3, 0.1)[3] == 0.1 * 3);
+    BOOST_TEST(PositionGrid::fixed_step(0.0, 100.0, 30.0).size() == 4);
+    BOOST_TEST(PositionGrid::fixed_step(0.0, 100.0, 30.0)[3] == 90.0);
+    check_fill(PositionGrid::fixed_step(10.0, 1000.0, 7.0));
+
+    auto const logarithmic = PositionGrid::logarithmic(1.0, 1000.0, 4);
+    BOOST_TEST(logarithmic[0] == 1.0);
+    BOOST_TEST(fabs(logarithmic[1] - 10.0) < 1E-12);
+    BOOST_TEST(fabs(logarithmic[2] - 100.0) < 1E-12);
+    BOOST_TEST(logarithmic[3] == 1000.0);
+    check_fill(PositionGrid::logarithmic(0.5, 5000.0, 777));
+
+    // the stations on the grid or out of its range are skipped
+    auto const stations = std::vector<double>{-5.0, 5.0, 10.0, 25.0, 25.0, 100.0, 200.0};
+    auto const with_stations = PositionGrid::uniform(0.0, 10.0, 11).with_stations(stations);
+    BOOST_TEST(with_stations.size() == 13);
+    BOOST_TEST(with_stations[1] == 5.0);
+    BOOST_TEST(with_stations[4] == 25.0);
+    BOOST_TEST(with_stations[12] == 100.0);
+    check_fill(with_stations);
+    check_fill(PositionGrid::logarithmic(1.0, 3018.0, 100).with_stations(Samples::SPE84246.positions_view()));
+
+    BOOST_CHECK_THROW(PositionGrid::uniform(0.0, -1.0, 10), std::invalid_argument);
+    BOOST_CHECK_THROW(PositionGrid::fixed_step(0.0, 10.0, 0.0), std::invalid_argument);
+    BOOST_CHECK_THROW(PositionGrid::fixed_step(10.0, 0.0, 1.0), std::invalid_argument);
+    BOOST_CHECK_THROW(PositionGrid::logarithmic(0.0, 10.0, 10), std::invalid_argument);
+    BOOST_CHECK_THROW(PositionGrid::logarithmic(1.0, 10.0, 1), std::invalid_argument);
+}
+
+BOOST_DATA_TEST_CASE(test_generate_grid, data::make(Samples::interpolation_types), interpolation_type)
+{
+    auto interpolator = make_interpolator(Samples::SPE84246, interpolation_type);
+    auto const &stations = interpolator->trajectory().positions_view();
+
+    // the generate methods with a number of points use a uniform grid
+    auto const num_points = 500;
+    auto const step = (stations.back() - stations.front()) / num_points;
+    auto const points = interpolator->generate_points(num_points);
+    auto const uniform = PositionGrid::uniform(stations.front(), step, num_points);
+    auto const grid_points = interpolator->generate_points(uniform, 3);
+    BOOST_TEST(grid_points.size() == points.size());
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        BOOST_TEST(points[i].vertex.position() == stations.front() + static_cast<double>(i) * step);
+        BOOST_TEST(grid_points[i].vertex.position() == points[i].vertex.position());
+        BOOST_TEST(grid_points[i].point.y == points[i].point.y);
+    }
+
+    // every station is in a station-inclusive grid, with its vertex
+    auto const grid = PositionGrid::fixed_step(stations.front(), stations.back(), 30.0).with_stations(stations);
+    auto const vertices = interpolator->generate_vertices(grid);
+    BOOST_TEST(vertices.size() == grid.size());
+    for (auto const &station : interpolator->trajectory())
+    {
+        auto const vertex = std::find_if(vertices.begin(), vertices.end(), [&station](const Vertex &vertex) {
+            return vertex.position() == station.position();
+        });
+        BOOST_TEST((vertex != vertices.end() && vertex->approx_equal(station)));
+    }
+
+    std::vector<TrajectoryPoint> chunks;
+    interpolator->generate_chunks(
+        grid, 64,
+        [&chunks](std::size_t offset, std::span<const Vertex> chunk_vertices, std::span<const Point> chunk_points) {
+            BOOST_TEST(offset == chunks.size());
+            for (std::size_t i = 0; i < chunk_vertices.size(); ++i)
+            {
+                chunks.push_back({chunk_vertices[i], chunk_points[i]});
+            }
+        },
+        2, true);
+    auto const grid_points_expected = interpolator->generate_points(grid, 1);
+    BOOST_TEST(chunks.size() == grid.size());
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+        BOOST_TEST(chunks[i].vertex.position() == vertices[i].position());
+        BOOST_TEST(chunks[i].point.x == grid_points_expected[i].point.x);
+    }
+}
+
+BOOST_DATA_TEST_CASE(test_trajectory_cursor, data::make(Samples::interpolation_types), interpolation_type)
+{
+    auto interpolator = make_interpolator(Samples::SPE84246, interpolation_type);
+    auto cursor = TrajectoryCursor(*interpolator);
+
+    auto const check = [&interpolator, &cursor](double position) {
+        auto const [vertex, point] = cursor.point_at_position(position);
+        auto const [vertex_expected, point_expected] = interpolator->point_at_position(position);
+        BOOST_TEST(vertex.inclination() == vertex_expected.inclination());
+        BOOST_TEST(vertex.azimuth() == vertex_expected.azimuth());
+        BOOST_TEST(point.x == point_expected.x);
+        BOOST_TEST(point.y == point_expected.y);
+        BOOST_TEST(point.z == point_expected.z);
+        BOOST_TEST(cursor.upper_index() == interpolator->trajectory().upper_bound_index(position));
+    };
+
+    // monotone walk, including the vertices and beyond the trajectory
+    for (double position = 0.0; position < 3200.0; position += 7.3)
+    {
+        check(position);
+    }
+    for (auto position : interpolator->trajectory().positions())
+    {
+        check(position);
+    }
+
+    // jumps back and forth
+    for (auto position : {3000.0, 100.0, 1295.4, 214.13724, 4000.0, 600.0})
+    {
+        check(position);
+        auto const vertex = cursor.vertex_at_position(position);
+        BOOST_TEST(vertex.position() == interpolator->vertex_at_position(position).position());
+    }
+
+    // the remembered segment is only a hint, so the cursor survives trajectory changes
+    interpolator->drop_n_add({3500.0, 2.0, 5.0});
+    check(3400.0);
+    cursor.reset();
+    BOOST_TEST(cursor.upper_index() == 0);
+    check(1000.0);
+}
+
+BOOST_DATA_TEST_CASE(test_trajectory_index, data::make(Samples::interpolation_types), interpolation_type)
+{
+    auto interpolator = make_interpolator(Samples::SPE84246, interpolation_type);
+    auto index = TrajectoryIndex(*interpolator);
+
+    auto const squared_distance = [](const Point &lhs, const Point &rhs) {
+        return (lhs.x - rhs.x) * (lhs.x - rhs.x) + (lhs.y - rhs.y) * (lhs.y - rhs.y) +
+               (lhs.z - rhs.z) * (lhs.z - rhs.z);
+    };
+
+    // points around the trajectory and far from it, against a dense sampling
+    std::vector<Point> points;
+    for (std::size_t i = 0; i < 60; ++i)
+    {
+        auto const offset = static_cast<double>(i % 7) * 25.0 - 75.0;
+        auto const point = interpolator->point_at_position(214.13724 + static_cast<double>(i) * 47.3).point;
+        points.push_back({point.x + offset, point.y - offset / 2.0, point.z + offset * static_cast<double>(i % 3)});
+    }
+    points.push_back({5000.0, -5000.0, -1000.0});
+    points.push_back({0.0, 0.0, 0.0});
+
+    // the stations too, since the cubic interpolation jumps at them
+    auto const &stations = interpolator->trajectory().positions_view();
+    auto const dense =
+        interpolator->generate_points(PositionGrid::uniform(stations.front(), 0.01, 280400).with_stations(stations));
+    auto const closest_points = index.closest_points(points, 3);
+    BOOST_TEST(closest_points.size() == points.size());
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        auto sampled = std::numeric_limits<double>::max();
+        for (auto const &sample : dense)
+        {
+            sampled = std::min(sampled, squared_distance(sample.point, points[i]));
+        }
+        sampled = std::sqrt(sampled);
+
+        auto const closest = index.closest_point(points[i]);
+        // the position is found up to a tolerance, which matters only for the points on the trajectory
+        BOOST_TEST(closest.distance <= sampled + 1E-4);
+        BOOST_TEST(closest.distance >= sampled - 5E-2);
+        BOOST_TEST(closest.distance == std::sqrt(squared_distance(closest.point.point, points[i])));
+
+        auto const expected = interpolator->point_at_position(closest.point.vertex.position());
+        BOOST_TEST(closest.point.vertex.approx_equal(expected.vertex, 1E-12));
+        BOOST_TEST(squared_distance(closest.point.point, expected.point) < 1E-18);
+        BOOST_TEST(closest_points[i].distance == closest.distance);
+        BOOST_TEST(closest_points[i].point.vertex.position() == closest.point.vertex.position());
+
+        // a point for each trajectory segment (the neighbours may share a vertex), the nearest first
+        auto const segments = index.nearest_segments(points[i], 5);
+        BOOST_TEST(segments.size() == interpolator->trajectory().size() - 1);
+        BOOST_TEST(segments.front().distance == closest.distance);
+        for (std::size_t j = 1; j < segments.size(); ++j)
+        {
+            BOOST_TEST(segments[j - 1].distance <= segments[j].distance);
+        }
+        BOOST_TEST(index.nearest_segments(points[i], 1).front().distance == closest.distance);
+    }
+    BOOST_TEST(index.nearest_segments(points.front(), 0).empty());
+
+    // on the trajectory, up to the tolerance of the position
+    for (auto position : {214.13724, 598.800936, 1000.0, 2500.0, 3018.032064})
+    {
+        auto const closest = index.closest_point(interpolator->point_at_position(position).point);
+        BOOST_TEST(closest.distance < 1E-3);
+    }
+
+    // the index is rebuilt after the trajectory changes
+    interpolator->add_n_drop({3500.0, 2.0, 5.0});
+    index.update();
+    auto const far_point = interpolator->point_at_position(3400.0).point;
+    BOOST_TEST(index.closest_point(far_point).distance < 1E-3);
+}
+
+BOOST_DATA_TEST_CASE(test_trajectory_index_bend, data::make(Samples::interpolation_types), interpolation_type)
+{
+    // the cubic segments turn much more than their doglegs, and a segment ending vertical or next to one takes the
+    // azimuth 0 inside (minimum curvature), so the pieces must follow the curve, not the stations
+    auto const trajectories = std::vector<Vertices>{
+        Vertices({{0.0, 3.0, 1.1}, {400.0, 2.6, 1.4}, {1000.0, 1.0, 4.5}, {1500.0, 2.0, 3.2}}),
+        Vertices({{0.0, 1.1, 5.1}, {500.0, 1.7, 0.3}, {1500.0, 2.0, 3.4}, {2300.0, 0.6, 5.6}}),
+        Vertices(
+            {{0.0, 0.0, 6.2454678},
+             {61.897223, 0.048911145, 0.008116982},
+             {122.6985, 0.013193542, 6.2173487},
+             {194.63572, 0.0, 6.2031821},
+             {277.4122, 0.043440073, 6.2661679},
+             {346.70643, 0.033716521, 0.051463454},
+             {446.10959, 0.0, 6.2691946},
+             {569.06241, 0.013129189, 0.067152545}})};
+
+    auto const squared_distance = [](const Point &lhs, const Point &rhs) {
+        return (lhs.x - rhs.x) * (lhs.x - rhs.x) + (lhs.y - rhs.y) * (lhs.y - rhs.y) +
+               (lhs.z - rhs.z) * (lhs.z - rhs.z);
+    };
+
+    for (auto const &trajectory : trajectories)
+    {
+        auto const interpolator = make_interpolator(trajectory, interpolation_type);
+        auto const index = TrajectoryIndex(*interpolator);
+
+        auto const &stations = interpolator->trajectory().positions_view();
+        auto const dense = interpolator->generate_points(
+            PositionGrid::fixed_step(stations.front(), stations.back(), 0.05).with_stations(stations));
+        for (std::size_t i = 0; i < 200; ++i)
+        {
+            auto const offset = static_cast<double>(i % 9) * 25.0 - 100.0;
+            auto const point =
+                interpolator->point_at_position(stations.back() * (static_cast<double>(i) + 0.5) / 200.0).point;
+            auto const query =
+                Point{point.x + offset, point.y - offset / 2.0, point.z + offset * static_cast<double>(i % 3)};
+
+            auto sampled = std::numeric_limits<double>::max();
+            for (auto const &sample : dense)
+            {
+                sampled = std::min(sampled, squared_distance(sample.point, query));
+            }
+            sampled = std::sqrt(sampled);
+
+            // not farther than the samples, up to the tolerance of the position
+            BOOST_TEST(index.closest_point(query).distance <= sampled + 1E-4);
+            BOOST_TEST(index.nearest_segments(query, 3).front().distance <= sampled + 1E-4);
+        }
+    }
+}
+
+BOOST_DATA_TEST_CASE(test_anti_collision_scan, data::make(Samples::interpolation_types), interpolation_type)
+{
+    auto reference = make_interpolator(Samples::SPE84246, interpolation_type);
+
+    // an offset which crosses below the reference and one far from it
+    auto offset = make_interpolator(
+        Vertices({{0.0, 0.0, 0.0}, {500.0, 0.3, 3.0}, {1500.0, 0.9, 2.5}, {2500.0, 1.2, 2.0}}), interpolation_type);
+    auto const origin = Point{100.0, 150.0, 0.0};
+    auto const far_origin = Point{20000.0, 0.0, 0.0};
+
+    auto scan = AntiCollisionScan(*reference, 1000.0);
+    scan.add_offset(*offset, origin);
+    scan.add_offset(*offset, far_origin);
+
+    auto const &stations = reference->trajectory().positions_view();
+    auto const grid = PositionGrid::fixed_step(stations.front(), stations.back(), 30.0).with_stations(stations);
+    auto const profiles = scan.scan(grid, 1);
+    BOOST_TEST(profiles.size() == 2);
+
+    // the offset is farther than the scan radius
+    for (auto const &closest : profiles[1].offset_points)
+    {
+        BOOST_TEST(closest.distance == std::numeric_limits<double>::max());
+    }
+
+    // against the nearest offset point found without the scan (in the offset coordinates)
+    auto const index = TrajectoryIndex(*offset);
+    auto const &profile = profiles.front();
+    BOOST_TEST(profile.offset_points.size() == grid.size());
+    for (std::size_t i = 0; i < grid.size(); ++i)
+    {
+        auto const reference_point = reference->point_at_position(grid[i]).point;
+        auto const expected = index.closest_point(
+            {reference_point.x - origin.x, reference_point.y - origin.y, reference_point.z - origin.z});
+        auto const &closest = profile.offset_points[i];
+        if (expected.distance > 1000.0)
+        {
+            BOOST_TEST(closest.distance == std::numeric_limits<double>::max());
+            continue;
+        }
+        BOOST_TEST(fabs(closest.distance - expected.distance) < 1E-9);
+        BOOST_TEST(profile.offset_points[profile.minimum_index].distance <= closest.distance);
+    }
+
+    // the separation closes at the crossing
+    BOOST_TEST(profile.offset_points[profile.minimum_index].distance < 200.0);
+
+    // the threads split the reference positions too, with the same results
+    auto const threaded = scan.scan(grid, 4);
+    BOOST_TEST(threaded.front().minimum_index == profile.minimum_index);
+    for (std::size_t i = 0; i < grid.size(); ++i)
+    {
+        BOOST_TEST(threaded.front().offset_points[i].distance == profile.offset_points[i].distance);
+    }
+
+    BOOST_CHECK_THROW(AntiCollisionScan(*reference, 0.0), std::invalid_argument);
+}
+
+BOOST_DATA_TEST_CASE(
+    test_anti_collision_scan_cubic_offset, data::make(Samples::interpolation_types), interpolation_type)
+{
+    auto reference = make_interpolator(Samples::SPE84246, interpolation_type);
+
+    // a cubic offset whose segments turn much more than their doglegs, starting next to the reference
+    auto offset = make_interpolator(
+        Vertices({{0.0, 1.7, 2.8}, {600.0, 1.3, 5.5}, {1700.0, 1.8, 3.4}, {2800.0, 0.5, 1.4}}),
+        InterpolationType::cubic);
+    auto const origin = reference->point_at_position(2500.0).point;
+
+    auto scan = AntiCollisionScan(*reference, 5000.0);
+    scan.add_offset(*offset, origin);
+
+    auto const &stations = reference->trajectory().positions_view();
+    auto const grid = PositionGrid::fixed_step(stations.front(), stations.back(), 10.0).with_stations(stations);
+    auto const profile = scan.scan(grid, 2).front();
+
+    // against the nearest point of a dense sampling of the offset
+    auto const &offset_stations = offset->trajectory().positions_view();
+    auto const dense = offset->generate_points(
+        PositionGrid::fixed_step(offset_stations.front(), offset_stations.back(), 0.05).with_stations(offset_stations));
+    for (std::size_t i = 0; i < grid.size(); ++i)
+    {
+        auto const reference_point = reference->point_at_position(grid[i]).point;
+        auto sampled = std::numeric_limits<double>::max();
+        for (auto const &sample : dense)
+        {
+            sampled = std::min(
+                sampled, std::hypot(
+                             reference_point.x - origin.x - sample.point.x,
+                             reference_point.y - origin.y - sample.point.y,
+                             reference_point.z - origin.z - sample.point.z));
+        }
+
+        // not farther than the samples, up to the tolerance of the position
+        BOOST_TEST(profile.offset_points[i].distance <= sampled + 1E-4);
+    }
+}
+
+BOOST_DATA_TEST_CASE(test_positions_at_plane, data::make(Samples::interpolation_types), interpolation_type)
+{
+    auto interpolator = make_interpolator(Samples::SPE84246, interpolation_type);
+    auto const index = TrajectoryIndex(*interpolator);
+
+    auto const distance_at = [&interpolator](const Plane &plane, double position) {
+        auto const point = interpolator->point_at_position(position).point;
+        return plane.normal.x * point.x + plane.normal.y * point.y + plane.normal.z * point.z - plane.offset;
+    };
+
+    // the sign changes of a dense sampling, refined by bisection
+    auto const &stations = interpolator->trajectory().positions_view();
+    auto const grid = PositionGrid::uniform(stations.front(), 0.1, 28040).with_stations(stations);
+    auto const dense = interpolator->generate_points(grid);
+    auto const sampled_positions = [&distance_at, &grid, &dense](const Plane &plane) {
+        std::vector<double> positions;
+        for (std::size_t i = 0; i < grid.size(); ++i)
+        {
+            auto const &point = dense[i].point;
+            auto const distance =
+                plane.normal.x * point.x + plane.normal.y * point.y + plane.normal.z * point.z - plane.offset;
+            if (distance == 0.0)
+            {
+                positions.push_back(grid[i]);
+            }
+            else if (i > 0 && (distance < 0.0) != (distance_at(plane, grid[i - 1]) < 0.0) &&
+                     distance_at(plane, grid[i - 1]) != 0.0)
+            {
+                auto a = grid[i - 1];
+                auto b = grid[i];
+                for (std::size_t iteration = 0; iteration < 100; ++iteration)
+                {
+                    auto const middle = (a + b) / 2.0;
+                    ((distance_at(plane, middle) < 0.0) == (distance < 0.0) ? b : a) = middle;
+                }
+                // not the jump of the cubic interpolation at the last vertex
+                if (fabs(distance_at(plane, (a + b) / 2.0)) < 1E-6)
+                {
+                    positions.push_back((a + b) / 2.0);
+                }
+            }
+        }
+        return positions;
+    };
+
+    // the highest point, where a plane just below touches the trajectory twice
+    auto highest = dense.front().point.z;
+    for (auto const &sample : dense)
+    {
+        highest = std::max(highest, sample.point.z);
+    }
+
+    std::vector<Plane> planes;
+    for (auto z : {0.0, 300.0, 1000.0, 1500.0, highest - 1E-2, 5000.0})
+    {
+        planes.push_back({{0.0, 0.0, 1.0}, z});
+    }
+    planes.push_back({{1.0, 0.0, 0.0}, -100.0});
+    planes.push_back({{0.0, 1.0, 0.0}, 250.0});
+    planes.push_back({{1.0, -2.0, 0.5}, 300.0});
+
+    auto const all_positions = index.positions_at_plane(planes, 3);
+    BOOST_TEST(all_positions.size() == planes.size());
+    for (std::size_t i = 0; i < planes.size(); ++i)
+    {
+        auto const positions = index.positions_at_plane(planes[i]);
+        auto const expected = sampled_positions(planes[i]);
+        BOOST_TEST(positions == all_positions[i]);
+        BOOST_TEST(std::is_sorted(positions.begin(), positions.end()));
+        BOOST_TEST_REQUIRE(positions.size() == expected.size());
+        for (std::size_t j = 0; j < positions.size(); ++j)
+        {
+            BOOST_TEST(fabs(positions[j] - expected[j]) < 1E-6);
+            BOOST_TEST(fabs(distance_at(planes[i], positions[j])) < 1E-9);
+        }
+    }
+    BOOST_TEST(all_positions[4].size() >= 2);
+    BOOST_TEST(all_positions[5].empty());
+
+    // the axis planes
+    auto const values = std::vector<double>{-100.0, 250.0, 1000.0};
+    BOOST_TEST(index.positions_at_x(values)[0] == all_positions[6]);
+    BOOST_TEST(index.positions_at_y(values)[1] == all_positions[7]);
+    BOOST_TEST(index.positions_at_z(values)[2] == all_positions[2]);
+
+    BOOST_CHECK_THROW(index.positions_at_plane(Plane{{0.0, 0.0, 0.0}, 1.0}), std::invalid_argument);
+}
+
+BOOST_DATA_TEST_CASE(test_interval_aggregates, data::make(Samples::interpolation_types), interpolation_type)
+{
+    auto interpolator = make_interpolator(Samples::SPE84246, interpolation_type);
+
+    auto const tangent = [](const Vertex &vertex) {
+        return Point{
+            sin(vertex.inclination()) * cos(vertex.azimuth()), sin(vertex.inclination()) * sin(vertex.azimuth()),
+            cos(vertex.inclination())};
+    };
+    auto const dogleg = [&tangent](const Vertex &first, const Vertex &last) {
+        auto const t_1 = tangent(first);
+        auto const t_2 = tangent(last);
+        return std::acos(std::clamp(t_1.x * t_2.x + t_1.y * t_2.y + t_1.z * t_2.z, -1.0, 1.0));
+    };
+
+    // against a dense sampling, which includes the stations
+    auto const &stations = interpolator->trajectory().positions_view();
+    auto const grid = PositionGrid::uniform(stations.front(), 0.01, 280400).with_stations(stations);
+    auto const dense = interpolator->generate_points(grid);
+
+    auto const ranges = std::vector<std::pair<double, double>>{
+        {214.13724, 3018.032064}, {1000.0, 2500.0}, {300.0, 350.0},          {598.800936, 1550.31948},
+        {2000.0, 3018.032064},    {-100.0, 5000.0}, {598.800936, 598.800936}};
+    for (auto const &[first_position, last_position] : ranges)
+    {
+        auto const aggregates = interpolator->interval_aggregates(first_position, last_position);
+
+        // the range is clamped to the trajectory
+        auto const first = std::clamp(first_position, stations.front(), stations.back());
+        auto const last = std::clamp(last_position, stations.front(), stations.back());
+        IntervalAggregates expected;
+        for (auto const &position : {first, last})
+        {
+            auto const point = interpolator->point_at_position(position).point;
+            for (auto axis : {&Point::x, &Point::y, &Point::z})
+            {
+                expected.lower.*axis = std::min(expected.lower.*axis, point.*axis);
+                expected.upper.*axis = std::max(expected.upper.*axis, point.*axis);
+            }
+        }
+        for (std::size_t i = 0; i < grid.size(); ++i)
+        {
+            if (grid[i] < first || grid[i] > last)
+            {
+                continue;
+            }
+            for (auto axis : {&Point::x, &Point::y, &Point::z})
+            {
+                expected.lower.*axis = std::min(expected.lower.*axis, dense[i].point.*axis);
+                expected.upper.*axis = std::max(expected.upper.*axis, dense[i].point.*axis);
+            }
+        }
+
+        // the extrema between the samples are found too, which the samples miss by up to the step times the slope
+        auto const sampling_tol = 1E-3;
+        for (auto axis : {&Point::x, &Point::y, &Point::z})
+        {
+            BOOST_TEST((aggregates.lower.*axis <= expected.lower.*axis + 1E-9));
+            BOOST_TEST((aggregates.lower.*axis >= expected.lower.*axis - sampling_tol));
+            BOOST_TEST((aggregates.upper.*axis >= expected.upper.*axis - 1E-9));
+            BOOST_TEST((aggregates.upper.*axis <= expected.upper.*axis + sampling_tol));
+        }
+
+        // the doglegs of the segments, and of the parts of them at the ends of the range
+        auto max_dogleg = 0.0;
+        auto max_dogleg_severity = 0.0;
+        auto previous = first;
+        for (auto position : stations)
+        {
+            if (position <= first || previous >= last)
+            {
+                continue;
+            }
+            auto const next = std::min(position, last);
+            auto const part_dogleg =
+                dogleg(interpolator->vertex_at_position(previous), interpolator->vertex_at_position(next));
+            max_dogleg = std::max(max_dogleg, part_dogleg);
+            max_dogleg_severity = std::max(max_dogleg_severity, part_dogleg / (next - previous));
+            previous = next;
+        }
+        BOOST_TEST(fabs(aggregates.max_dogleg - max_dogleg) < 1E-9);
+        BOOST_TEST(fabs(aggregates.max_dogleg_severity - max_dogleg_severity) < 1E-9);
+    }
+
+    BOOST_CHECK_THROW(interpolator->interval_aggregates(2000.0, 1000.0), std::invalid_argument);
+    BOOST_CHECK_THROW(
+        make_interpolator(Vertices(), interpolation_type)->interval_aggregates(0.0, 1.0), std::invalid_argument);
+}
+
+BOOST_DATA_TEST_CASE(test_generate_adaptive_points, data::make(Samples::interpolation_types), interpolation_type)
+{
+    auto interpolator = make_interpolator(Samples::SPE84246, interpolation_type);
+    auto const &stations = interpolator->trajectory().positions_view();
+
+    auto const max_chord_deviation = 0.05;
+    auto const points = interpolator->generate_adaptive_points(max_chord_deviation);
+    auto const grid = PositionGrid::fixed_step(stations.front(), stations.back(), 1.0);
+    BOOST_TEST(points.size() < grid.size() / 4);
+
+    // sorted, with every station
+    for (std::size_t i = 1; i < points.size(); ++i)
+    {
+        BOOST_TEST(points[i - 1].vertex.position() < points[i].vertex.position());
+    }
+    for (auto position : stations)
+    {
+        BOOST_TEST(std::any_of(points.begin(), points.end(), [position](const TrajectoryPoint &point) {
+            return point.vertex.position() == position;
+        }));
+    }
+    BOOST_TEST(points.back().point.x == interpolator->point_at_position(stations.back()).point.x);
+
+    // the chord between neighbour points, which is not checked across a jump of the interpolation (the cubic one at
+    // the last station)
+    auto const chord_of = [](const TrajectoryPoint &first, const TrajectoryPoint &last) {
+        return Point{last.point.x - first.point.x, last.point.y - first.point.y, last.point.z - first.point.z};
+    };
+    auto const is_jump = [&chord_of, max_chord_deviation](const TrajectoryPoint &first, const TrajectoryPoint &last) {
+        auto const chord = chord_of(first, last);
+        return std::sqrt(chord.x * chord.x + chord.y * chord.y + chord.z * chord.z) >
+               4.0 * (last.vertex.position() - first.vertex.position()) + max_chord_deviation;
+    };
+
+    // the curve between neighbour points is near their chord
+    for (std::size_t i = 1; i < points.size(); ++i)
+    {
+        auto const &first = points[i - 1];
+        auto const &last = points[i];
+        if (is_jump(first, last))
+        {
+            continue;
+        }
+
+        auto const chord = chord_of(first, last);
+        auto const squared_length = chord.x * chord.x + chord.y * chord.y + chord.z * chord.z;
+        auto const delta_s = last.vertex.position() - first.vertex.position();
+        for (std::size_t j = 1; j < 16; ++j)
+        {
+            auto const point = interpolator->point_at_position(first.vertex.position() + delta_s * j / 16.0).point;
+            auto const offset = Point{point.x - first.point.x, point.y - first.point.y, point.z - first.point.z};
+            auto const t = (offset.x * chord.x + offset.y * chord.y + offset.z * chord.z) / squared_length;
+            auto const distance = std::sqrt(
+                std::pow(offset.x - t * chord.x, 2) + std::pow(offset.y - t * chord.y, 2) +
+                std::pow(offset.z - t * chord.z, 2));
+            BOOST_TEST(distance < 1.5 * max_chord_deviation);
+        }
+    }
+
+    // the angular tolerance bounds the turn between neighbour points, and a tighter tolerance samples more
+    auto const max_angle = 0.02;
+    auto const angle_points = interpolator->generate_adaptive_points(1E6, max_angle);
+    for (std::size_t i = 1; i < angle_points.size(); ++i)
+    {
+        auto const &first = angle_points[i - 1].vertex;
+        auto const &last = angle_points[i].vertex;
+        if (is_jump(angle_points[i - 1], angle_points[i]))
+        {
+            continue;
+        }
+        auto const cos_turn = std::cos(first.inclination()) * std::cos(last.inclination()) +
+                              std::sin(first.inclination()) * std::sin(last.inclination()) *
+                                  std::cos(last.azimuth() - first.azimuth());
+        BOOST_TEST(std::acos(std::clamp(cos_turn, -1.0, 1.0)) <= max_angle + 1E-9);
+    }
+    BOOST_TEST(interpolator->generate_adaptive_points(1E6, max_angle / 4).size() > angle_points.size());
+
+    // the threads split the segments, the points are the same
+    auto const points_st = interpolator->generate_adaptive_points(max_chord_deviation, 0.1, 1);
+    auto const points_mt = interpolator->generate_adaptive_points(max_chord_deviation, 0.1, 4);
+    BOOST_TEST(points_st.size() == points_mt.size());
+    for (std::size_t i = 0; i < std::min(points_st.size(), points_mt.size()); ++i)
+    {
+        BOOST_TEST(points_st[i].vertex.position() == points_mt[i].vertex.position());
+        BOOST_TEST(points_st[i].point.z == points_mt[i].point.z);
+    }
+
+    // a straight trajectory is only its stations
+    auto const straight = make_interpolator(
+        Vertices(std::vector<Vertex>{{0.0, 0.5, 1.0}, {100.0, 0.5, 1.0}, {250.0, 0.5, 1.0}}), interpolation_type);
+    BOOST_TEST(straight->generate_adaptive_points(1E-6, 1E-6).size() == 3);
+
+    BOOST_TEST(make_interpolator(Vertices(), interpolation_type)->generate_adaptive_points(0.1).empty());
+    BOOST_CHECK_THROW(interpolator->generate_adaptive_points(0.0), std::invalid_argument);
+    BOOST_CHECK_THROW(interpolator->generate_adaptive_points(0.1, -1.0), std::invalid_argument);
+}
+
+BOOST_DATA_TEST_CASE(test_generate_chunks, data::make(Samples::interpolation_types), interpolation_type)
+{
+    auto interpolator = make_interpolator(Samples::SPE84246, interpolation_type);
+
+    auto const num_points = 1000;
+    auto const expected = interpolator->generate_points(num_points);
+
+    for (auto prefetch : {false, true})
+    {
+        std::size_t num_chunks = 0;
+        std::size_t next_offset = 0;
+        interpolator->generate_chunks(
+            num_points, 128,
+            [&](std::size_t offset, std::span<const Vertex> vertices, std::span<const Point> points) {
+                BOOST_TEST(offset == next_offset);
+                BOOST_TEST(vertices.size() == points.size());
+                BOOST_TEST(vertices.size() <= 128);
+                for (std::size_t i = 0; i < vertices.size(); ++i)
+                {
+                    BOOST_TEST(vertices[i].position() == expected[offset + i].vertex.position());
+                    BOOST_TEST(vertices[i].inclination() == expected[offset + i].vertex.inclination());
+                    BOOST_TEST(points[i].z == expected[offset + i].point.z);
+                }
+                next_offset += vertices.size();
+                ++num_chunks;
+            },
+            4, prefetch);
+
+        BOOST_TEST(next_offset == num_points);
+        BOOST_TEST(num_chunks == 8);
+    }
+
+    // the consumer exception is propagated after the prefetched chunk is done
+    BOOST_CHECK_THROW(
+        interpolator->generate_chunks(
+            num_points, 100,
+            [](std::size_t offset, std::span<const Vertex>, std::span<const Point>) {
+                if (offset == 300)
+                {
+                    throw std::runtime_error("consumer failed");
+                }
+            },
+            4, true),
+        std::runtime_error);
+    BOOST_CHECK_THROW(
+        interpolator->generate_chunks(num_points, 0, [](std::size_t, auto, auto) {}), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_thread_pool)
+{
+    utils::ThreadPool thread_pool(4);
+    BOOST_TEST(thread_pool.size() == 4);
+
+    std::vector<std::atomic<int>> chunks_done(1000);
+    thread_pool.parallel_for(chunks_done.size(), 4, [&chunks_done](std::size_t chunk) { ++chunks_done[chunk]; });
+    BOOST_TEST(std::all_of(chunks_done.begin(), chunks_done.end(), [](const auto &done) { return done == 1; }));
+
+    BOOST_CHECK_THROW(
+        thread_pool.parallel_for(
+            100, 4,
+            [](std::size_t chunk) {
+                if (chunk == 42)
+                {
+                    throw std::runtime_error("chunk failed");
+                }
+            }),
+        std::runtime_error);
+
+    std::vector<int> input(10000);
+    std::iota(input.begin(), input.end(), 0);
+    auto output = utils::Multithreading::run<int>(
+        thread_pool, input.begin(), input.end(), std::numeric_limits<unsigned>::max(), [](int i) { return 2 * i; });
+    BOOST_TEST(output.size() == input.size());
+    for (std::size_t i = 0; i < output.size(); ++i)
+    {
+        BOOST_TEST(output[i] == 2 * input[i]);
+    }
+
+    // caller-provided buffer, written in place
+    std::vector<int> buffer(input.size() + 1, -1);
+    utils::Multithreading::run_into(
+        thread_pool, input.begin(), input.end(), std::span<int>(buffer).begin(), 4, [](int i) { return i + 1; });
+    BOOST_TEST(buffer.back() == -1);
+    for (std::size_t i = 0; i < input.size(); ++i)
+    {
+        BOOST_TEST(buffer[i] == input[i] + 1);
+    }
+
+    // a result per chunk, at the chunk index
+    for (auto const range_length : {std::size_t{1}, std::size_t{100}, std::size_t{10007}})
+    {
+        auto const num_chunks = utils::Multithreading::num_chunks(range_length, 4);
+        auto const chunk_size = range_length / num_chunks;
+        std::vector<std::atomic<int>> chunk_runs(num_chunks);
+        utils::Multithreading::run_chunks(
+            thread_pool, range_length, 4,
+            [&chunk_runs, chunk_size](std::size_t first, std::size_t) { ++chunk_runs[first / chunk_size]; });
+        BOOST_TEST(std::all_of(chunk_runs.begin(), chunk_runs.end(), [](const auto &runs) { return runs == 1; }));
+    }
+    BOOST_TEST(utils::Multithreading::num_chunks(0, 4) == 0);
+    BOOST_TEST(utils::Multithreading::num_chunks(100, 0) == 0);
+
+    std::atomic<int> num_runs = 0;
+    auto task = thread_pool.async([&num_runs]() { ++num_runs; });
+    task.wait();
+    BOOST_TEST(num_runs == 1);
+
+    // waiting from the only worker runs the task inline instead of deadlocking
+    utils::ThreadPool single_thread_pool(1);
+    auto outer = single_thread_pool.async([&single_thread_pool, &num_runs]() {
+        auto inner = single_thread_pool.async([&num_runs]() { ++num_runs; });
+        inner.wait();
+    });
+    outer.wait();
+    BOOST_TEST(num_runs == 2);
+
+    auto failed = thread_pool.async([]() { throw std::runtime_error("task failed"); });
+    BOOST_CHECK_THROW(failed.wait(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_window_buffer)
+{
+    utils::WindowBuffer<int> buffer;
+    buffer.reserve_window(4);
+    auto const *storage = buffer.data();
+
+    for (int i = 0; i < 100; ++i)
+    {
+        buffer.push_back(i);
+        if (buffer.size() > 4)
+        {
+            buffer.pop_front();
+        }
+        BOOST_TEST(buffer.back() == i);
+        BOOST_TEST(buffer.front() == std::max(i - 3, 0));
+        BOOST_TEST((buffer.begin() >= storage && buffer.end() <= storage + 8));
+    }
+
+    // slow path and front insertion into the free part
+    buffer.insert(buffer.begin() + 2, 42);
+    buffer.erase(buffer.begin() + 1);
+    buffer.insert(buffer.begin(), 7);
+    BOOST_TEST((std::vector<int>(buffer.begin(), buffer.end()) == std::vector<int>{7, 96, 42, 98, 99}));
+
+    auto const copy = buffer;
+    BOOST_TEST((std::vector<int>(copy.begin(), copy.end()) == std::vector<int>{7, 96, 42, 98, 99}));
+
+    auto moved = std::move(buffer);
+    BOOST_TEST(moved.size() == 5);
+    BOOST_TEST(buffer.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_vector_math)
+{
+    using utils::VectorMath;
+
+    // the ULP bounds of VectorMath, relative to the magnitude of the result (absolute below 1)
+    for (double x = -20.0; x < 20.0; x += 0.0137)
+    {
+        BOOST_TEST(close(VectorMath::sin(x), sin(x), 2));
+        BOOST_TEST(close(VectorMath::cos(x), cos(x), 2));
+        BOOST_TEST(close(VectorMath::atan2(x, 1.3), atan2(x, 1.3), 2));
+        BOOST_TEST(close(VectorMath::atan2(-0.7, x), atan2(-0.7, x), 2));
+    }
+    for (double x = -1.0; x <= 1.0; x += 0.00137)
+    {
+        BOOST_TEST(close(VectorMath::acos(x), acos(x), 1));
+    }
+    BOOST_TEST(VectorMath::acos(1.0) == 0.0);
+    BOOST_TEST(close(VectorMath::acos(-1.0), M_PI, 1));
+
+    // signed zeros, as libm
+    BOOST_TEST(std::signbit(VectorMath::sin(-0.0)));
+    BOOST_TEST(VectorMath::atan2(0.0, -0.0) == M_PI);
+    BOOST_TEST(VectorMath::atan2(-0.0, -0.0) == -M_PI);
+    BOOST_TEST(std::signbit(VectorMath::atan2(-0.0, 1.0)));
+}
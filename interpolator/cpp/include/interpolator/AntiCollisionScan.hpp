@@ -0,0 +1,82 @@
+#ifndef ANTICOLLISIONSCAN_HPP
+#define ANTICOLLISIONSCAN_HPP
+
+#include "TrajectoryIndex.hpp"
+
+namespace splines
+{
+
+/**
+ * @brief The SeparationProfile struct
+ * The centre to centre separation between the reference well and an offset well along the reference positions
+ */
+struct SeparationProfile
+{
+    // the offset point nearest to the reference at each position, in the offset coordinates. The distance is
+    // std::numeric_limits<double>::max() where the offset is beyond the scan radius
+    std::vector<ClosestPoint> offset_points;
+
+    // the index of the minimum separation in offset_points
+    std::size_t minimum_index = 0;
+};
+
+/**
+ * @brief The AntiCollisionScan class
+ * The minimum separation between a reference well and its offset wells (anti-collision scan). Every offset is indexed
+ * once (@see TrajectoryIndex), then each reference point only refines the offset pieces which may be nearer than the
+ * separation found so far: the separation at the previous reference point plus the distance between both points, and
+ * the scan radius. The geometry is the one of each interpolator (linear, cubic or minimum curvature).
+ *
+ * The scan must not outlive the interpolators, and the offsets must be added again after their trajectories change.
+ */
+class AntiCollisionScan
+{
+  public:
+    /**
+     * @brief AntiCollisionScan
+     *
+     * @param reference
+     * The well planned
+     *
+     * @param scan_radius
+     * The offset parts farther than it are not refined
+     */
+    explicit AntiCollisionScan(
+        const BaseInterpolator &reference, double scan_radius = std::numeric_limits<double>::max());
+
+    /**
+     * @brief add_offset
+     *
+     * @param offset
+     * An offset well
+     *
+     * @param origin
+     * The first vertex of the offset, in the coordinates of the reference (e.g. the difference between the wellheads)
+     */
+    void add_offset(const BaseInterpolator &offset, const Point &origin = {});
+
+    /**
+     * @brief scan
+     * The separation profiles, split over threads by offset and by ranges of reference positions
+     *
+     * @param grid
+     * The reference positions (e.g. PositionGrid::fixed_step(...).with_stations(...))
+     *
+     * @param num_threads
+     * @return
+     * A profile for each offset, in the order they were added
+     */
+    std::vector<SeparationProfile> scan(
+        const PositionGrid &grid, unsigned num_threads = std::numeric_limits<unsigned>::max()) const;
+
+  private:
+    const BaseInterpolator *_reference;
+    double _scan_radius;
+
+    std::vector<TrajectoryIndex> _offsets;
+    std::vector<Point> _origins;
+};
+
+} // namespace splines
+
+#endif // ANTICOLLISIONSCAN_HPP
@@ -2,6 +2,7 @@
 #define BASE3DINTERPOLATION_HPP
 
 #include "IInterpolator.hpp"
+#include "utils/SegmentTree.hpp"
 #include <algorithm>
 #include <functional>
 
@@ -10,14 +11,16 @@ namespace splines
 
 /**
  * @brief The BaseInterpolator class
- * The following class computes the common parts which will be used by specific interpolation types
+ * The following class computes the common parts which will be used by specific interpolation types: the trajectory,
+ * the cumulative projections and the generation over threads. The interpolation itself is done by
+ * InterpolatorEngine, which is the class the interpolation types derive from (@see InterpolatorEngine)
  */
 class BaseInterpolator : public IInterpolator
 {
-  public:
-    using IInterpolator::azimuth_at_position;
-    using IInterpolator::inclination_at_position;
+    friend class TrajectoryCursor;
+    friend class TrajectoryIndex;
 
+  public:
     virtual ~BaseInterpolator() = default;
 
     BaseInterpolator(const Vertices &trajectory);
@@ -27,20 +30,19 @@ class BaseInterpolator : public IInterpolator
     BaseInterpolator(const BaseInterpolator &other);
     BaseInterpolator &operator=(const BaseInterpolator &rhs);
 
-    const Vertices &trajectory() const final;
+    const Vertices &trajectory() const final
+    {
+        return this->_trajectory;
+    }
     void set_trajectory(const Vertices &trajectory) final;
 
     Vertex vertex_at_position(double position) const final;
 
-    double inclination_at_position(double position) const final;
-    double azimuth_at_position(double position) const final;
-
     void add_n_drop(const Vertex &vertex) final;
     void drop_n_add(const Vertex &vertex) final;
+    void slide(const Vertex &vertex) final;
 
-    double x_at_position(double position) const final;
-    double y_at_position(double position) const final;
-    double z_at_position(double position) const final;
+    TrajectoryPoint point_at_position(double position) const final;
 
     std::vector<Vertex> generate_vertices(
         std::size_t num_vertices, unsigned num_threads = std::numeric_limits<unsigned>::max()) const final;
@@ -54,154 +56,376 @@ class BaseInterpolator : public IInterpolator
     std::vector<double> generate_z_projections(
         std::size_t num_points, unsigned num_threads = std::numeric_limits<unsigned>::max()) const final;
 
-  private:
-    typedef double (BaseInterpolator::*DeltaCalculator)(double, const AdjacentVertices &) const;
+    std::vector<TrajectoryPoint> generate_points(
+        std::size_t num_points, unsigned num_threads = std::numeric_limits<unsigned>::max()) const final;
+
+    void generate_chunks(
+        std::size_t num_points, std::size_t chunk_size, const ChunkConsumer &consumer,
+        unsigned num_threads = std::numeric_limits<unsigned>::max(), bool prefetch = false) const final;
+
+    std::vector<Vertex> generate_vertices(
+        const PositionGrid &grid, unsigned num_threads = std::numeric_limits<unsigned>::max()) const final;
+
+    std::vector<TrajectoryPoint> generate_points(
+        const PositionGrid &grid, unsigned num_threads = std::numeric_limits<unsigned>::max()) const final;
+
+    void generate_chunks(
+        const PositionGrid &grid, std::size_t chunk_size, const ChunkConsumer &consumer,
+        unsigned num_threads = std::numeric_limits<unsigned>::max(), bool prefetch = false) const final;
+
+    std::vector<TrajectoryPoint> generate_adaptive_points(
+        double max_chord_deviation, double max_angle = std::numeric_limits<double>::max(),
+        unsigned num_threads = std::numeric_limits<unsigned>::max()) const final;
+
+    void evaluate(
+        std::span<const double> positions, std::span<Vertex> vertices, std::span<Point> points,
+        unsigned num_threads = std::numeric_limits<unsigned>::max()) const final;
+
+    IntervalAggregates interval_aggregates(double first_position, double last_position) const final;
+
+  protected:
+    /**
+     * @brief vertex_at_position
+     * The same of vertex_at_position, but with the upper index already known
+     */
+    virtual Vertex vertex_at_position(double position, std::size_t upper_index) const = 0;
+
+    /**
+     * @brief point_at_position
+     * The same of point_at_position, but with the upper index already known
+     */
+    virtual TrajectoryPoint point_at_position(double position, std::size_t upper_index) const = 0;
 
     /**
-     * @brief projection_at_position
-     * The main accumulator for any projection variation types (calls here DeltaCalculator), e.g.
-     * calculate_delta_x_projection
+     * @brief evaluate_sequence
+     * The sequential part of evaluate, called once per chunk (or block) of positions. The consecutive positions
+     * strictly inside the same segment are evaluated at once (@see calculate_batch_size), the others one by one
      *
-     * @param delta_calculator
-     * A Function Pointer for DeltaCalculator method
+     * @param upper_index
+     * The upper index found for the previous position, updated with the one of the last position
+     * (@see calculate_upper_index)
+     */
+    virtual void evaluate_sequence(
+        std::span<const double> positions, std::span<Vertex> vertices, std::span<Point> points,
+        std::size_t &upper_index) const = 0;
+
+    /**
+     * @brief calculate_delta_projections
+     * Computes the projection variations (x, y, z) at once, given a position and the adjacent vertices. It builds the
+     * cumulative projections table (@see update_cumulative_projections)
      *
      * @param position
      * The position represents the curve length with the first vertex as reference
      *
+     * @param adjacent_vertices
+     * The adjacent vertices
+     *
+     * @param projection_index
+     * The index of the vertex which ends the segment containing the position (@see calculate_projection_index): the
+     * first adjacent vertex is the previous vertex, or the origin if it is 0
+     *
      * @return
-     * the projection given a DeltaCalculator and position
+     * The projection variations (x, y, z)
      */
-    double projection_at_position(DeltaCalculator delta_calculator, double position) const;
+    virtual Point calculate_delta_projections(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const = 0;
 
     /**
-     * @brief calculate_adjacent_vertices
-     * This method returns the vertices between the position
+     * @brief The Bend struct
+     * Upper bounds of how the curve bends between two positions, so the queries which sample the curve can bound it
+     * between the samples (@see TrajectoryIndex)
+     */
+    struct Bend
+    {
+        // the angle (rad) the tangent of the points turns. It is infinite where it is not bounded
+        double turn = 0.0;
+
+        // the distance between the points and the chord between the ends
+        double deviation = 0.0;
+    };
+
+    /**
+     * @brief calculate_bend
+     * Bounds the bend of the curve from the interpolation itself, not from the dogleg between the vertices: the
+     * points of the linear and cubic interpolations are the direction of the interpolated vertex times the distance
+     * to the first vertex, which may turn more than it
      *
-     * @param position
-     * The position represents the curve length with the first vertex as reference
+     * @param first_position
+     * @param last_position
+     * The range, inside the segment
+     *
+     * @param segment_index
+     * The index of the segment, i.e. of its first vertex
      *
      * @return
-     * The adjacent vertices
+     * The Bend of the range
      */
-    AdjacentVertices calculate_adjacent_vertices(double position) const;
+    virtual Bend calculate_bend(double first_position, double last_position, std::size_t segment_index) const = 0;
 
-  protected:
     /**
-     * @brief calculate_delta_x_projection
-     * Computes the projection X variation given a position and the adjacent vertices
+     * @brief calculate_direction_bend
+     * The Bend of a range of the interpolations whose points are delta_s_star times the direction of the
+     * interpolated vertex (a unit vector) away from the first vertex (linear, cubic)
      *
-     * @param position
-     * The position represents the curve length with the first vertex as reference
+     * @param length
+     * The length of the range
      *
-     * @param adjacent_vertices
-     * The adjacent vertices
+     * @param delta_s_star
+     * The distance between the end of the range and the first vertex of the segment
+     *
+     * @param first_derivative
+     * @param second_derivative
+     * Bounds of the norms of the derivatives of the direction by the position inside the range
      *
      * @return
-     * The projection X variation
+     * The Bend of the range
      */
-    virtual double calculate_delta_x_projection(double position, const AdjacentVertices &adjacent_vertices) const = 0;
+    static Bend calculate_direction_bend(
+        double length, double delta_s_star, double first_derivative, double second_derivative);
 
     /**
-     * @brief calculate_delta_y_projection
-     * Computes the projection X variation given a position and the adjacent vertices
+     * @brief calculate_projection_index
+     * The index of the vertex which ends the segment used to compute the projection variation. The projections
+     * accumulated up to the previous vertex are taken from the cumulative projections table
      *
      * @param position
      * The position represents the curve length with the first vertex as reference
      *
-     * @param adjacent_vertices
-     * The adjacent vertices
+     * @param upper_index
+     * The index of the first vertex whose position is greater than position (@see calculate_upper_index)
      *
      * @return
-     * The projection Y variation
+     * the vertex index (trajectory size if the position is beyond the last vertex)
      */
-    virtual double calculate_delta_y_projection(double position, const AdjacentVertices &adjacent_vertices) const = 0;
+    std::size_t calculate_projection_index(double position, std::size_t upper_index) const
+    {
+        // the accumulation stops at the first vertex beyond the position or at a vertex (numerically) on it
+        auto const positions = this->_trajectory.positions_view();
+        auto index = upper_index;
+        while (index > 0 && fabs(position - positions[index - 1]) < std::numeric_limits<double>::epsilon())
+        {
+            --index;
+        }
+        return index;
+    }
 
     /**
-     * @brief calculate_delta_z_projection
-     * Computes the projection Z variation given a position and the adjacent vertices
+     * @brief calculate_batch_size
+     * The number of leading positions strictly inside the segment ending at the vertex upper_index: the boundary
+     * conditions of vertex_at_position and point_at_position do not apply to them
      *
-     * @param position
-     * The position represents the curve length with the first vertex as reference
+     * @param positions
+     * The positions, the first one with the given upper index
      *
-     * @param adjacent_vertices
-     * The adjacent vertices
+     * @param upper_index
+     * The upper index of the first position (@see calculate_upper_index)
      *
      * @return
-     * The projection Z variation
+     * The number of positions which can be evaluated at once
      */
-    virtual double calculate_delta_z_projection(double position, const AdjacentVertices &adjacent_vertices) const = 0;
+    std::size_t calculate_batch_size(std::span<const double> positions, std::size_t upper_index) const;
 
     /**
-     * @brief inclination_at_position
-     * The same of @see I3DInterpolation::inclination_at_position, but with adjacent vertices as argument for
-     * performance propouse
+     * @brief calculate_upper_index
+     * The index of the first vertex whose position is greater than the given position
+     * (@see Vertices::upper_bound_index). The hint, usually the index found for the previous position, is checked
+     * first and the search gallops forward from it, so sorted positions cost amortised O(1) instead of a binary
+     * search over the whole trajectory
      *
      * @param position
      * The position represents the curve length with the first vertex as reference
      *
-     * @param adjacent_vertices
-     * The adjacent vertices
+     * @param hint
+     * A guess for the upper index
      *
      * @return
-     * inclination interpolated
+     * The upper index
      */
-    virtual double inclination_at_position(double position, const AdjacentVertices &adjacent_vertices) const = 0;
+    std::size_t calculate_upper_index(double position, std::size_t hint) const;
 
     /**
-     * @brief azimuth_at_position
-     * The same of @see I3DInterpolation::azimuth_at_position, but with adjacent vertices as argument for performance
-     * propouse
+     * @brief calculate_adjacent_vertices
+     * This method returns the vertices between the position
      *
      * @param position
      * The position represents the curve length with the first vertex as reference
      *
-     * @param adjacent_vertices
+     * @return
      * The adjacent vertices
+     */
+    AdjacentVertices calculate_adjacent_vertices(double position) const;
+
+    /**
+     * @brief calculate_adjacent_vertices
+     * The same of calculate_adjacent_vertices, but with the upper index already known
+     */
+    AdjacentVertices calculate_adjacent_vertices(std::size_t upper_index) const
+    {
+        if (upper_index == 0)
+        {
+            return {this->_trajectory.front(), this->_trajectory.front()};
+        }
+        else if (upper_index == this->_trajectory.size())
+        {
+            return {this->_trajectory.back(), this->_trajectory.back()};
+        }
+        else
+        {
+            return {this->_trajectory[upper_index - 1], this->_trajectory[upper_index]};
+        }
+    }
+
+    /**
+     * @brief cumulative_projection
+     *
+     * @param index
+     * The trajectory vertex index
      *
      * @return
-     * azimuth interpolated
+     * The projections accumulated from the origin up to the vertex (the table entry plus the offset)
      */
-    virtual double azimuth_at_position(double position, const AdjacentVertices &adjacent_vertices) const = 0;
+    Point cumulative_projection(std::size_t index) const
+    {
+        auto const &projection = this->_cumulative_projections[index];
+        return {
+            projection.x + this->_projections_offset.x, projection.y + this->_projections_offset.y,
+            projection.z + this->_projections_offset.z};
+    }
 
-    enum class AngleType
+    /**
+     * @brief update_segments
+     * Rebuilds the tables with the values which depend only on a pair of adjacent trajectory vertices (segment), so
+     * they are not recomputed by every query. It is called by update_cumulative_projections; the default does nothing
+     */
+    virtual void update_segments();
+
+    enum class VertexChange
     {
-        inclination,
-        azimuth
+        insertion,
+        erasure
     };
     /**
-     * @brief angle_at_position
-     * There is some parts in common when you computes inclination and azimuth interpolation (basically boundary
-     * conditions) This method group them
+     * @brief update_segments
+     * Updates the per-segment tables after a single trajectory vertex was inserted or erased (@see add_n_drop,
+     * drop_n_add). It is called by the incremental update_cumulative_projections; the default rebuilds the tables
      *
-     * @param position
-     * The position represents the curve length with the first vertex as reference
+     * @param vertex_index
+     * The index of the vertex inserted, or the index the erased vertex had
      *
-     * @param adjacent_vertices
-     * The adjacent vertices
+     * @param vertex_change
+     * The change: insertion or erasure
+     */
+    virtual void update_segments(std::size_t vertex_index, VertexChange vertex_change);
+
+    /**
+     * @brief reserve_table
+     * Reserves a table indexed by trajectory vertex (or segment). For a trajectory window (@see
+     * Vertices::set_capacity) the table slides with it without allocation, as the trajectory arrays
      *
-     * @param angle_type
-     * The angle type: inclination or azimuth
+     * @param table
+     */
+    template <typename T> void reserve_table(utils::WindowBuffer<T> &table) const
+    {
+        auto const capacity = this->_trajectory.capacity();
+        if (capacity)
+        {
+            table.reserve_window(capacity + 1);
+        }
+        else
+        {
+            table.reserve(this->_trajectory.size());
+        }
+    }
+
+    /**
+     * @brief update_segment_table
+     * The common part of update_segments(vertex_index, vertex_change): a table entry is inserted or erased and only
+     * the segments next to the vertex are recomputed, i.e. the two segments around a vertex inserted, or the one
+     * bridging a vertex erased. The other entries are kept, since their vertices did not change
      *
-     * @return
-     * the angle interpolated
+     * @param segments
+     * The per-segment table, indexed by the first vertex of the segment
+     *
+     * @param vertex_index
+     * @param vertex_change
+     *
+     * @param calculate_segment
+     * A callable with the signature Segment(const AdjacentVertices &adjacent_vertices)
      */
-    virtual double angle_at_position(
-        double position, const AdjacentVertices &adjacent_vertices, AngleType angle_type) const = 0;
+    template <typename Segment, typename SegmentCalculator>
+    void update_segment_table(
+        utils::WindowBuffer<Segment> &segments, std::size_t vertex_index, VertexChange vertex_change,
+        const SegmentCalculator &calculate_segment) const
+    {
+        auto const num_vertices = this->_trajectory.size();
+        if (num_vertices < 2)
+        {
+            segments.clear();
+            return;
+        }
+
+        if (vertex_change == VertexChange::insertion)
+        {
+            segments.insert(segments.begin() + std::min(vertex_index, num_vertices - 2), Segment{});
+        }
+        else
+        {
+            segments.erase(segments.begin() + std::min(vertex_index, num_vertices - 1));
+        }
+
+        auto const first = vertex_index ? vertex_index - 1 : 0;
+        auto const last =
+            std::min(vertex_change == VertexChange::insertion ? vertex_index + 1 : vertex_index, num_vertices - 1);
+        for (auto i = first; i < last; ++i)
+        {
+            segments[i] = calculate_segment(AdjacentVertices{this->_trajectory[i], this->_trajectory[i + 1]});
+        }
+    }
+
+    enum class AngleType
+    {
+        inclination,
+        azimuth
+    };
 
     /**
-     * @brief generate_positions
-     * This method generates a number of positions between the whole trajectory given an argument.
-     * The step of those positions depends on the given argument
+     * @brief generate_grid
+     * The grid used by the generate methods with a number of positions: num_positions positions evenly spaced from
+     * the first trajectory vertex, with the step trajectory length / num_positions
      *
      * @param num_positions
      * The number of positions to be generated
      *
      * @return
-     * Generates positions between the trajectory
+     * The uniform grid (@see PositionGrid::uniform)
      */
-    std::vector<double> generate_positions(std::size_t num_positions) const;
+    PositionGrid generate_grid(std::size_t num_positions) const;
 
   protected:
+    /**
+     * @brief update_cumulative_projections
+     * Rebuilds the table with the accumulated projections (x, y, z) at every trajectory vertex, after the
+     * per-segment tables (@see update_segments).
+     * It must be called whenever the trajectory changes, so the projection queries only need to compute the
+     * variation inside a single segment
+     */
+    void update_cumulative_projections();
+
+    /**
+     * @brief update_cumulative_projections
+     * The same of update_cumulative_projections, but after a single trajectory vertex was inserted or erased: the
+     * per-segment tables are updated around the vertex (@see update_segments) and the accumulated projections
+     * beyond it are shifted by a constant, instead of being recomputed. Erasing the first vertex only changes the
+     * offset added to the whole table
+     *
+     * @param vertex_index
+     * The index of the vertex inserted, or the index the erased vertex had
+     *
+     * @param vertex_change
+     * The change: insertion or erasure
+     */
+    void update_cumulative_projections(std::size_t vertex_index, VertexChange vertex_change);
+
     /**
      * @brief calculate_delta_angle
      * This method computes the smallest path between two angles, considering the sign
@@ -212,8 +436,124 @@ class BaseInterpolator : public IInterpolator
      */
     double calculate_delta_angle(double angle_1, double angle_2) const;
 
+  private:
+    // the maximum number of halvings of a segment by tessellate
+    static constexpr std::size_t max_tessellation_depth = 24;
+
+    /**
+     * @brief generate_projections
+     * The common part of generate_x_projections, generate_y_projections and generate_z_projections
+     */
+    std::vector<double> generate_projections(double Point::*axis, std::size_t num_points, unsigned num_threads) const;
+
+    /**
+     * @brief generate_blocks
+     * The common part of the generate methods: the grid is evaluated over the threads in blocks of
+     * utils::BatchKernels::block_size positions, which every thread computes from their indices
+     * (@see PositionGrid::fill), so the positions are never stored
+     *
+     * @param with_vertices
+     * @param with_points
+     * The outputs requested, at least one
+     *
+     * @param handler
+     * A callable with the signature
+     * void(std::size_t offset, std::span<const Vertex> vertices, std::span<const Point> points), called by the threads
+     * for every block with the index of its first position. An output is empty if it is not requested
+     */
+    template <typename BlockHandler>
+    void generate_blocks(
+        const PositionGrid &grid, bool with_vertices, bool with_points, unsigned num_threads,
+        const BlockHandler &handler) const;
+
+    /**
+     * @brief tessellate
+     * Appends the points of the curve between first and last, last excluded (@see generate_adaptive_points). The part
+     * is a single chord if the curve at its middle and quarters deviates from the chord, and its tangent turns, less
+     * than the tolerances, or if the chord crosses a jump of the interpolation, otherwise both halves are tessellated
+     *
+     * @param middle
+     * The point at the middle of the part, which the caller has already evaluated
+     *
+     * @param upper_index
+     * The upper index of the segment (@see calculate_upper_index)
+     *
+     * @param depth
+     * The number of halvings so far, at most max_tessellation_depth
+     */
+    void tessellate(
+        const TrajectoryPoint &first, const TrajectoryPoint &middle, const TrajectoryPoint &last,
+        std::size_t upper_index, double max_chord_deviation, double max_angle, std::size_t depth,
+        std::vector<TrajectoryPoint> &points) const;
+
+    /**
+     * @brief update_interval_aggregates
+     * Rebuilds the segment tree with the aggregates of every segment (@see interval_aggregates)
+     */
+    void update_interval_aggregates();
+
+    /**
+     * @brief update_interval_aggregates
+     * The same of update_interval_aggregates, but after a single trajectory vertex was inserted or erased, as
+     * update_segment_table: only the segments next to the vertex are recomputed and the ones beyond it are moved
+     *
+     * @param vertex_index
+     * @param vertex_change
+     *
+     * @param shift
+     * The shift of the cumulative projections beyond the vertex (@see update_cumulative_projections)
+     */
+    void update_interval_aggregates(std::size_t vertex_index, VertexChange vertex_change, const Point &shift);
+
+    /**
+     * @brief calculate_interval_aggregates
+     * The aggregates of the curve between two points of the same segment. The part is split by the turn of its
+     * angles, so each projection has at most one extremum inside a piece: it is searched (golden section) only
+     * between the neighbours of a sample beyond both of them
+     *
+     * @param first
+     * @param last
+     * The points at the ends of the part
+     *
+     * @param upper_index
+     * The upper index of the segment (@see calculate_upper_index)
+     */
+    IntervalAggregates calculate_interval_aggregates(
+        const TrajectoryPoint &first, const TrajectoryPoint &last, std::size_t upper_index) const;
+
+    /**
+     * @brief calculate_segment_aggregates
+     * The aggregates of the segment which starts at the vertex index, less the projections offset as the table
+     */
+    IntervalAggregates calculate_segment_aggregates(std::size_t index) const;
+
+    /**
+     * @brief calculate_vertex_delta_projections
+     *
+     * @param index
+     * The trajectory vertex index
+     *
+     * @return
+     * The projection variations between the previous vertex (the origin for the first one) and the vertex
+     */
+    Point calculate_vertex_delta_projections(std::size_t index) const;
+
   private:
     Vertices _trajectory;
+
+    // projections accumulated from the origin up to each trajectory vertex, less _projections_offset
+    utils::WindowBuffer<Point> _cumulative_projections;
+
+    // added to every entry of _cumulative_projections, so dropping the first vertex does not rewrite the table
+    Point _projections_offset;
+
+    struct MergeIntervalAggregates
+    {
+        IntervalAggregates operator()(const IntervalAggregates &lhs, const IntervalAggregates &rhs) const;
+    };
+
+    // the aggregates of every segment, less _projections_offset as _cumulative_projections
+    utils::SegmentTree<IntervalAggregates, MergeIntervalAggregates> _segment_aggregates;
 };
 
 } // namespace splines
@@ -1,7 +1,7 @@
 #ifndef CUBICINTERPOLATOR_HPP
 #define CUBICINTERPOLATOR_HPP
 
-#include "BaseInterpolator.hpp"
+#include "InterpolatorEngine.hpp"
 
 namespace splines
 {
@@ -10,8 +10,10 @@ namespace splines
  * @brief The CubicInterpolator class
  * The following class represents the Cubic Interpolation based on IADC/SPE 112623 paper
  */
-class CubicInterpolator : public BaseInterpolator
+class CubicInterpolator : public InterpolatorEngine<CubicInterpolator>
 {
+    friend class InterpolatorEngine<CubicInterpolator>;
+
   public:
     CubicInterpolator(const Vertices &trajectory);
 
@@ -24,29 +26,65 @@ class CubicInterpolator : public BaseInterpolator
         requires std::same_as<Interpolator, CubicInterpolator>;
 
   private:
-    double inclination_at_position(double position, const AdjacentVertices &adjacent_vertices) const final;
-    double azimuth_at_position(double position, const AdjacentVertices &adjacent_vertices) const final;
-    double angle_at_position(
-        double position, const AdjacentVertices &adjacent_vertices, AngleType angle_type) const final;
-    double calculate_delta_x_projection(double position, const AdjacentVertices &adjacent_vertices) const final;
-    double calculate_delta_y_projection(double position, const AdjacentVertices &adjacent_vertices) const final;
-    double calculate_delta_z_projection(double position, const AdjacentVertices &adjacent_vertices) const final;
+    double inclination_at_position(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t upper_index) const;
+    double azimuth_at_position(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t upper_index) const;
+    double angle_at_position(double position, const AdjacentVertices &adjacent_vertices, AngleType angle_type) const;
+    double calculate_delta_x_projection(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const;
+    double calculate_delta_y_projection(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const;
+    double calculate_delta_z_projection(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const;
 
-    double calculate_ep(double position, const AdjacentVertices &adjacent_vertices) const;
-    double calculate_f1(double position, const AdjacentVertices &adjacent_vertices) const;
-    double calculate_f2(double position, const AdjacentVertices &adjacent_vertices) const;
-    double calculate_f3(double position, const AdjacentVertices &adjacent_vertices) const;
-    double calculate_f4(double position, const AdjacentVertices &adjacent_vertices) const;
+    Point calculate_delta_projections(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const final;
+    Bend calculate_bend(double first_position, double last_position, std::size_t segment_index) const final;
+    Vertex calculate_vertex(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t segment_index) const;
+    void calculate_batch(
+        std::span<const double> positions, const AdjacentVertices &adjacent_vertices, std::size_t segment_index,
+        std::span<Vertex> vertices, std::span<Point> points) const;
+    void update_segments() final;
+    void update_segments(std::size_t vertex_index, VertexChange vertex_change) final;
 
-    enum class ProjectionType
+    /**
+     * @brief The Polynomial struct
+     * The cubic Hermite interpolation of a segment written in powers of ep, so the projection variations are
+     * delta_s_star * (((c3 * ep + c2) * ep + c1) * ep + c0). Each coefficient holds the x, y and z values
+     */
+    struct Polynomial
     {
-        x,
-        y,
-        z
+        Point c0, c1, c2, c3;
     };
-    double calculate_delta_projection(
-        double position, const AdjacentVertices &adjacent_vertices, ProjectionType projection_type) const;
+
+    /**
+     * @brief calculate_polynomial
+     * Computes the Hermite coefficients (a1, a2, a3, a4) of the segment and converts them to the Polynomial
+     *
+     * @param adjacent_vertices
+     * The adjacent vertices
+     *
+     * @return
+     * The Polynomial of the segment
+     */
+    Polynomial calculate_polynomial(const AdjacentVertices &adjacent_vertices) const;
+
+    /**
+     * @brief calculate_vertex
+     * The same of calculate_vertex, but with the Polynomial of the segment already known
+     */
+    Vertex calculate_vertex(
+        double position, const AdjacentVertices &adjacent_vertices, const Polynomial &polynomial) const;
+
+    double calculate_ep(double position, const AdjacentVertices &adjacent_vertices) const;
+
+    // the Polynomial of every trajectory segment, indexed by its first vertex
+    utils::WindowBuffer<Polynomial> _polynomials;
 };
 
+extern template class InterpolatorEngine<CubicInterpolator>;
+
 } // namespace splines
 #endif // CUBICINTERPOLATOR_HPP
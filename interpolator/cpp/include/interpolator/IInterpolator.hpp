@@ -1,11 +1,55 @@
 #ifndef I3DINTERPOLATION_H
 #define I3DINTERPOLATION_H
 
+#include <functional>
+#include <limits>
+#include <span>
+
+#include "PositionGrid.hpp"
 #include "Vertices.hpp"
 
 namespace splines
 {
 
+/**
+ * @brief The TrajectoryPoint struct
+ * The Vertex (position, inclination, azimuth) and the projections (x, y, z) at the same position
+ */
+struct TrajectoryPoint
+{
+    Vertex vertex;
+    Point point;
+};
+
+/**
+ * @brief The IntervalAggregates struct
+ * The aggregates of the trajectory over a range of positions (@see IInterpolator::interval_aggregates)
+ */
+struct IntervalAggregates
+{
+    // the bounding box of the projections (x, y, z): lower.z and upper.z are the shallowest and the deepest true
+    // vertical depths
+    Point lower{
+        std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+    Point upper{
+        std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(),
+        std::numeric_limits<double>::lowest()};
+
+    // the maximum angle (rad) between the tangents at the ends of a segment, or of the part of it in the range
+    double max_dogleg = 0.0;
+
+    // the maximum dogleg per length unit (rad)
+    double max_dogleg_severity = 0.0;
+};
+
+/**
+ * @brief ChunkConsumer
+ * Receives a block of generated points: the index of its first point, the vertices and the projections (x, y, z).
+ * The spans are only valid during the call, since the buffers are reused by the next block
+ */
+typedef std::function<void(std::size_t offset, std::span<const Vertex> vertices, std::span<const Point> points)>
+    ChunkConsumer;
+
 /**
  * @brief The IInterpolator class
  * This class represents the Interpolation Interface.
@@ -88,6 +132,18 @@ class IInterpolator
      */
     virtual double z_at_position(double position) const = 0;
 
+    /**
+     * @brief point_at_position
+     * The Vertex and the projections at position, computed in a single pass (the common terms are shared)
+     *
+     * @param position
+     * The position represents the curve length with the first vertex as reference
+     *
+     * @return
+     * The Vertex and the projections (x, y, z) interpolated. @see TrajectoryPoint
+     */
+    virtual TrajectoryPoint point_at_position(double position) const = 0;
+
     /**
      * @brief generate_vertices
      *
@@ -148,6 +204,147 @@ class IInterpolator
      */
     virtual std::vector<double> generate_z_projections(std::size_t num_points, unsigned num_threads) const = 0;
 
+    /**
+     * @brief generate_points
+     *
+     * @param num_points
+     * The number of points to be generated based on the current trajectory
+     *
+     * @param num_threads
+     * The number of threads allowed to run the member function. If none is given, all available threads
+     * will be used.
+     *
+     * @return
+     * The vertices and projections sorted in a std::vector container.
+     */
+    virtual std::vector<TrajectoryPoint> generate_points(std::size_t num_points, unsigned num_threads) const = 0;
+
+    /**
+     * @brief generate_chunks
+     * The same points of generate_points, but handed to consumer in blocks of chunk_size points (the last one may be
+     * shorter), in order. The buffers are reused, so the memory is bounded by chunk_size instead of num_points
+     *
+     * @param num_points
+     * The number of points to be generated based on the current trajectory
+     *
+     * @param chunk_size
+     * The number of points of each block
+     *
+     * @param consumer
+     * Called in the calling thread for every block (@see ChunkConsumer)
+     *
+     * @param num_threads
+     * The number of threads allowed to compute each block. Nothing is generated if it is zero
+     *
+     * @param prefetch
+     * If true, the next block is computed in the thread pool while consumer handles the current one (two buffers
+     * are used)
+     */
+    virtual void generate_chunks(
+        std::size_t num_points, std::size_t chunk_size, const ChunkConsumer &consumer, unsigned num_threads,
+        bool prefetch) const = 0;
+
+    /**
+     * @brief generate_vertices
+     * The same of generate_vertices, but at the positions of grid (@see PositionGrid)
+     *
+     * @param grid
+     * The positions, which are computed by the threads: they are never stored
+     *
+     * @param num_threads
+     * The number of threads allowed to run the member function. If none is given, all available threads
+     * will be used.
+     *
+     * @return
+     * The vertices sorted in a std::vector container.
+     */
+    virtual std::vector<Vertex> generate_vertices(const PositionGrid &grid, unsigned num_threads) const = 0;
+
+    /**
+     * @brief generate_points
+     * The same of generate_points, but at the positions of grid (@see PositionGrid)
+     *
+     * @param grid
+     * The positions, which are computed by the threads: they are never stored
+     *
+     * @param num_threads
+     * The number of threads allowed to run the member function. If none is given, all available threads
+     * will be used.
+     *
+     * @return
+     * The vertices and projections sorted in a std::vector container.
+     */
+    virtual std::vector<TrajectoryPoint> generate_points(const PositionGrid &grid, unsigned num_threads) const = 0;
+
+    /**
+     * @brief generate_chunks
+     * The same of generate_chunks, but at the positions of grid (@see PositionGrid): only the positions of the
+     * current blocks are computed
+     */
+    virtual void generate_chunks(
+        const PositionGrid &grid, std::size_t chunk_size, const ChunkConsumer &consumer, unsigned num_threads,
+        bool prefetch) const = 0;
+
+    /**
+     * @brief generate_adaptive_points
+     * The points of the trajectory sampled by its bending instead of uniformly: every segment is halved until the
+     * curve deviates from each chord, and its tangent turns along it, less than the tolerances. A straight segment is
+     * only its stations, a tight build is sampled densely
+     *
+     * @param max_chord_deviation
+     * The maximum distance between the curve and the chords between neighbour points. It must be positive
+     *
+     * @param max_angle
+     * The maximum turn (rad) of the tangent between neighbour points. It must be positive
+     *
+     * @param num_threads
+     * The number of threads allowed to run the member function. If none is given, all available threads
+     * will be used.
+     *
+     * @return
+     * The vertices and projections sorted in a std::vector container, the stations included
+     */
+    virtual std::vector<TrajectoryPoint> generate_adaptive_points(
+        double max_chord_deviation, double max_angle, unsigned num_threads) const = 0;
+
+    /**
+     * @brief evaluate
+     * Evaluates the interpolation at arbitrary positions, sorted or not, in a single call.
+     * Neighbour positions in the same segment reuse its lookup, so sorted positions are cheaper.
+     *
+     * @param positions
+     * The positions to be evaluated
+     *
+     * @param vertices
+     * Output for the vertices at each position. It is skipped if empty, otherwise it must have the positions size
+     *
+     * @param points
+     * Output for the projections (x, y, z) at each position. It is skipped if empty, otherwise it must have the
+     * positions size
+     *
+     * @param num_threads
+     * The number of threads allowed to run the member function. If none is given, all available threads
+     * will be used.
+     */
+    virtual void evaluate(
+        std::span<const double> positions, std::span<Vertex> vertices, std::span<Point> points,
+        unsigned num_threads) const = 0;
+
+    /**
+     * @brief interval_aggregates
+     * The bounding box of the projections and the maximum dogleg between two positions, in O(log n): the segments
+     * inside the range are merged from a segment tree, which is updated with the trajectory, and only the parts of the
+     * segments at its ends are evaluated
+     *
+     * @param first_position
+     * @param last_position
+     * The range, clamped to the trajectory
+     *
+     * @return
+     * The aggregates of the range
+     */
+    virtual IntervalAggregates interval_aggregates(double first_position, double last_position) const = 0;
+
     /**
      * @brief add_n_drop
      * This method add a vertex into trajectory range and remove the last vertex, leaving range constant
@@ -165,6 +362,16 @@ class IInterpolator
      * @see Vertex
      */
     virtual void drop_n_add(const Vertex &vertex) = 0;
+
+    /**
+     * @brief slide
+     * This method add a vertex into trajectory and, if the trajectory is a window beyond its capacity, remove the
+     * first vertex (@see Vertices::set_capacity). Without capacity the vertex is only added
+     *
+     * @param vertex
+     * @see Vertex
+     */
+    virtual void slide(const Vertex &vertex) = 0;
 };
 
 } // namespace splines
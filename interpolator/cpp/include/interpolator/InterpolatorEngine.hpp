@@ -0,0 +1,307 @@
+#ifndef INTERPOLATORENGINE_HPP
+#define INTERPOLATORENGINE_HPP
+
+#include "BaseInterpolator.hpp"
+
+namespace splines
+{
+
+/**
+ * @brief The InterpolatorEngine class
+ * The interpolation queries of BaseInterpolator, bound at compile time to an interpolation type (CRTP): Method is the
+ * class deriving from the engine (LinearInterpolator, CubicInterpolator, ...). The per-position loops call the Method
+ * kernels directly instead of through virtual functions, so they are inlined into the loops. The virtual calls left
+ * are the entry points of IInterpolator and BaseInterpolator, at most one per query or per block of positions.
+ *
+ * Method must provide (it may be private, with the engine as friend):
+ *
+ * Point calculate_delta_projections(
+ *     double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const;
+ * Bend calculate_bend(double first_position, double last_position, std::size_t segment_index) const;
+ * double calculate_delta_x_projection(
+ *     double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const;
+ * double calculate_delta_y_projection(
+ *     double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const;
+ * double calculate_delta_z_projection(
+ *     double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const;
+ * double inclination_at_position(
+ *     double position, const AdjacentVertices &adjacent_vertices, std::size_t upper_index) const;
+ * double azimuth_at_position(
+ *     double position, const AdjacentVertices &adjacent_vertices, std::size_t upper_index) const;
+ *
+ * and it may hide calculate_vertex and calculate_batch with faster versions.
+ * The engine is header only; every Method instantiates it explicitly in its own translation unit, next to its kernels
+ */
+template <typename Method> class InterpolatorEngine : public BaseInterpolator
+{
+  public:
+    using BaseInterpolator::BaseInterpolator;
+    using BaseInterpolator::point_at_position;
+    using BaseInterpolator::vertex_at_position;
+
+    double inclination_at_position(double position) const final
+    {
+        auto const upper_index = this->trajectory().upper_bound_index(position);
+        return this->method().inclination_at_position(
+            position, this->calculate_adjacent_vertices(upper_index), upper_index);
+    }
+
+    double azimuth_at_position(double position) const final
+    {
+        auto const upper_index = this->trajectory().upper_bound_index(position);
+        return this->method().azimuth_at_position(
+            position, this->calculate_adjacent_vertices(upper_index), upper_index);
+    }
+
+    double x_at_position(double position) const final
+    {
+        return this->template projection_at_position<&Method::calculate_delta_x_projection>(
+            &Point::x, position, this->trajectory().upper_bound_index(position));
+    }
+
+    double y_at_position(double position) const final
+    {
+        return this->template projection_at_position<&Method::calculate_delta_y_projection>(
+            &Point::y, position, this->trajectory().upper_bound_index(position));
+    }
+
+    double z_at_position(double position) const final
+    {
+        return this->template projection_at_position<&Method::calculate_delta_z_projection>(
+            &Point::z, position, this->trajectory().upper_bound_index(position));
+    }
+
+  protected:
+    Vertex vertex_at_position(double position, std::size_t upper_index) const final
+    {
+        auto const positions = this->trajectory().positions_view();
+
+        if (position < positions.front() ||
+            std::fabs(position - positions.front()) < std::numeric_limits<double>::epsilon())
+        {
+            return this->trajectory().front();
+        }
+        else if (
+            position > positions.back() ||
+            std::fabs(positions.back() - position) < std::numeric_limits<double>::epsilon())
+        {
+            return this->trajectory().back();
+        }
+        else
+        {
+            return this->method().calculate_vertex(
+                position, this->calculate_adjacent_vertices(upper_index), upper_index - 1);
+        }
+    }
+
+    TrajectoryPoint point_at_position(double position, std::size_t upper_index) const final
+    {
+        auto const vertex = this->vertex_at_position(position, upper_index);
+        return {vertex, this->projections_at_position(position, vertex, upper_index)};
+    }
+
+    void evaluate_sequence(
+        std::span<const double> positions, std::span<Vertex> vertices, std::span<Point> points,
+        std::size_t &upper_index) const final
+    {
+        for (std::size_t i = 0; i < positions.size();)
+        {
+            upper_index = this->calculate_upper_index(positions[i], upper_index);
+            if (auto const batch_size = this->calculate_batch_size(positions.subspan(i), upper_index))
+            {
+                auto const segment_index = upper_index - 1;
+                auto const batch_points = points.empty() ? points : points.subspan(i, batch_size);
+                this->method().calculate_batch(
+                    positions.subspan(i, batch_size), this->calculate_adjacent_vertices(upper_index), segment_index,
+                    vertices.empty() ? vertices : vertices.subspan(i, batch_size), batch_points);
+
+                // the variations are accumulated to the projections at the first adjacent vertex
+                auto const previous_projection = this->cumulative_projection(segment_index);
+                for (auto &point : batch_points)
+                {
+                    point = {
+                        previous_projection.x + point.x, previous_projection.y + point.y,
+                        previous_projection.z + point.z};
+                }
+
+                i += batch_size;
+                continue;
+            }
+
+            if (points.empty())
+            {
+                vertices[i] = this->vertex_at_position(positions[i], upper_index);
+            }
+            else
+            {
+                auto const point = this->point_at_position(positions[i], upper_index);
+                if (!vertices.empty())
+                {
+                    vertices[i] = point.vertex;
+                }
+                points[i] = point.point;
+            }
+            ++i;
+        }
+    }
+
+    /**
+     * @brief calculate_vertex
+     * Computes the inclination and azimuth at once, given a position and the adjacent vertices.
+     * The default calls the Method inclination_at_position and azimuth_at_position; the interpolators hide it to
+     * compute the common terms only once and to use their per-segment tables (@see update_segments)
+     *
+     * @param position
+     * The position represents the curve length with the first vertex as reference
+     *
+     * @param adjacent_vertices
+     * The adjacent vertices
+     *
+     * @param segment_index
+     * The index of the segment between the adjacent vertices, i.e. the index of the first adjacent vertex
+     *
+     * @return
+     * The Vertex interpolated
+     */
+    Vertex calculate_vertex(double position, const AdjacentVertices &adjacent_vertices, std::size_t segment_index) const
+    {
+        auto inclination_interpolated =
+            this->method().inclination_at_position(position, adjacent_vertices, segment_index + 1);
+        auto azimuth_interpolated = this->method().azimuth_at_position(position, adjacent_vertices, segment_index + 1);
+
+        return {position, inclination_interpolated, azimuth_interpolated};
+    }
+
+    /**
+     * @brief calculate_batch
+     * Computes the vertices and the projection variations at many positions strictly inside the segment between the
+     * adjacent vertices (@see calculate_batch_size). The default calls the Method calculate_vertex and
+     * calculate_delta_projections for every position; the interpolators hide it with vectorised kernels
+     * (@see utils::BatchKernels)
+     *
+     * @param positions
+     * The positions, strictly inside the segment
+     *
+     * @param adjacent_vertices
+     * The adjacent vertices
+     *
+     * @param segment_index
+     * The index of the segment between the adjacent vertices, i.e. the index of the first adjacent vertex
+     *
+     * @param vertices
+     * Output for the vertices at each position. It is skipped if empty, otherwise it must have the positions size
+     *
+     * @param points
+     * Output for the projection variations between the first adjacent vertex and the vertex at each position. It is
+     * skipped if empty, otherwise it must have the positions size
+     */
+    void calculate_batch(
+        std::span<const double> positions, const AdjacentVertices &adjacent_vertices, std::size_t segment_index,
+        std::span<Vertex> vertices, std::span<Point> points) const
+    {
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            auto const vertex = this->method().calculate_vertex(positions[i], adjacent_vertices, segment_index);
+            if (!vertices.empty())
+            {
+                vertices[i] = vertex;
+            }
+            if (!points.empty())
+            {
+                points[i] = this->method().calculate_delta_projections(
+                    positions[i], AdjacentVertices{adjacent_vertices.first, vertex}, segment_index + 1);
+            }
+        }
+    }
+
+  private:
+    const Method &method() const
+    {
+        return static_cast<const Method &>(*this);
+    }
+
+    /**
+     * @brief projection_at_position
+     * The projection in a single axis: the projection at the previous vertex is taken from the cumulative projections
+     * table, so only the variation inside the segment containing the position is computed (by delta_calculator)
+     *
+     * @param axis
+     * The Point member which stores the accumulated projection for the same axis of delta_calculator
+     *
+     * @param position
+     * The position represents the curve length with the first vertex as reference
+     *
+     * @param upper_index
+     * The index of the first vertex whose position is greater than position (@see calculate_upper_index)
+     *
+     * @return
+     * the projection given a delta calculator and position
+     */
+    template <double (Method::*delta_calculator)(double, const AdjacentVertices &, std::size_t) const>
+    double projection_at_position(double Point::*axis, double position, std::size_t upper_index) const
+    {
+        if (this->trajectory().empty())
+        {
+            return 0.0;
+        }
+
+        auto const index = this->calculate_projection_index(position, upper_index);
+        if (index == this->trajectory().size())
+        {
+            return this->cumulative_projection(index - 1).*axis;
+        }
+
+        auto const previous_projection = index ? this->cumulative_projection(index - 1).*axis : 0.0;
+        auto const &adjacent_vertices = AdjacentVertices{
+            index ? this->trajectory()[index - 1] : Vertex{0.0, 0.0, 0.0},
+            this->vertex_at_position(position, upper_index)};
+
+        return previous_projection +
+               (this->method().*delta_calculator)(adjacent_vertices.second.position(), adjacent_vertices, index);
+    }
+
+    /**
+     * @brief projections_at_position
+     * The same of projection_at_position, but for the three axes at once
+     *
+     * @param position
+     * The position represents the curve length with the first vertex as reference
+     *
+     * @param vertex
+     * The vertex at position (@see vertex_at_position)
+     *
+     * @param upper_index
+     * The index of the first vertex whose position is greater than position (@see calculate_upper_index)
+     *
+     * @return
+     * The projections (x, y, z)
+     */
+    Point projections_at_position(double position, const Vertex &vertex, std::size_t upper_index) const
+    {
+        if (this->trajectory().empty())
+        {
+            return {};
+        }
+
+        auto const index = this->calculate_projection_index(position, upper_index);
+        if (index == this->trajectory().size())
+        {
+            return this->cumulative_projection(index - 1);
+        }
+
+        auto const previous_projection = index ? this->cumulative_projection(index - 1) : Point{};
+        auto const &adjacent_vertices =
+            AdjacentVertices{index ? this->trajectory()[index - 1] : Vertex{0.0, 0.0, 0.0}, vertex};
+
+        auto const delta_projections =
+            this->method().calculate_delta_projections(vertex.position(), adjacent_vertices, index);
+
+        return {
+            previous_projection.x + delta_projections.x, previous_projection.y + delta_projections.y,
+            previous_projection.z + delta_projections.z};
+    }
+};
+
+} // namespace splines
+
+#endif // INTERPOLATORENGINE_HPP
@@ -22,12 +22,24 @@ class InterpolatorFactory
      * @param trajectory
      * All trajectory vertices available to build the curve
      *
+     * @param capacity
+     * If not zero, the interpolator trajectory is a window of up to capacity vertices (@see Vertices::set_capacity),
+     * for real-time feeds updated with slide, add_n_drop or drop_n_add
+     *
      * @return
      * A smart_ptr with the interpolator object
      */
-    template <typename Interpolator> static std::unique_ptr<Interpolator> make(const Vertices &trajectory)
+    template <typename Interpolator>
+    static std::unique_ptr<Interpolator> make(const Vertices &trajectory, std::size_t capacity = 0)
     {
-        return std::make_unique<Interpolator>(Interpolator(trajectory));
+        if (!capacity)
+        {
+            return std::make_unique<Interpolator>(Interpolator(trajectory));
+        }
+
+        auto window = trajectory;
+        window.set_capacity(capacity);
+        return std::make_unique<Interpolator>(Interpolator(window));
     }
 };
 
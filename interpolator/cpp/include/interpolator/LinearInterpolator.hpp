@@ -1,7 +1,7 @@
 #ifndef LINEAR3DINTERPOLATION_HPP
 #define LINEAR3DINTERPOLATION_HPP
 
-#include "BaseInterpolator.hpp"
+#include "InterpolatorEngine.hpp"
 
 namespace splines
 {
@@ -10,8 +10,10 @@ namespace splines
  * @brief The LinearInterpolator class
  * The following class represents the linear spline interpolation
  */
-class LinearInterpolator : public BaseInterpolator
+class LinearInterpolator : public InterpolatorEngine<LinearInterpolator>
 {
+    friend class InterpolatorEngine<LinearInterpolator>;
+
   public:
     LinearInterpolator(const Vertices &trajectory);
     template <typename Interpolator>
@@ -23,13 +25,23 @@ class LinearInterpolator : public BaseInterpolator
         requires std::same_as<Interpolator, LinearInterpolator>;
 
   private:
-    double inclination_at_position(double position, const AdjacentVertices &adjacent_vertices) const final;
-    double azimuth_at_position(double position, const AdjacentVertices &adjacent_vertices) const final;
-    double calculate_delta_x_projection(double position, const AdjacentVertices &adjacent_vertices) const final;
-    double calculate_delta_y_projection(double position, const AdjacentVertices &adjacent_vertices) const final;
-    double calculate_delta_z_projection(double position, const AdjacentVertices &adjacent_vertices) const final;
-    double angle_at_position(
-        double position, const AdjacentVertices &adjacent_vertices, AngleType angle_type) const final;
+    double inclination_at_position(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t upper_index) const;
+    double azimuth_at_position(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t upper_index) const;
+    double calculate_delta_x_projection(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const;
+    double calculate_delta_y_projection(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const;
+    double calculate_delta_z_projection(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const;
+    Point calculate_delta_projections(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const final;
+    Bend calculate_bend(double first_position, double last_position, std::size_t segment_index) const final;
+    double angle_at_position(double position, const AdjacentVertices &adjacent_vertices, AngleType angle_type) const;
+    void calculate_batch(
+        std::span<const double> positions, const AdjacentVertices &adjacent_vertices, std::size_t segment_index,
+        std::span<Vertex> vertices, std::span<Point> points) const;
 
     /**
      * @brief calculate_linear_spline
@@ -52,5 +64,7 @@ class LinearInterpolator : public BaseInterpolator
         double position_1, double angle_1, double position_2, double angle_2, double position) const;
 };
 
+extern template class InterpolatorEngine<LinearInterpolator>;
+
 } // namespace splines
 #endif // LINEAR3DINTERPOLATION_HPP
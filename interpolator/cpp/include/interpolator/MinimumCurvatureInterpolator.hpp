@@ -1,7 +1,7 @@
 #ifndef MINIMUMCURVATURE3DINTERPOLATION_HPP
 #define MINIMUMCURVATURE3DINTERPOLATION_HPP
 
-#include "BaseInterpolator.hpp"
+#include "InterpolatorEngine.hpp"
 
 namespace splines
 {
@@ -10,8 +10,10 @@ namespace splines
  * @brief The MinimumCurvatureInterpolator class
  * The following class represents the Minimum Curvature Interpolation based on SPE 84246 paper
  */
-class MinimumCurvatureInterpolator : public BaseInterpolator
+class MinimumCurvatureInterpolator : public InterpolatorEngine<MinimumCurvatureInterpolator>
 {
+    friend class InterpolatorEngine<MinimumCurvatureInterpolator>;
+
   public:
     MinimumCurvatureInterpolator(const Vertices &trajectory);
 
@@ -24,13 +26,29 @@ class MinimumCurvatureInterpolator : public BaseInterpolator
         requires std::same_as<Interpolator, MinimumCurvatureInterpolator>;
 
   private:
-    double inclination_at_position(double position, const AdjacentVertices &adjacent_vertices) const final;
-    double azimuth_at_position(double position, const AdjacentVertices &adjacent_vertices) const final;
+    double inclination_at_position(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t upper_index) const;
+    double azimuth_at_position(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t upper_index) const;
     double angle_at_position(
-        double position, const AdjacentVertices &adjacent_vertices, AngleType angle_type) const final;
-    double calculate_delta_x_projection(double position, const AdjacentVertices &adjacent_vertices) const final;
-    double calculate_delta_y_projection(double position, const AdjacentVertices &adjacent_vertices) const final;
-    double calculate_delta_z_projection(double position, const AdjacentVertices &adjacent_vertices) const final;
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t upper_index,
+        AngleType angle_type) const;
+    double calculate_delta_x_projection(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const;
+    double calculate_delta_y_projection(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const;
+    double calculate_delta_z_projection(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const;
+    Point calculate_delta_projections(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const final;
+    Bend calculate_bend(double first_position, double last_position, std::size_t segment_index) const final;
+    Vertex calculate_vertex(
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t segment_index) const;
+    void calculate_batch(
+        std::span<const double> positions, const AdjacentVertices &adjacent_vertices, std::size_t segment_index,
+        std::span<Vertex> vertices, std::span<Point> points) const;
+    void update_segments() final;
+    void update_segments(std::size_t vertex_index, VertexChange vertex_change) final;
 
     /**
      * @brief calculate_alpha
@@ -45,6 +63,39 @@ class MinimumCurvatureInterpolator : public BaseInterpolator
      */
     double calculate_alpha(const AdjacentVertices &adjacent_vertices) const;
 
+    /**
+     * @brief The Segment struct
+     * The values of a pair of adjacent vertices used by every vertex interpolated inside it: the dogleg (alpha),
+     * sin(alpha) and the unit tangents (x, y, z) at both vertices.
+     * The ratio factor is not stored: the projection variations are computed between a vertex and the interpolated
+     * vertex (@see InterpolatorEngine::projections_at_position). The interpolated vertex lies on the segment arc, so
+     * its dogleg is alpha weighted by its distance to the first vertex (@see calculate_common_delta_projection)
+     */
+    struct Segment
+    {
+        double alpha;
+        double sin_alpha;
+        Point direction_1;
+        Point direction_2;
+    };
+
+    /**
+     * @brief calculate_segment
+     *
+     * @param adjacent_vertices
+     * The adjacent vertices
+     *
+     * @return
+     * The Segment values of the adjacent vertices
+     */
+    Segment calculate_segment(const AdjacentVertices &adjacent_vertices) const;
+
+    /**
+     * @brief calculate_vertex
+     * The same of calculate_vertex, but with the Segment values already known
+     */
+    Vertex calculate_vertex(double position, const AdjacentVertices &adjacent_vertices, const Segment &segment) const;
+
     /**
      * @brief calculate_common_delta_projection
      * computes common parts of delta_any_projection which are: delta_s and factor_f
@@ -53,13 +104,22 @@ class MinimumCurvatureInterpolator : public BaseInterpolator
      *
      * @param adjacent_vertices
      *
+     * @param projection_index
+     * The index of the vertex which ends the segment (@see BaseInterpolator::calculate_delta_projections): the
+     * dogleg is taken from the segments table, but for the origin
+     *
      * @return
      * std::pair<double, double>(delta_s, factor_f)
      */
     std::pair<double, double> calculate_common_delta_projection(
-        double position, const AdjacentVertices &adjacent_vertices) const;
+        double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const;
+
+    // the Segment values of every trajectory segment, indexed by its first vertex
+    utils::WindowBuffer<Segment> _segments;
 };
 
+extern template class InterpolatorEngine<MinimumCurvatureInterpolator>;
+
 } // namespace splines
 
 #endif // MINIMUMCURVATURE3DINTERPOLATION_HPP
@@ -0,0 +1,142 @@
+#ifndef POSITIONGRID_H
+#define POSITIONGRID_H
+
+#include <span>
+#include <vector>
+
+namespace splines
+{
+
+/**
+ * @brief The PositionGrid class
+ * The positions at which a trajectory is generated (@see IInterpolator::generate_points). Every position is computed
+ * in closed form from its index, so any range of them is computed on its own (e.g. by each thread) without the
+ * rounding error of accumulating the step and without storing the whole grid.
+ * The grid may also include a set of stations (e.g. the trajectory vertices), merged in position order
+ * (@see with_stations).
+ */
+class PositionGrid
+{
+  public:
+    /**
+     * @brief uniform
+     * The positions first + i * step, for i in [0, size)
+     *
+     * @param first
+     * @param step
+     * The distance between neighbour positions. It must not be negative
+     *
+     * @param size
+     * The number of positions
+     */
+    static PositionGrid uniform(double first, double step, std::size_t size);
+
+    /**
+     * @brief fixed_step
+     * The positions every step from first up to last (last is included if it is a multiple of step from first)
+     *
+     * @param first
+     * @param last
+     * It must not be less than first
+     *
+     * @param step
+     * The distance between neighbour positions (e.g. 30 m). It must be positive
+     */
+    static PositionGrid fixed_step(double first, double last, double step);
+
+    /**
+     * @brief logarithmic
+     * The positions first * (last / first)^(i / (size - 1)), for i in [0, size): the spacing grows with the position,
+     * both ends are included
+     *
+     * @param first
+     * It must be positive
+     *
+     * @param last
+     * It must be greater than first
+     *
+     * @param size
+     * The number of positions, at least two
+     */
+    static PositionGrid logarithmic(double first, double last, std::size_t size);
+
+    /**
+     * @brief with_stations
+     * The same grid, plus the stations within its range ([first, last] of the factory, or the last position of a
+     * uniform grid). The stations which coincide with a grid position (numerically) are not repeated
+     *
+     * @param stations
+     * The stations sorted by position, e.g. Vertices::positions_view
+     *
+     * @return
+     * The grid with the stations
+     */
+    PositionGrid with_stations(std::span<const double> stations) const;
+
+    /**
+     * @brief size
+     *
+     * @return
+     * The number of positions, stations included
+     */
+    std::size_t size() const;
+
+    bool empty() const;
+
+    /**
+     * @brief operator[]
+     * The position at index, in O(1) (O(log stations) with stations)
+     */
+    double operator[](std::size_t index) const;
+
+    /**
+     * @brief fill
+     * The positions at the indices [first, first + positions.size())
+     *
+     * @param first
+     * The index of the first position
+     *
+     * @param positions
+     * Output for the positions
+     */
+    void fill(std::size_t first, std::span<double> positions) const;
+
+  private:
+    enum class Spacing
+    {
+        linear,
+        logarithmic
+    };
+
+    PositionGrid(Spacing spacing, double first, double step, std::size_t grid_size, double last);
+
+    /**
+     * @brief grid_position
+     * The position at index, without the stations
+     */
+    double grid_position(std::size_t index) const;
+
+    /**
+     * @brief grid_rank
+     * The number of grid positions (without the stations) less than position
+     */
+    std::size_t grid_rank(double position) const;
+
+    Spacing _spacing;
+    double _first;
+
+    // the distance between neighbour positions, or the logarithm of their ratio
+    double _step;
+    std::size_t _grid_size;
+
+    // the end of the range, which bounds the stations
+    double _last;
+
+    // the stations not on the grid and their indices in the merged grid, both sorted
+    std::vector<double> _stations;
+    std::vector<std::size_t> _station_indices;
+};
+
+} // namespace splines
+
+#endif // POSITIONGRID_H
@@ -0,0 +1,64 @@
+#ifndef TRAJECTORYCURSOR_HPP
+#define TRAJECTORYCURSOR_HPP
+
+#include "BaseInterpolator.hpp"
+
+namespace splines
+{
+
+/**
+ * @brief The TrajectoryCursor class
+ * A stateful evaluator bound to an interpolator which remembers the segment of the last query. The next query
+ * starts the search from it, so walking the trajectory in increasing position (e.g. streaming resampling) costs
+ * amortised O(1) per point; jumps fall back to a binary search. The accumulated projections of the segment come
+ * from the interpolator table (@see BaseInterpolator::update_cumulative_projections).
+ *
+ * The cursor must not outlive the interpolator. Changing the trajectory is safe: the remembered segment is only a
+ * hint and it is validated by every query.
+ * A cursor is not thread safe, but several cursors can walk the same interpolator concurrently.
+ */
+class TrajectoryCursor
+{
+  public:
+    explicit TrajectoryCursor(const BaseInterpolator &interpolator);
+
+    /**
+     * @brief vertex_at_position
+     * The same of @see IInterpolator::vertex_at_position, moving the cursor to position
+     */
+    Vertex vertex_at_position(double position);
+
+    /**
+     * @brief point_at_position
+     * The same of @see IInterpolator::point_at_position, moving the cursor to position
+     */
+    TrajectoryPoint point_at_position(double position);
+
+    /**
+     * @brief reset
+     * Moves the cursor back to the trajectory beginning
+     */
+    void reset();
+
+    /**
+     * @brief upper_index
+     *
+     * @return
+     * The index of the first vertex whose position is greater than the last position queried
+     */
+    std::size_t upper_index() const;
+
+  private:
+    /**
+     * @brief move_to
+     * Moves the cursor to the segment containing position
+     */
+    void move_to(double position);
+
+    const BaseInterpolator *_interpolator;
+    std::size_t _upper_index = 0;
+};
+
+} // namespace splines
+
+#endif // TRAJECTORYCURSOR_HPP
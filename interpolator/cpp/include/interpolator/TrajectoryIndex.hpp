@@ -0,0 +1,277 @@
+#ifndef TRAJECTORYINDEX_HPP
+#define TRAJECTORYINDEX_HPP
+
+#include "BaseInterpolator.hpp"
+
+#include <array>
+
+namespace splines
+{
+
+/**
+ * @brief The ClosestPoint struct
+ * The trajectory point nearest to a query point and the distance between them
+ */
+struct ClosestPoint
+{
+    TrajectoryPoint point;
+    double distance = 0.0;
+};
+
+/**
+ * @brief The Plane struct
+ * The points p where normal . p = offset, e.g. the normal (0, 0, 1) and a true vertical depth as offset
+ */
+struct Plane
+{
+    Point normal;
+    double offset = 0.0;
+};
+
+/**
+ * @brief The TrajectoryIndex class
+ * A bounding volume hierarchy over the trajectory of an interpolator, which answers closest point queries (the
+ * position and the distance of the trajectory nearest to a point) in O(log n) instead of sampling the whole trajectory.
+ *
+ * Every segment is split into pieces by the turn of its tangent (@see BaseInterpolator::calculate_bend), so each piece
+ * bends little, and every piece is bounded by the chords of a few samples, each one with the maximum distance between
+ * the curve and it (@see make_piece). The vertices are pieces on their own, since the interpolations may jump there. A
+ * query visits the boxes nearer than the best distance found so far and refines the position inside each piece locally
+ * (@see refine). The inverse queries (the positions where the trajectory crosses a plane) visit the boxes which the
+ * plane cuts and solve inside each piece (@see solve_crossings).
+ *
+ * The index is a snapshot: it must not outlive the interpolator and it must be rebuilt (@see update) after the
+ * trajectory changes. The queries are thread safe.
+ */
+class TrajectoryIndex
+{
+  public:
+    explicit TrajectoryIndex(const BaseInterpolator &interpolator);
+
+    /**
+     * @brief update
+     * Rebuilds the index from the current trajectory of the interpolator
+     */
+    void update();
+
+    /**
+     * @brief closest_point
+     *
+     * @param point
+     * The query point, in the same coordinates of the projections (@see IInterpolator::point_at_position)
+     *
+     * @param max_distance
+     * The search radius: the farther parts of the trajectory are pruned
+     *
+     * @return
+     * The nearest trajectory point and its distance to point. The distance is std::numeric_limits<double>::max() if
+     * the trajectory is farther than max_distance
+     */
+    ClosestPoint closest_point(const Point &point, double max_distance = std::numeric_limits<double>::max()) const;
+
+    /**
+     * @brief closest_points
+     * The same of closest_point for many points (e.g. the cells of a reservoir grid), split over threads
+     *
+     * @param points
+     * @param num_threads
+     * @return
+     * The closest points in the same order of points
+     */
+    std::vector<ClosestPoint> closest_points(
+        std::span<const Point> points, unsigned num_threads = std::numeric_limits<unsigned>::max()) const;
+
+    /**
+     * @brief nearest_segments
+     * The k nearest segments to point, e.g. the several passes of a trajectory which turns back
+     *
+     * @param point
+     * @param k
+     * The maximum number of segments
+     *
+     * @return
+     * The closest point of every segment, sorted by distance
+     */
+    std::vector<ClosestPoint> nearest_segments(const Point &point, std::size_t k) const;
+
+    /**
+     * @brief positions_at_plane
+     * Every position where the trajectory crosses (or touches) the plane
+     *
+     * @param plane
+     * The normal must not be null
+     *
+     * @return
+     * The positions in ascending order
+     */
+    std::vector<double> positions_at_plane(const Plane &plane) const;
+
+    /**
+     * @brief positions_at_plane
+     * The same of positions_at_plane for many planes, split over threads
+     *
+     * @param planes
+     * @param num_threads
+     * @return
+     * The positions of each plane in the same order of planes
+     */
+    std::vector<std::vector<double>> positions_at_plane(
+        std::span<const Plane> planes, unsigned num_threads = std::numeric_limits<unsigned>::max()) const;
+
+    /**
+     * @brief positions_at_x
+     * The positions where the x projection is each one of values (@see positions_at_plane)
+     */
+    std::vector<std::vector<double>> positions_at_x(
+        std::span<const double> values, unsigned num_threads = std::numeric_limits<unsigned>::max()) const;
+
+    /**
+     * @brief positions_at_y
+     * The positions where the y projection is each one of values (@see positions_at_plane)
+     */
+    std::vector<std::vector<double>> positions_at_y(
+        std::span<const double> values, unsigned num_threads = std::numeric_limits<unsigned>::max()) const;
+
+    /**
+     * @brief positions_at_z
+     * The positions where the z projection (e.g. the true vertical depth of a formation top) is each one of values
+     * (@see positions_at_plane)
+     */
+    std::vector<std::vector<double>> positions_at_z(
+        std::span<const double> values, unsigned num_threads = std::numeric_limits<unsigned>::max()) const;
+
+  private:
+    // the maximum turn (rad) of the tangent inside a piece
+    static constexpr double max_piece_turn = M_PI / 16.0;
+
+    // the maximum number of halvings of a segment into pieces, for the parts whose turn is not bounded
+    static constexpr std::size_t max_piece_depth = 16;
+
+    // the sub-pieces of a piece, whose chords bound it
+    static constexpr std::size_t piece_samples = 4;
+
+    struct Box
+    {
+        Point lower{
+            std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+            std::numeric_limits<double>::max()};
+        Point upper{
+            std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(),
+            std::numeric_limits<double>::lowest()};
+
+        void merge(const Box &other);
+        Point center() const;
+
+        /**
+         * @brief squared_distance
+         * The squared distance between point and the box, zero inside it
+         */
+        double squared_distance(const Point &point) const;
+    };
+
+    /**
+     * @brief The Piece struct
+     * A range of positions inside a segment, sampled at its ends and at the ends of its sub-pieces
+     */
+    struct Piece
+    {
+        // the index of the first vertex after the segment (@see BaseInterpolator::calculate_upper_index)
+        std::size_t upper_index = 0;
+        Box box;
+
+        std::array<double, piece_samples + 1> positions{};
+        std::array<Point, piece_samples + 1> points{};
+
+        // the maximum distance between each sub-piece and its chord
+        std::array<double, piece_samples> radii{};
+    };
+
+    /**
+     * @brief The Node struct
+     * A leaf holds the pieces [first, first + size); an inner node (size 0) holds its children at the next index and
+     * at right
+     */
+    struct Node
+    {
+        Box box;
+        std::size_t first = 0;
+        std::size_t size = 0;
+        std::size_t right = 0;
+    };
+
+    /**
+     * @brief build
+     * Builds the nodes of the pieces [first, last) and returns the index of their root
+     */
+    std::size_t build(std::size_t first, std::size_t last);
+
+    /**
+     * @brief add_pieces
+     * Appends the pieces between the positions of a segment, halving it until the tangent of each piece turns at
+     * most max_piece_turn (@see BaseInterpolator::calculate_bend)
+     *
+     * @param segment_index
+     * The index of the segment, i.e. of its first vertex
+     *
+     * @param depth
+     * The number of halvings so far, at most max_piece_depth
+     */
+    void add_pieces(double first_position, double last_position, std::size_t segment_index, std::size_t depth);
+
+    /**
+     * @brief make_piece
+     * Samples the curve between the positions and bounds the distance between each sub-piece and its chord
+     * (@see BaseInterpolator::calculate_bend)
+     */
+    Piece make_piece(double first_position, double last_position, std::size_t upper_index) const;
+
+    /**
+     * @brief search
+     * Visits the pieces whose box is nearer to point than bound, nearer nodes first
+     *
+     * @param bound
+     * Returns the squared distance above which the pieces are skipped, which shrinks as visit finds nearer points
+     *
+     * @param visit
+     * Called with a piece and the current bound
+     */
+    template <typename Bound, typename Visit>
+    void search(const Point &point, const Bound &bound, const Visit &visit) const;
+
+    /**
+     * @brief visit_cut
+     * Visits the pieces whose box the plane cuts
+     *
+     * @param visit
+     * Called with a piece
+     */
+    template <typename Visit> void visit_cut(const Plane &plane, const Visit &visit) const;
+
+    /**
+     * @brief solve_crossings
+     * Appends the positions where piece crosses the plane. The signed distances of the samples to the plane bracket
+     * the crossings of each sub-piece, which are found by Newton's method (the derivative is the tangent of the
+     * vertex, or the secant slope where they disagree), kept inside the bracket by bisection. A sub-piece whose ends
+     * are on the same side but nearer to the plane than its radius may touch it, so its extremum is searched first
+     */
+    void solve_crossings(const Piece &piece, const Plane &plane, std::vector<double> &positions) const;
+
+    /**
+     * @brief refine
+     * The point of piece nearest to point: a local minimisation (Brent's method) of the squared distance, started at
+     * the nearest point of the sub-piece chords and compared with the piece ends. A piece bends little, so its
+     * squared distance has at most one local minimum inside it
+     *
+     * @param max_squared_distance
+     * The piece is skipped (the distance returned is infinite) if the chords show it is not nearer than this
+     */
+    ClosestPoint refine(const Piece &piece, const Point &point, double max_squared_distance) const;
+
+    const BaseInterpolator *_interpolator;
+    std::vector<Piece> _pieces;
+    std::vector<Node> _nodes;
+};
+
+} // namespace splines
+
+#endif // TRAJECTORYINDEX_HPP
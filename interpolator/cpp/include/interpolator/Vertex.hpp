@@ -3,7 +3,9 @@
 
 #include <cmath>
 #include <ostream>
+#include <string>
 #include <tuple>
+#include <type_traits>
 
 namespace splines
 {
@@ -36,37 +38,28 @@ typedef std::pair<Vertex, Vertex> AdjacentVertices;
  * -> position (curve length with the first trajectory vertex as reference)
  * -> inclination: angle from Z to Y axis
  * -> azimuth: angle from X to Y
+ *
+ * The Vertex is a trivially copyable value of three doubles (@see VertexFormatter for text output)
  */
 class Vertex
 {
   public:
     Vertex(
-        double position = 0.0, double inclination = 0.0, double azimuth = 0.0, AngleUnit angle_unit = AngleUnit::rad);
-
-    std::partial_ordering operator<=>(const Vertex &other) const;
-
-    /**
-     * @brief operator <<
-     * @param os
-     * @param vt
-     * @return
-     * std::ostream with the Vertex value separeted by a specific delimiter (default: ',')
-     * position, inclination, azimuth [-, rad, rad]
-     */
-    friend std::ostream &operator<<(std::ostream &os, const Vertex &vt)
+        double position = 0.0, double inclination = 0.0, double azimuth = 0.0, AngleUnit angle_unit = AngleUnit::rad)
+        : _position(position)
+        , _inclination(angle_unit == AngleUnit::rad ? inclination : this->angle_in(inclination, angle_unit))
+        , _azimuth(angle_unit == AngleUnit::rad ? azimuth : this->angle_in(azimuth, angle_unit))
     {
-        os << vt._position << vt._delimiter << vt._inclination << vt._delimiter << vt._azimuth;
-        return os;
     }
 
+    std::partial_ordering operator<=>(const Vertex &other) const;
+
     bool approx_equal(const Vertex &vt, double tol_radius = 1E-6) const;
 
     double position() const;
     double inclination(AngleUnit angle_unit = AngleUnit::rad) const;
     double azimuth(AngleUnit angle_unit = AngleUnit::rad) const;
 
-    std::string delimiter() const;
-
   private:
     void calculate_tangent(const Vertex &vt, Point &point) const;
 
@@ -114,10 +107,41 @@ class Vertex
     double _position;
     double _inclination; // angle from z axis
     double _azimuth;     // angle from x axis
+};
+
+static_assert(
+    std::is_trivially_copyable_v<Vertex> && std::is_standard_layout_v<Vertex> && sizeof(Vertex) == 3 * sizeof(double),
+    "Vertex must be a trivially copyable value of three doubles");
 
-    std::string _delimiter = ","; // ostream delimiter
+/**
+ * @brief The VertexFormatter class
+ * Writes the Vertex values separated by a delimiter: position, inclination, azimuth [-, rad, rad]
+ */
+class VertexFormatter
+{
+  public:
+    VertexFormatter(std::string delimiter = ",");
+
+    const std::string &delimiter() const;
+
+    std::ostream &write(std::ostream &os, const Vertex &vt) const;
+
+    std::string to_string(const Vertex &vt) const;
+
+  private:
+    std::string _delimiter;
 };
 
+/**
+ * @brief operator <<
+ * @param os
+ * @param vt
+ * @return
+ * std::ostream with the Vertex value separeted by the default VertexFormatter delimiter (',')
+ * position, inclination, azimuth [-, rad, rad]
+ */
+std::ostream &operator<<(std::ostream &os, const Vertex &vt);
+
 } // namespace splines
 
 /**
@@ -2,27 +2,188 @@
 #define VERTICES_H
 
 #include <algorithm>
+#include <iterator>
+#include <optional>
 #include <set>
+#include <span>
 #include <vector>
 
 #include "Vertex.hpp"
+#include "utils/WindowBuffer.hpp"
 
 namespace splines
 {
 
 /**
  * @brief The Vertices class
- * The Vertices class is a vertices wrapper
+ * The Vertices class is a vertices wrapper.
+ * The vertices are kept sorted by position in three contiguous arrays (structure of arrays): positions,
+ * inclinations [rad] and azimuths [rad]. A Vertex is built on demand when the container is iterated.
+ * With a capacity (@see set_capacity) the container is a fixed-size window for real-time feeds: the arrays are
+ * contiguous ring buffers (@see utils::WindowBuffer), so dropping the first vertex and adding one after the last are
+ * amortised O(1) and allocation-free.
  */
 class Vertices
 {
   public:
+    /**
+     * @brief The const_iterator class
+     * Random access iterator over the sorted vertices. The Vertex is assembled from the arrays when dereferenced,
+     * so it is returned by value
+     */
+    class const_iterator
+    {
+      public:
+        /**
+         * @brief The ArrowProxy struct
+         * Holds the assembled Vertex, so operator-> can be used as in a regular container
+         */
+        struct ArrowProxy
+        {
+            Vertex vertex;
+
+            const Vertex *operator->() const
+            {
+                return &vertex;
+            }
+        };
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Vertex;
+        using difference_type = std::ptrdiff_t;
+        using reference = Vertex;
+        using pointer = ArrowProxy;
+
+        const_iterator() = default;
+        const_iterator(const Vertices *vertices, std::size_t index)
+            : _vertices(vertices)
+            , _index(index)
+        {
+        }
+
+        Vertex operator*() const
+        {
+            return (*this->_vertices)[this->_index];
+        }
+
+        ArrowProxy operator->() const
+        {
+            return {**this};
+        }
+
+        Vertex operator[](difference_type n) const
+        {
+            return *(*this + n);
+        }
+
+        const_iterator &operator++()
+        {
+            ++this->_index;
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            auto tmp = *this;
+            ++this->_index;
+            return tmp;
+        }
+
+        const_iterator &operator--()
+        {
+            --this->_index;
+            return *this;
+        }
+
+        const_iterator operator--(int)
+        {
+            auto tmp = *this;
+            --this->_index;
+            return tmp;
+        }
+
+        const_iterator &operator+=(difference_type n)
+        {
+            this->_index += n;
+            return *this;
+        }
+
+        const_iterator &operator-=(difference_type n)
+        {
+            this->_index -= n;
+            return *this;
+        }
+
+        friend const_iterator operator+(const_iterator it, difference_type n)
+        {
+            return it += n;
+        }
+
+        friend const_iterator operator+(difference_type n, const_iterator it)
+        {
+            return it += n;
+        }
+
+        friend const_iterator operator-(const_iterator it, difference_type n)
+        {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const const_iterator &lhs, const const_iterator &rhs)
+        {
+            return static_cast<difference_type>(lhs._index) - static_cast<difference_type>(rhs._index);
+        }
+
+        bool operator==(const const_iterator &other) const
+        {
+            return this->_index == other._index;
+        }
+
+        auto operator<=>(const const_iterator &other) const
+        {
+            return this->_index <=> other._index;
+        }
+
+      private:
+        const Vertices *_vertices = nullptr;
+        std::size_t _index = 0;
+    };
+
+    using iterator = const_iterator;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
     Vertices() = default;
     Vertices(const std::initializer_list<Vertex> &vertices, AngleUnit angle_unit = AngleUnit::rad);
     Vertices(const std::set<Vertex> &vertices, AngleUnit angle_unit = AngleUnit::rad);
     Vertices(const std::vector<Vertex> &vertices, AngleUnit angle_unit = AngleUnit::rad);
 
-    const std::set<Vertex> &vertices() const;
+    /**
+     * @brief Vertices
+     * Builds the trajectory straight from the columns (e.g. NumPy arrays), without creating a Vertex per station.
+     * Sorted positions are stored in a single pass; otherwise the vertices are sorted and the repeated positions
+     * dropped (the first one wins), as set_vertices does
+     *
+     * @param positions
+     * @param inclinations
+     * @param azimuths
+     * @param angle_unit
+     * The unit of inclinations and azimuths
+     *
+     * @throw std::invalid_argument if the columns have different sizes
+     */
+    Vertices(
+        std::span<const double> positions, std::span<const double> inclinations, std::span<const double> azimuths,
+        AngleUnit angle_unit = AngleUnit::rad);
+
+    /**
+     * @brief vertices
+     * The vertices are stored contiguously, so the container itself is the sorted range of Vertex.
+     * It is kept to iterate the vertices as before: vertices().begin(), vertices().rbegin(), ...
+     *
+     * @return
+     * this sorted range of Vertex
+     */
+    const Vertices &vertices() const;
 
     // this method was created to keep vertices sorted in python side
     std::vector<Vertex> vertices_python() const;
@@ -33,7 +194,72 @@ class Vertices
     void add_n_drop(const Vertex &vertex);
     void drop_n_add(const Vertex &vertex);
 
+    /**
+     * @brief slide
+     * Adds the vertex and, if the window is then beyond its capacity, drops the first vertex. A vertex after the last
+     * one is the fast path; a vertex out of order is inserted keeping the arrays sorted
+     *
+     * @param vertex
+     * @see Vertex
+     */
+    void slide(const Vertex &vertex);
+
+    /**
+     * @brief set_capacity
+     * Turns the container into a window of up to capacity vertices: the storage for it is reserved once and only the
+     * last capacity vertices are kept. The capacity is kept by copies and by set_vertices
+     *
+     * @param capacity
+     * The maximum number of vertices, or 0 for no limit (the default)
+     */
+    void set_capacity(std::size_t capacity);
+
+    /**
+     * @brief capacity
+     *
+     * @return
+     * The maximum number of vertices (@see set_capacity), 0 if there is no limit
+     */
+    std::size_t capacity() const;
+
+    /**
+     * @brief insert
+     * Inserts the vertex keeping the arrays sorted. A vertex with the same position of a stored one is ignored
+     *
+     * @param vertex
+     * @see Vertex
+     *
+     * @return
+     * The index of the vertex inserted, or nothing if it was ignored
+     */
+    std::optional<std::size_t> insert(const Vertex &vertex);
+
+    /**
+     * @brief erase
+     * Removes the vertex at the given index from all arrays
+     *
+     * @param index
+     */
+    void erase(std::size_t index);
+
     size_t size() const;
+    bool empty() const;
+
+    Vertex operator[](std::size_t index) const;
+    Vertex front() const;
+    Vertex back() const;
+
+    /**
+     * @brief upper_bound_index
+     * Branch-light binary search over the positions array
+     *
+     * @param position
+     * The position represents the curve length with the first vertex as reference
+     *
+     * @return
+     * The index of the first vertex whose position is greater than the given position (size() if none)
+     */
+    std::size_t upper_bound_index(double position) const;
 
     // Composite Pattern (@see Vertex)
     std::vector<double> positions() const;
@@ -42,14 +268,32 @@ class Vertices
     bool approx_equal(const Vertices &other, double tol_radius = 1E-6) const;
     std::string delimiter() const;
 
+    // Views over the stored arrays (no copy). The angles are in radian
+    std::span<const double> positions_view() const;
+    std::span<const double> inclinations_view() const;
+    std::span<const double> azimuths_view() const;
+
     // iterators
-    std::set<Vertex>::iterator begin();
-    std::set<Vertex>::iterator end();
-    std::set<Vertex>::const_iterator cbegin() const;
-    std::set<Vertex>::const_iterator cend() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+    const_reverse_iterator rbegin() const;
+    const_reverse_iterator rend() const;
+
+  private:
+    /**
+     * @brief fit_capacity
+     * Drops the first vertices beyond the capacity
+     */
+    void fit_capacity();
 
   private:
-    std::set<Vertex> _vertices;
+    utils::WindowBuffer<double> _positions;
+    utils::WindowBuffer<double> _inclinations; // [rad]
+    utils::WindowBuffer<double> _azimuths;     // [rad]
+
+    std::size_t _capacity = 0;
 };
 
 } // namespace splines
@@ -0,0 +1,145 @@
+#ifndef BATCHKERNELS_H
+#define BATCHKERNELS_H
+
+#include <algorithm>
+#include <span>
+
+#include "../Vertex.hpp"
+
+namespace splines::utils
+{
+
+/**
+ * @brief The BatchOutput struct
+ * The outputs of a batch kernel as separate arrays (structure of arrays), one element per position.
+ * x, y and z are the projection variations from the first vertex of the segment; they are skipped if null
+ */
+struct BatchOutput
+{
+    double *inclinations = nullptr;
+    double *azimuths = nullptr;
+    double *x = nullptr;
+    double *y = nullptr;
+    double *z = nullptr;
+};
+
+/**
+ * @brief The BatchKernels struct
+ *
+ * Vectorised versions of calculate_vertex and calculate_delta_projections for many positions strictly inside a single
+ * trajectory segment, so the boundary conditions of the scalar path do not apply and the per-segment values are
+ * loaded once. The kernels use VectorMath instead of libm and are compiled for SSE2, AVX2 and AVX-512, the version for
+ * the running CPU being picked at load time (@see SPLINES_TARGET_CLONES).
+ * Floating point contraction is disabled in the kernels, so the results do not depend on the instruction set nor on
+ * how the positions are split in batches. They differ from the scalar path only by the VectorMath error: see the
+ * tolerance in the batch tests
+ *
+ */
+struct BatchKernels
+{
+    // the positions of a batch are processed in blocks of this size, so the arrays fit in the stack (and in L1)
+    static constexpr std::size_t block_size = 256;
+
+    /**
+     * @brief The Cubic struct
+     * The segment values used by the cubic kernel: the x and z coefficients of the segment Polynomial
+     * (@see CubicInterpolator::Polynomial)
+     */
+    struct Cubic
+    {
+        double position;
+        double delta_s;
+        double x[4];
+        double z[4];
+    };
+
+    /**
+     * @brief The MinimumCurvature struct
+     * The segment values used by the minimum curvature kernel (@see MinimumCurvatureInterpolator::Segment). The
+     * segment must be curved (alpha of at least epsilon). If the azimuth is not interpolated, it is azimuth
+     */
+    struct MinimumCurvature
+    {
+        double position;
+        double delta_s;
+        double alpha;
+        Point direction_1;
+        Point direction_2;
+        bool azimuth_interpolated;
+        double azimuth;
+        double sin_azimuth;
+        double cos_azimuth;
+    };
+
+    /**
+     * @brief The Linear struct
+     * The segment values used by the linear kernel: the angles are already unwrapped (the smallest path between
+     * them) and in [0, 4 pi). If the azimuth is not interpolated, it is azimuth_2
+     */
+    struct Linear
+    {
+        double position_1;
+        double position_2;
+        double inclination_1;
+        double inclination_2;
+        bool azimuth_interpolated;
+        double azimuth_1;
+        double azimuth_2;
+    };
+
+    static void cubic(const Cubic &segment, std::span<const double> positions, const BatchOutput &output);
+
+    static void minimum_curvature(
+        const MinimumCurvature &segment, std::span<const double> positions, const BatchOutput &output);
+
+    static void linear(const Linear &segment, std::span<const double> positions, const BatchOutput &output);
+
+    /**
+     * @brief run
+     * Calls kernel in blocks of block_size positions and converts its arrays to vertices and projection variations
+     *
+     * @param positions
+     *
+     * @param vertices
+     * Output for the vertices. It is skipped if empty
+     *
+     * @param points
+     * Output for the projection variations. It is skipped if empty
+     *
+     * @param kernel
+     * A callable with the signature void(std::span<const double> positions, const BatchOutput &output)
+     */
+    template <typename Kernel>
+    static void run(
+        std::span<const double> positions, std::span<Vertex> vertices, std::span<Point> points, const Kernel &kernel)
+    {
+        double inclinations[block_size], azimuths[block_size], x[block_size], y[block_size], z[block_size];
+        auto const output = points.empty() ? BatchOutput{inclinations, azimuths}
+                                           : BatchOutput{inclinations, azimuths, x, y, z};
+
+        for (std::size_t first = 0; first < positions.size(); first += block_size)
+        {
+            auto const block = positions.subspan(first, std::min(block_size, positions.size() - first));
+            kernel(block, output);
+
+            if (!vertices.empty())
+            {
+                for (std::size_t i = 0; i < block.size(); ++i)
+                {
+                    vertices[first + i] = Vertex(block[i], inclinations[i], azimuths[i]);
+                }
+            }
+            if (!points.empty())
+            {
+                for (std::size_t i = 0; i < block.size(); ++i)
+                {
+                    points[first + i] = Point{x[i], y[i], z[i]};
+                }
+            }
+        }
+    }
+};
+
+} // namespace splines::utils
+
+#endif // BATCHKERNELS_H
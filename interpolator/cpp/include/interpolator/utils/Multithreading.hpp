@@ -1,9 +1,12 @@
 #ifndef MULTITHREADING_H
 #define MULTITHREADING_H
 
-#include <future>
+#include <algorithm>
+#include <iterator>
 #include <vector>
 
+#include "ThreadPool.hpp"
+
 namespace splines::utils
 {
 
@@ -16,58 +19,138 @@ namespace splines::utils
  */
 struct Multithreading
 {
+    // each thread takes several chunks, so threads with cheaper chunks do not stay idle
+    static constexpr std::size_t chunks_per_thread = 8;
+
+    // below this size a chunk costs less than its scheduling
+    static constexpr std::size_t min_chunk_size = 64;
+
     template <typename Output, typename InputIt, typename Task>
     static std::vector<Output> run(InputIt first, InputIt last, unsigned num_threads_user, Task task)
     {
-        std::vector<Output> output;
-        std::size_t range_length = std::distance(first, last);
-        if (!range_length || !num_threads_user)
+        return run<Output>(ThreadPool::instance(), first, last, num_threads_user, task);
+    }
+
+    /**
+     * @brief run
+     * Applies task to every element of [first, last). The output is allocated once and each chunk writes its own
+     * slice of it (@see run_into)
+     *
+     * @return
+     * The task results in the same order of the input
+     */
+    template <typename Output, typename InputIt, typename Task>
+    static std::vector<Output> run(
+        ThreadPool &thread_pool, InputIt first, InputIt last, unsigned num_threads_user, Task task)
+    {
+        if (!num_threads_user)
         {
-            return output;
+            return {};
         }
 
-        unsigned hardware_threads = std::thread::hardware_concurrency();
-        unsigned num_threads = std::min(hardware_threads ? hardware_threads : 1, num_threads_user);
-        std::size_t block_size = range_length / num_threads;
+        std::vector<Output> output(std::distance(first, last));
+        run_into(thread_pool, first, last, output.begin(), num_threads_user, task);
+        return output;
+    }
+
+    template <typename InputIt, typename OutputIt, typename Task>
+    static void run_into(InputIt first, InputIt last, OutputIt output_first, unsigned num_threads_user, Task task)
+    {
+        run_into(ThreadPool::instance(), first, last, output_first, num_threads_user, task);
+    }
 
-        std::vector<std::future<std::vector<Output>>> results(num_threads);
+    /**
+     * @brief run_into
+     * Writes task(*(first + i)) into *(output_first + i) for every element of [first, last).
+     * The output range must be random access and hold at least std::distance(first, last) elements, e.g. a
+     * caller-provided std::span. No intermediate buffer is used: each chunk writes its disjoint slice in place
+     */
+    template <typename InputIt, typename OutputIt, typename Task>
+    static void run_into(
+        ThreadPool &thread_pool, InputIt first, InputIt last, OutputIt output_first, unsigned num_threads_user,
+        Task task)
+    {
+        run_chunks(
+            thread_pool, std::distance(first, last), num_threads_user,
+            [&first, &output_first, &task](std::size_t chunk_first, std::size_t chunk_last) {
+                auto input = std::next(first, chunk_first);
+                auto output = std::next(output_first, chunk_first);
+                for (auto i = chunk_first; i < chunk_last; ++i, ++input, ++output)
+                {
+                    *output = task(*input);
+                }
+            });
+    }
 
-        InputIt block_first = first;
-        for (unsigned i = 0; i < num_threads - 1; ++i)
+    template <typename ChunkTask>
+    static void run_chunks(std::size_t range_length, unsigned num_threads_user, ChunkTask chunk_task)
+    {
+        run_chunks(ThreadPool::instance(), range_length, num_threads_user, chunk_task);
+    }
+
+    /**
+     * @brief run_chunks
+     * Splits the index range [0, range_length) in contiguous chunks and runs chunk_task(chunk_first, chunk_last) for
+     * each of them in the thread pool
+     *
+     * @param thread_pool
+     * @param range_length
+     * @param num_threads_user
+     * The number of threads allowed to run the chunks. Nothing is run if it is zero
+     *
+     * @param chunk_task
+     * A callable with the signature void(std::size_t chunk_first, std::size_t chunk_last)
+     */
+    template <typename ChunkTask>
+    static void run_chunks(
+        ThreadPool &thread_pool, std::size_t range_length, unsigned num_threads_user, ChunkTask chunk_task)
+    {
+        if (!range_length || !num_threads_user)
         {
-            InputIt block_last = block_first;
-            std::advance(block_last, block_size);
-            results[i] = std::async(&Multithreading::run_block<Output, InputIt, Task>, block_first, block_last, task);
-            block_first = block_last;
+            return;
         }
 
-        output.reserve(range_length);
+        unsigned num_threads = calculate_num_threads(num_threads_user);
+        std::size_t num_chunks = calculate_num_chunks(range_length, num_threads);
+        std::size_t chunk_size = range_length / num_chunks;
 
-        // running leftover
-        *results.rbegin() = std::async(&Multithreading::run_block<Output, InputIt, Task>, block_first, last, task);
+        thread_pool.parallel_for(num_chunks, num_threads, [&](std::size_t chunk) {
+            // the last chunk runs the leftover
+            chunk_task(chunk * chunk_size, chunk + 1 == num_chunks ? range_length : (chunk + 1) * chunk_size);
+        });
+    }
 
-        for (auto &fut : results)
+    /**
+     * @brief num_chunks
+     * The number of chunks run_chunks splits the range in. All the chunks but the last have range_length / num_chunks
+     * indices, so chunk_first / (range_length / num_chunks) is the index of a chunk, e.g. to store a result per chunk
+     *
+     * @return
+     * Zero if run_chunks runs nothing
+     */
+    static std::size_t num_chunks(std::size_t range_length, unsigned num_threads_user)
+    {
+        if (!range_length || !num_threads_user)
         {
-            for (auto res : fut.get())
-            {
-                output.insert(output.begin() + output.size(), std::move(res));
-            }
+            return 0;
         }
-
-        return output;
+        return calculate_num_chunks(range_length, calculate_num_threads(num_threads_user));
     }
 
   private:
-    template <typename Output, typename InputIt, typename Task>
-    static std::vector<Output> run_block(InputIt first, InputIt last, Task task)
+    static unsigned calculate_num_threads(unsigned num_threads_user)
+    {
+        unsigned hardware_threads = std::thread::hardware_concurrency();
+        return std::min(hardware_threads ? hardware_threads : 1, num_threads_user);
+    }
+
+    static std::size_t calculate_num_chunks(std::size_t range_length, unsigned num_threads)
     {
-        std::vector<Output> thread_result;
-        thread_result.reserve(std::distance(first, last));
-        for (; first != last; ++first)
+        if (num_threads < 2)
         {
-            thread_result.push_back(task(*first));
+            return 1;
         }
-        return thread_result;
+        return std::clamp<std::size_t>(range_length / min_chunk_size, 1, num_threads * chunks_per_thread);
     }
 };
 
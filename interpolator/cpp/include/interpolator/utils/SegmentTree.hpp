@@ -0,0 +1,328 @@
+#ifndef SEGMENTTREE_H
+#define SEGMENTTREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace splines::utils
+{
+
+/**
+ * @brief The SegmentTree class
+ *
+ * A segment tree over a ring of leaves: the merge of any range of consecutive elements costs O(log n). The leaves are
+ * kept in a ring, as the sliding windows of WindowBuffer, so appending to the back and dropping from either end only
+ * update the path from a leaf to the root, in O(log n). Inserting or erasing an element elsewhere moves the following
+ * leaves and rebuilds the inner nodes (O(n)), as for std::vector.
+ * Merge is a callable with the signature T(const T &lhs, const T &rhs). It must be associative and commutative, since a
+ * range which wraps around the ring is merged out of order, and T{} must be its identity.
+ *
+ */
+template <typename T, typename Merge> class SegmentTree
+{
+  public:
+    SegmentTree() = default;
+    SegmentTree(const SegmentTree &other) = default;
+    SegmentTree &operator=(const SegmentTree &rhs) = default;
+
+    SegmentTree(SegmentTree &&other) noexcept
+        : _nodes(std::move(other._nodes))
+        , _capacity(std::exchange(other._capacity, 0))
+        , _head(std::exchange(other._head, 0))
+        , _size(std::exchange(other._size, 0))
+    {
+        other._nodes.clear();
+    }
+
+    SegmentTree &operator=(SegmentTree &&rhs) noexcept
+    {
+        this->_nodes = std::move(rhs._nodes);
+        this->_capacity = std::exchange(rhs._capacity, 0);
+        this->_head = std::exchange(rhs._head, 0);
+        this->_size = std::exchange(rhs._size, 0);
+        rhs._nodes.clear();
+        return *this;
+    }
+
+    std::size_t size() const
+    {
+        return this->_size;
+    }
+
+    bool empty() const
+    {
+        return this->_size == 0;
+    }
+
+    const T &operator[](std::size_t index) const
+    {
+        return this->_nodes[this->_capacity + this->slot(index)];
+    }
+
+    void clear()
+    {
+        std::fill(this->_nodes.begin(), this->_nodes.end(), T{});
+        this->_head = 0;
+        this->_size = 0;
+    }
+
+    /**
+     * @brief reserve
+     * Reserves room for capacity elements, e.g. a trajectory window, so they are added without allocation
+     *
+     * @param capacity
+     */
+    void reserve(std::size_t capacity)
+    {
+        if (capacity > this->_capacity)
+        {
+            this->relayout(capacity);
+        }
+    }
+
+    /**
+     * @brief generate
+     * Replaces the elements by generator(index), index in [0, size), and builds the inner nodes once (O(n))
+     *
+     * @param generator
+     * A callable with the signature T(std::size_t index)
+     */
+    template <typename Generator> void generate(std::size_t size, const Generator &generator)
+    {
+        this->clear();
+        this->reserve(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            this->_nodes[this->_capacity + i] = generator(i);
+        }
+        this->_size = size;
+        this->rebuild();
+    }
+
+    void set(std::size_t index, const T &value)
+    {
+        this->update(this->slot(index), value);
+    }
+
+    void push_back(const T &value)
+    {
+        this->make_room();
+        ++this->_size;
+        this->set(this->_size - 1, value);
+    }
+
+    void pop_back()
+    {
+        this->set(this->_size - 1, T{});
+        --this->_size;
+    }
+
+    void push_front(const T &value)
+    {
+        this->make_room();
+        this->_head = (this->_head + this->_capacity - 1) % this->_capacity;
+        ++this->_size;
+        this->set(0, value);
+    }
+
+    void pop_front()
+    {
+        this->set(0, T{});
+        this->_head = (this->_head + 1) % this->_capacity;
+        --this->_size;
+    }
+
+    /**
+     * @brief insert
+     * Inserts value before the element index. At the ends it costs O(log n), elsewhere O(n)
+     */
+    void insert(std::size_t index, const T &value)
+    {
+        if (index == this->_size)
+        {
+            this->push_back(value);
+            return;
+        }
+        else if (index == 0)
+        {
+            this->push_front(value);
+            return;
+        }
+
+        this->make_room();
+        ++this->_size;
+        for (auto i = this->_size - 1; i > index; --i)
+        {
+            this->leaf(i) = this->leaf(i - 1);
+        }
+        this->leaf(index) = value;
+        this->rebuild();
+    }
+
+    /**
+     * @brief erase
+     * Erases the element index. At the ends it costs O(log n), elsewhere O(n)
+     */
+    void erase(std::size_t index)
+    {
+        if (index + 1 == this->_size)
+        {
+            this->pop_back();
+            return;
+        }
+        else if (index == 0)
+        {
+            this->pop_front();
+            return;
+        }
+
+        for (auto i = index; i + 1 < this->_size; ++i)
+        {
+            this->leaf(i) = this->leaf(i + 1);
+        }
+        this->leaf(this->_size - 1) = T{};
+        --this->_size;
+        this->rebuild();
+    }
+
+    /**
+     * @brief transform
+     * Replaces the elements [first, last) by function(element), then rebuilds the inner nodes (O(n))
+     *
+     * @param function
+     * A callable with the signature T(const T &element)
+     */
+    template <typename Function> void transform(std::size_t first, std::size_t last, const Function &function)
+    {
+        if (first >= last)
+        {
+            return;
+        }
+
+        for (auto i = first; i < last; ++i)
+        {
+            this->leaf(i) = function(this->leaf(i));
+        }
+        this->rebuild();
+    }
+
+    /**
+     * @brief accumulate
+     * The merge of the elements [first, last), T{} if the range is empty
+     */
+    T accumulate(std::size_t first, std::size_t last) const
+    {
+        if (first >= last)
+        {
+            return T{};
+        }
+
+        // a range which wraps around the ring is merged as two ranges of slots
+        auto const first_slot = this->slot(first);
+        auto const last_slot = this->slot(last - 1) + 1;
+        if (first_slot < last_slot)
+        {
+            return this->accumulate_slots(first_slot, last_slot);
+        }
+        return this->_merge(
+            this->accumulate_slots(first_slot, this->_capacity), this->accumulate_slots(0, last_slot));
+    }
+
+  private:
+    std::size_t slot(std::size_t index) const
+    {
+        return (this->_head + index) % this->_capacity;
+    }
+
+    T &leaf(std::size_t index)
+    {
+        return this->_nodes[this->_capacity + this->slot(index)];
+    }
+
+    /**
+     * @brief update
+     * Sets a leaf and merges the nodes on the path from it to the root again
+     */
+    void update(std::size_t slot, const T &value)
+    {
+        auto node = this->_capacity + slot;
+        this->_nodes[node] = value;
+        for (node /= 2; node > 0; node /= 2)
+        {
+            this->_nodes[node] = this->_merge(this->_nodes[2 * node], this->_nodes[2 * node + 1]);
+        }
+    }
+
+    void rebuild()
+    {
+        for (auto node = this->_capacity; node-- > 1;)
+        {
+            this->_nodes[node] = this->_merge(this->_nodes[2 * node], this->_nodes[2 * node + 1]);
+        }
+    }
+
+    T accumulate_slots(std::size_t first, std::size_t last) const
+    {
+        // bottom-up: the nodes fully inside the range are merged level by level
+        auto result = T{};
+        for (first += this->_capacity, last += this->_capacity; first < last; first /= 2, last /= 2)
+        {
+            if (first & 1)
+            {
+                result = this->_merge(result, this->_nodes[first++]);
+            }
+            if (last & 1)
+            {
+                result = this->_merge(result, this->_nodes[--last]);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief make_room
+     * Called before an element is added: a full ring is moved into one twice as large
+     */
+    void make_room()
+    {
+        if (this->_size == this->_capacity)
+        {
+            this->relayout(std::max<std::size_t>(2 * this->_capacity, 1));
+        }
+    }
+
+    /**
+     * @brief relayout
+     * Moves the elements to the start of a ring with the given capacity
+     */
+    void relayout(std::size_t capacity)
+    {
+        std::vector<T> nodes(2 * capacity);
+        for (std::size_t i = 0; i < this->_size; ++i)
+        {
+            nodes[capacity + i] = this->leaf(i);
+        }
+
+        this->_nodes = std::move(nodes);
+        this->_capacity = capacity;
+        this->_head = 0;
+        this->rebuild();
+    }
+
+  private:
+    // the inner nodes at [1, _capacity), the root at 1, and the leaves at [_capacity, 2 _capacity)
+    std::vector<T> _nodes;
+    std::size_t _capacity = 0;
+
+    // the slot of the first element in the ring of leaves
+    std::size_t _head = 0;
+    std::size_t _size = 0;
+
+    Merge _merge;
+};
+
+} // namespace splines::utils
+
+#endif // SEGMENTTREE_H
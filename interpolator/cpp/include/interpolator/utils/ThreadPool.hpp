@@ -0,0 +1,394 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace splines::utils
+{
+
+/**
+ * @brief The AsyncTask class
+ * A handle to a task submitted with ThreadPool::async. If no worker has started the task when it is waited, the
+ * waiting thread runs it, so waiting from a worker of the same pool can not deadlock. The destructor waits for the
+ * task (ignoring its exception), so the data referenced by the task outlives it
+ */
+class AsyncTask
+{
+  public:
+    AsyncTask() = default;
+    AsyncTask(AsyncTask &&) = default;
+    AsyncTask &operator=(AsyncTask &&other)
+    {
+        this->wait_ignoring_exception();
+        this->_state = std::move(other._state);
+        return *this;
+    }
+
+    ~AsyncTask()
+    {
+        this->wait_ignoring_exception();
+    }
+
+    /**
+     * @brief wait
+     * Blocks until the task is done and rethrows its exception. Nothing is done if there is no task
+     */
+    void wait()
+    {
+        if (!this->_state)
+        {
+            return;
+        }
+
+        auto state = std::move(this->_state);
+        if (!state->claimed.exchange(true))
+        {
+            state->run();
+        }
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->condition.wait(lock, [&state]() { return state->done; });
+        if (state->exception)
+        {
+            std::rethrow_exception(state->exception);
+        }
+    }
+
+  private:
+    friend class ThreadPool;
+
+    struct State
+    {
+        std::function<void()> task;
+        std::atomic<bool> claimed = false;
+        bool done = false;
+        std::exception_ptr exception;
+        std::mutex mutex;
+        std::condition_variable condition;
+
+        void run()
+        {
+            std::exception_ptr task_exception;
+            try
+            {
+                this->task();
+            }
+            catch (...)
+            {
+                task_exception = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->exception = task_exception;
+            this->done = true;
+            this->condition.notify_all();
+        }
+    };
+
+    explicit AsyncTask(std::shared_ptr<State> state)
+        : _state(std::move(state))
+    {
+    }
+
+    void wait_ignoring_exception()
+    {
+        try
+        {
+            this->wait();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    std::shared_ptr<State> _state;
+};
+
+/**
+ * @brief The ThreadPool class
+ *
+ * A persistent pool of worker threads. Each worker owns a task queue and, when it is empty, steals tasks from
+ * the back of the other queues. The process-wide pool (@see instance) is shared by all interpolators, so no
+ * thread is created per call.
+ *
+ */
+class ThreadPool
+{
+  public:
+    explicit ThreadPool(unsigned num_threads = std::max(std::thread::hardware_concurrency(), 1u))
+    {
+        num_threads = std::max(num_threads, 1u);
+        for (unsigned i = 0; i < num_threads; ++i)
+        {
+            this->_queues.push_back(std::make_unique<Queue>());
+        }
+
+        this->_threads.reserve(num_threads);
+        for (unsigned i = 0; i < num_threads; ++i)
+        {
+            this->_threads.emplace_back([this, i]() { this->work(i); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            this->_stop = true;
+        }
+        this->_condition.notify_all();
+
+        for (auto &thread : this->_threads)
+        {
+            thread.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief instance
+     * The process-wide pool, created on first use with one worker per hardware thread
+     *
+     * @return
+     * The shared ThreadPool
+     */
+    static ThreadPool &instance()
+    {
+        static ThreadPool thread_pool;
+        return thread_pool;
+    }
+
+    /**
+     * @brief size
+     *
+     * @return
+     * The number of worker threads
+     */
+    unsigned size() const
+    {
+        return static_cast<unsigned>(this->_threads.size());
+    }
+
+    /**
+     * @brief submit
+     * Enqueues a task to be run by one of the workers
+     *
+     * @param task
+     */
+    void submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            ++this->_num_tasks;
+        }
+
+        auto &queue = *this->_queues[this->_next_queue++ % this->_queues.size()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        this->_condition.notify_one();
+    }
+
+    /**
+     * @brief async
+     * Submits a task whose completion can be waited (@see AsyncTask)
+     *
+     * @param task
+     * @return
+     * The handle to wait for the task
+     */
+    AsyncTask async(std::function<void()> task)
+    {
+        auto state = std::make_shared<AsyncTask::State>();
+        state->task = std::move(task);
+        this->submit([state]() {
+            if (!state->claimed.exchange(true))
+            {
+                state->run();
+            }
+        });
+        return AsyncTask(state);
+    }
+
+    /**
+     * @brief parallel_for
+     * Runs task(chunk) for every chunk in [0, num_chunks). The chunks are claimed one at a time by the calling thread
+     * and by up to num_threads - 1 workers, so threads which finish cheaper chunks keep taking new ones.
+     * The calling thread blocks until all chunks are done and the first exception thrown by a task is rethrown.
+     *
+     * @param num_chunks
+     * The number of chunks
+     *
+     * @param num_threads
+     * The maximum number of threads running chunks, including the calling thread
+     *
+     * @param task
+     * A callable with the signature void(std::size_t chunk)
+     */
+    template <typename Task> void parallel_for(std::size_t num_chunks, unsigned num_threads, const Task &task)
+    {
+        if (!num_chunks)
+        {
+            return;
+        }
+
+        auto const num_helpers =
+            std::min<std::size_t>({num_threads ? num_threads - 1 : 0, this->size(), num_chunks - 1});
+        if (!num_helpers)
+        {
+            for (std::size_t chunk = 0; chunk < num_chunks; ++chunk)
+            {
+                task(chunk);
+            }
+            return;
+        }
+
+        // helpers may start after all chunks are done, so the shared state must outlive this call.
+        // The task is only touched for claimed chunks, which are all finished before returning
+        auto state = std::make_shared<ParallelForState>();
+        auto run_chunks = [state, &task, num_chunks]() {
+            std::size_t num_done = 0;
+            for (auto chunk = state->next_chunk++; chunk < num_chunks; chunk = state->next_chunk++)
+            {
+                try
+                {
+                    task(chunk);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (!state->exception)
+                    {
+                        state->exception = std::current_exception();
+                    }
+                }
+                ++num_done;
+            }
+
+            if (num_done)
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->num_done += num_done;
+                if (state->num_done == num_chunks)
+                {
+                    state->condition.notify_all();
+                }
+            }
+        };
+
+        for (std::size_t i = 0; i < num_helpers; ++i)
+        {
+            this->submit(run_chunks);
+        }
+        run_chunks();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->condition.wait(lock, [&state, num_chunks]() { return state->num_done == num_chunks; });
+        if (state->exception)
+        {
+            std::rethrow_exception(state->exception);
+        }
+    }
+
+  private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    struct ParallelForState
+    {
+        std::atomic<std::size_t> next_chunk = 0;
+        std::size_t num_done = 0;
+        std::exception_ptr exception;
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+
+    /**
+     * @brief pop_task
+     * Takes a task from the front of the worker queue or, if it is empty, steals one from the back of another queue
+     *
+     * @param index
+     * The worker index
+     *
+     * @param task
+     * The task found
+     *
+     * @return
+     * true if a task was found
+     */
+    bool pop_task(unsigned index, std::function<void()> &task)
+    {
+        for (std::size_t i = 0; i < this->_queues.size(); ++i)
+        {
+            auto &queue = *this->_queues[(index + i) % this->_queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty())
+            {
+                if (i == 0)
+                {
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                }
+                else
+                {
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                }
+                --this->_num_tasks;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(unsigned index)
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            if (this->pop_task(index, task))
+            {
+                task();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_condition.wait(lock, [this]() { return this->_stop || this->_num_tasks > 0; });
+            if (this->_stop && this->_num_tasks == 0)
+            {
+                return;
+            }
+        }
+    }
+
+  private:
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _threads;
+    std::atomic<std::size_t> _next_queue = 0;
+
+    // number of queued tasks. It is incremented while holding _mutex (before the task is queued), so a waiting worker
+    // can not miss a task
+    std::atomic<std::size_t> _num_tasks = 0;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _stop = false;
+};
+
+} // namespace splines::utils
+
+#endif // THREADPOOL_H
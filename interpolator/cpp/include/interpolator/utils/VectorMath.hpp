@@ -0,0 +1,238 @@
+#ifndef VECTORMATH_H
+#define VECTORMATH_H
+
+#include <cmath>
+
+/**
+ * The batch kernels are compiled once per instruction set (SSE2, AVX2 and AVX-512) and the version for the running CPU
+ * is picked when the library is loaded. The loops they call must be inlined into every clone (SPLINES_ALWAYS_INLINE):
+ * a loop left out of line is compiled for the default instruction set only.
+ * The clones are dispatched through an ifunc, which the sanitizers do not support (-fsanitize=thread crashes at load
+ * time): SPLINES_NO_TARGET_CLONES compiles the kernels once, for the default instruction set
+ */
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__linux__) && !defined(SPLINES_NO_TARGET_CLONES)
+#define SPLINES_TARGET_CLONES __attribute__((target_clones("default", "avx2", "avx512f")))
+#else
+#define SPLINES_TARGET_CLONES
+#endif
+
+#if defined(__GNUC__)
+#define SPLINES_ALWAYS_INLINE __attribute__((always_inline)) inline
+#else
+#define SPLINES_ALWAYS_INLINE inline
+#endif
+
+namespace splines::utils
+{
+
+/**
+ * @brief The VectorMath struct
+ *
+ * Branch-free sin, cos, acos and atan2 (Cephes polynomials), so the loops calling them are vectorised, which is not
+ * possible with the libm calls. The branches are replaced by selects: every path is computed and the right one is
+ * picked.
+ * Maximum error against the libm functions, for the arguments used by the interpolators: sin and cos 2 ULP
+ * (|x| < 1E3), acos 1 ULP and atan2 2 ULP.
+ * The loops are only vectorised if the compiler may assume that math functions do not set errno nor trap
+ * (-fno-math-errno -fno-trapping-math).
+ * The functions are defined in the header, so they are inlined into the loops calling them
+ *
+ */
+struct VectorMath
+{
+    static double sin(double x)
+    {
+        auto const [octant, z] = reduce(std::fabs(x));
+
+        // sin(x + pi) = -sin(x) and sin(x + pi / 2) = cos(x)
+        auto sign = std::copysign(1.0, x);
+        sign = octant > 3.0 ? -sign : sign;
+        auto const half_turn_octant = octant > 3.0 ? octant - 4.0 : octant;
+        return sign * (half_turn_octant == 2.0 ? cos_kernel(z) : sin_kernel(z));
+    }
+
+    static double cos(double x)
+    {
+        auto const [octant, z] = reduce(std::fabs(x));
+
+        // cos(x + pi) = -cos(x) and cos(x + pi / 2) = -sin(x)
+        auto const sign = octant > 3.0 ? -1.0 : 1.0;
+        auto const half_turn_octant = octant > 3.0 ? octant - 4.0 : octant;
+        return sign * (half_turn_octant == 2.0 ? -sin_kernel(z) : cos_kernel(z));
+    }
+
+    struct SinCos
+    {
+        double sin;
+        double cos;
+    };
+
+    /**
+     * @brief sincos
+     * sin(x) and cos(x) from a single reduction, the same values of sin and cos
+     */
+    static SinCos sincos(double x)
+    {
+        auto const [octant, z] = reduce(std::fabs(x));
+        auto const sin_z = sin_kernel(z);
+        auto const cos_z = cos_kernel(z);
+
+        auto const half_turn = octant > 3.0;
+        auto const quarter_turn = (half_turn ? octant - 4.0 : octant) == 2.0;
+        auto const sin_sign = half_turn ? -std::copysign(1.0, x) : std::copysign(1.0, x);
+        auto const cos_sign = half_turn ? -1.0 : 1.0;
+        return {sin_sign * (quarter_turn ? cos_z : sin_z), cos_sign * (quarter_turn ? -sin_z : cos_z)};
+    }
+
+    static double acos(double x)
+    {
+        // acos(x) = 2 asin(sqrt((1 - x) / 2)) is accurate near 1, acos(x) = pi / 2 - asin(x) elsewhere. The argument
+        // of asin is picked first, so a single asin is computed
+        auto const abs_x = std::fabs(x);
+        auto const near_one = x > 0.5;
+        auto const root = std::sqrt(near_one ? 0.5 * (1.0 - x) : 2.0 * (1.0 - abs_x));
+        auto const angle = asin(near_one ? root : abs_x, root);
+        return near_one ? 2.0 * angle : M_PI_2 - std::copysign(angle, x);
+    }
+
+    static double atan2(double y, double x)
+    {
+        auto const abs_x = std::fabs(x);
+        auto const abs_y = std::fabs(y);
+
+        // the ratio is in [0, 1]; atan(y / x) = pi / 2 - atan(x / y)
+        auto const swap = abs_y > abs_x;
+        auto const numerator = swap ? abs_x : abs_y;
+        auto const denominator = swap ? abs_y : abs_x;
+        auto angle = denominator > 0.0 ? atan(numerator, denominator) : 0.0;
+        angle = swap ? M_PI_2 - angle : angle;
+        angle = std::copysign(1.0, x) < 0.0 ? M_PI - angle : angle;
+        return std::copysign(angle, y);
+    }
+
+  private:
+    struct Reduction
+    {
+        double octant; // the even octant (0, 2, 4 or 6) of x
+        double z;      // x less the octant start, in [-pi / 4, pi / 4]
+    };
+
+    /**
+     * @brief reduce
+     * Cody-Waite reduction of x >= 0 by pi / 4, with pi / 4 split in three parts so the reduction is exact enough
+     */
+    static Reduction reduce(double x)
+    {
+        constexpr double pi_4_1 = 7.85398125648498535156E-1;
+        constexpr double pi_4_2 = 3.77489470793079817668E-8;
+        constexpr double pi_4_3 = 2.69515142907905952645E-15;
+
+        auto y = std::floor(x * (4.0 / M_PI));
+        y += y - 2.0 * std::floor(0.5 * y); // odd octants are mapped to the next even one
+        auto const z = ((x - y * pi_4_1) - y * pi_4_2) - y * pi_4_3;
+        return {y - 8.0 * std::floor(0.125 * y), z};
+    }
+
+    static double sin_kernel(double z)
+    {
+        auto const zz = z * z;
+        auto const p = ((((1.58962301576546568060E-10 * zz - 2.50507477628578072866E-8) * zz +
+                          2.75573136213857245213E-6) *
+                             zz -
+                         1.98412698295895385996E-4) *
+                            zz +
+                        8.33333333332211858878E-3) *
+                           zz -
+                       1.66666666666666307295E-1;
+        return z + z * zz * p;
+    }
+
+    static double cos_kernel(double z)
+    {
+        auto const zz = z * z;
+        auto const p = ((((-1.13585365213876817300E-11 * zz + 2.08757008419747316778E-9) * zz -
+                          2.75573141792967388112E-7) *
+                             zz +
+                         2.48015872888517045348E-5) *
+                            zz -
+                        1.38888888888730564116E-3) *
+                           zz +
+                       4.16666666666665929218E-2;
+        return 1.0 - 0.5 * zz + zz * zz * p;
+    }
+
+    /**
+     * @brief asin
+     * asin(x) for x in [0, 1], given root = sqrt(2 (1 - x)) if x > 0.625. The rational approximations of both ranges
+     * share a division: the divisions and square roots are most of the cost of the vectorised loops
+     */
+    static double asin(double x, double root)
+    {
+        // x > 0.625: asin(x) = pi / 2 - 2 asin(sqrt((1 - x) / 2)), with a rational approximation in 1 - x
+        auto const near_one = x > 0.625;
+        auto const zz = 1.0 - x;
+        auto const near_one_numerator =
+            zz *
+            ((((2.967721961301243206100E-3 * zz - 5.634242780008963776856E-1) * zz + 6.968710824104713396794E0) * zz -
+              2.556901049652824852289E1) *
+                 zz +
+             2.853665548261061424989E1);
+        auto const near_one_denominator =
+            (((zz - 2.194779531642920639778E1) * zz + 1.470656354026814941758E2) * zz - 3.838770957603691357202E2) *
+                zz +
+            3.424398657913078477438E2;
+
+        // x <= 0.625: asin(x) = x + x^3 P(x^2) / Q(x^2)
+        auto const z = x * x;
+        auto const p = (((((4.253011369004428248960E-3 * z - 6.019598008014123785661E-1) * z +
+                           5.444622390564711410273E0) *
+                              z -
+                          1.626247967210700244449E1) *
+                             z +
+                         1.956261983317594739197E1) *
+                            z -
+                        8.198089802484824371615E0);
+        auto const q = ((((z - 1.474091372988853791896E1) * z + 7.049610280856842141659E1) * z -
+                         1.471791292232726029859E2) *
+                            z +
+                        1.395105614657485689735E2) *
+                           z -
+                       4.918853881490881290097E1;
+
+        auto const r = (near_one ? near_one_numerator : z * p) / (near_one ? near_one_denominator : q);
+        return near_one ? ((M_PI_4 - root) - (root * r - 6.123233995736765886130E-17)) + M_PI_4 : x + x * r;
+    }
+
+    /**
+     * @brief atan
+     * atan(n / d) for 0 <= n <= d and d > 0. The argument of the polynomial is computed from n and d, with a single
+     * division in both ranges
+     */
+    static double atan(double n, double d)
+    {
+        // n / d > 0.66: atan(n / d) = pi / 4 + atan((n - d) / (n + d))
+        auto const shift = n > 0.66 * d;
+        auto const t = (shift ? n - d : n) / (shift ? n + d : d);
+
+        auto const z = t * t;
+        auto const p = ((((-8.750608600031904122785E-1 * z - 1.615753718733365076637E1) * z -
+                          7.500855792314704667340E1) *
+                             z -
+                         1.228866684490136173410E2) *
+                            z -
+                        6.485021904942025371773E1);
+        auto const q = ((((z + 2.485846490142306297962E1) * z + 1.650270098316988542046E2) * z +
+                         4.328810604912902668951E2) *
+                            z +
+                        4.853903996359136964868E2) *
+                           z +
+                       1.945506571482613964425E2;
+        auto const angle = t + t * (z * p / q);
+
+        return shift ? M_PI_4 + (angle + 0.5 * 6.123233995736765886130E-17) : angle;
+    }
+};
+
+} // namespace splines::utils
+
+#endif // VECTORMATH_H
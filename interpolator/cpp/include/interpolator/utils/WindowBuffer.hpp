@@ -0,0 +1,263 @@
+#ifndef WINDOWBUFFER_H
+#define WINDOWBUFFER_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace splines::utils
+{
+
+/**
+ * @brief The WindowBuffer class
+ *
+ * A contiguous ring buffer for sliding windows: the elements are kept in the range [_first, end) of a vector. Dropping
+ * the first element only moves _first forward and, instead of wrapping around, the elements are moved back to the
+ * start of the vector when it is full and at least half of it is free. So appending to the back and dropping from the
+ * front cost amortised O(1), while the elements stay contiguous (e.g. for std::span views).
+ * With reserve_window, a window of fixed size slides without any allocation. Inserting or erasing an element elsewhere
+ * is the slow path, as for std::vector.
+ * The interface follows std::vector, so the class is a drop-in replacement for the tables indexed by trajectory vertex.
+ *
+ */
+template <typename T> class WindowBuffer
+{
+  public:
+    typedef T value_type;
+    typedef T *iterator;
+    typedef const T *const_iterator;
+
+    WindowBuffer() = default;
+
+    WindowBuffer(const WindowBuffer &other)
+    {
+        this->_buffer.reserve(other._buffer.capacity());
+        this->_buffer.assign(other.begin(), other.end());
+    }
+
+    WindowBuffer &operator=(const WindowBuffer &rhs)
+    {
+        if (this != &rhs)
+        {
+            this->clear();
+            this->_buffer.reserve(rhs._buffer.capacity());
+            this->_buffer.assign(rhs.begin(), rhs.end());
+        }
+        return *this;
+    }
+
+    WindowBuffer(WindowBuffer &&other) noexcept
+        : _buffer(std::move(other._buffer))
+        , _first(std::exchange(other._first, 0))
+    {
+        other._buffer.clear();
+    }
+
+    WindowBuffer &operator=(WindowBuffer &&rhs) noexcept
+    {
+        this->_buffer = std::move(rhs._buffer);
+        this->_first = std::exchange(rhs._first, 0);
+        rhs._buffer.clear();
+        return *this;
+    }
+
+    std::size_t size() const
+    {
+        return this->_buffer.size() - this->_first;
+    }
+
+    bool empty() const
+    {
+        return this->size() == 0;
+    }
+
+    T *data()
+    {
+        return this->_buffer.data() + this->_first;
+    }
+
+    const T *data() const
+    {
+        return this->_buffer.data() + this->_first;
+    }
+
+    iterator begin()
+    {
+        return this->data();
+    }
+
+    iterator end()
+    {
+        return this->_buffer.data() + this->_buffer.size();
+    }
+
+    const_iterator begin() const
+    {
+        return this->data();
+    }
+
+    const_iterator end() const
+    {
+        return this->_buffer.data() + this->_buffer.size();
+    }
+
+    T &operator[](std::size_t index)
+    {
+        return this->_buffer[this->_first + index];
+    }
+
+    const T &operator[](std::size_t index) const
+    {
+        return this->_buffer[this->_first + index];
+    }
+
+    T &front()
+    {
+        return (*this)[0];
+    }
+
+    const T &front() const
+    {
+        return (*this)[0];
+    }
+
+    T &back()
+    {
+        return this->_buffer.back();
+    }
+
+    const T &back() const
+    {
+        return this->_buffer.back();
+    }
+
+    /**
+     * @brief reserve
+     * The same of std::vector::reserve
+     *
+     * @param size
+     */
+    void reserve(std::size_t size)
+    {
+        this->compact();
+        this->_buffer.reserve(size);
+    }
+
+    /**
+     * @brief reserve_window
+     * Reserves room for a window of up to window_size elements sliding (push_back and pop_front) without allocation,
+     * i.e. twice its size
+     *
+     * @param window_size
+     */
+    void reserve_window(std::size_t window_size)
+    {
+        this->reserve(2 * window_size);
+    }
+
+    void clear()
+    {
+        this->_buffer.clear();
+        this->_first = 0;
+    }
+
+    void resize(std::size_t size)
+    {
+        this->compact();
+        this->_buffer.resize(size);
+    }
+
+    template <typename InputIt> void assign(InputIt first, InputIt last)
+    {
+        this->_first = 0;
+        this->_buffer.assign(first, last);
+    }
+
+    void push_back(const T &value)
+    {
+        this->make_room();
+        this->_buffer.push_back(value);
+    }
+
+    void pop_back()
+    {
+        this->_buffer.pop_back();
+        if (this->empty())
+        {
+            this->clear();
+        }
+    }
+
+    /**
+     * @brief pop_front
+     * Drops the first element in O(1): the element is left in the free part of the vector
+     */
+    void pop_front()
+    {
+        ++this->_first;
+        if (this->empty())
+        {
+            this->clear();
+        }
+    }
+
+    iterator insert(const_iterator position, const T &value)
+    {
+        auto const index = static_cast<std::size_t>(position - this->begin());
+        if (index == 0 && this->_first)
+        {
+            this->_buffer[--this->_first] = value;
+            return this->begin();
+        }
+
+        this->make_room();
+        this->_buffer.insert(this->_buffer.begin() + (this->_first + index), value);
+        return this->begin() + index;
+    }
+
+    iterator erase(const_iterator position)
+    {
+        auto const index = static_cast<std::size_t>(position - this->begin());
+        if (index == 0)
+        {
+            this->pop_front();
+            return this->begin();
+        }
+
+        this->_buffer.erase(this->_buffer.begin() + (this->_first + index));
+        return this->begin() + index;
+    }
+
+  private:
+    /**
+     * @brief make_room
+     * Called before an element is added: if the vector is full and at least half of it is free, the elements are
+     * moved back to its start. Otherwise the vector grows as usual
+     */
+    void make_room()
+    {
+        if (this->_buffer.size() == this->_buffer.capacity() && this->_first >= this->size())
+        {
+            this->compact();
+        }
+    }
+
+    void compact()
+    {
+        if (this->_first)
+        {
+            this->_buffer.erase(this->_buffer.begin(), this->_buffer.begin() + this->_first);
+            this->_first = 0;
+        }
+    }
+
+  private:
+    std::vector<T> _buffer;
+
+    // index of the first element in _buffer. The elements before it were dropped
+    std::size_t _first = 0;
+};
+
+} // namespace splines::utils
+
+#endif // WINDOWBUFFER_H
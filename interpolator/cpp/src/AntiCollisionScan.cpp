@@ -0,0 +1,95 @@
+#include "interpolator/AntiCollisionScan.hpp"
+#include "interpolator/utils/Multithreading.hpp"
+
+namespace splines
+{
+
+AntiCollisionScan::AntiCollisionScan(const BaseInterpolator &reference, double scan_radius)
+    : _reference(&reference)
+    , _scan_radius(scan_radius)
+{
+    if (!(scan_radius > 0.0))
+    {
+        throw std::invalid_argument("AntiCollisionScan: the scan radius must be positive");
+    }
+}
+
+void AntiCollisionScan::add_offset(const BaseInterpolator &offset, const Point &origin)
+{
+    this->_offsets.emplace_back(offset);
+    this->_origins.push_back(origin);
+}
+
+std::vector<SeparationProfile> AntiCollisionScan::scan(const PositionGrid &grid, unsigned num_threads) const
+{
+    if (!num_threads)
+    {
+        return {};
+    }
+
+    auto const reference_points = this->_reference->generate_points(grid, num_threads);
+
+    std::vector<SeparationProfile> profiles(this->_offsets.size());
+    for (auto &profile : profiles)
+    {
+        profile.offset_points.resize(reference_points.size());
+    }
+
+    // the work is the offsets times the reference positions, so a few offsets along a long reference are split too
+    utils::Multithreading::run_chunks(
+        profiles.size() * reference_points.size(), num_threads,
+        [&reference_points, &profiles, this](std::size_t chunk_first, std::size_t chunk_last) {
+            auto previous_point = Point{};
+            auto previous_distance = std::numeric_limits<double>::max();
+
+            for (auto i = chunk_first; i < chunk_last; ++i)
+            {
+                auto const offset = i / reference_points.size();
+                auto const position = i % reference_points.size();
+                if (i == chunk_first || position == 0)
+                {
+                    previous_distance = std::numeric_limits<double>::max();
+                }
+
+                // the offset point nearest to the previous reference point bounds the separation
+                auto const &origin = this->_origins[offset];
+                auto const &reference_point = reference_points[position].point;
+                auto const point =
+                    Point{reference_point.x - origin.x, reference_point.y - origin.y, reference_point.z - origin.z};
+                auto const step = std::sqrt(
+                    (point.x - previous_point.x) * (point.x - previous_point.x) +
+                    (point.y - previous_point.y) * (point.y - previous_point.y) +
+                    (point.z - previous_point.z) * (point.z - previous_point.z));
+
+                auto bound = this->_scan_radius;
+                if (previous_distance < this->_scan_radius)
+                {
+                    // widened by the rounding of the distances
+                    bound = std::min(bound, (previous_distance + step) * (1.0 + 1E-12) + 1E-9);
+                }
+
+                auto closest = this->_offsets[offset].closest_point(point, bound);
+                if (closest.distance > this->_scan_radius)
+                {
+                    closest = {{}, std::numeric_limits<double>::max()};
+                }
+
+                profiles[offset].offset_points[position] = closest;
+                previous_point = point;
+                previous_distance = closest.distance;
+            }
+        });
+
+    for (auto &profile : profiles)
+    {
+        auto const &points = profile.offset_points;
+        profile.minimum_index = static_cast<std::size_t>(
+            std::min_element(
+                points.begin(), points.end(),
+                [](const ClosestPoint &lhs, const ClosestPoint &rhs) { return lhs.distance < rhs.distance; }) -
+            points.begin());
+    }
+    return profiles;
+}
+
+} // namespace splines
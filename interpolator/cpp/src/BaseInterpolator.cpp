@@ -1,9 +1,65 @@
 #include "interpolator/BaseInterpolator.hpp"
+#include "interpolator/utils/BatchKernels.hpp"
 #include "interpolator/utils/Multithreading.hpp"
 
+#include <stdexcept>
+
 namespace splines
 {
 
+namespace
+{
+
+Point tangent(const Vertex &vertex)
+{
+    return {
+        sin(vertex.inclination()) * cos(vertex.azimuth()), sin(vertex.inclination()) * sin(vertex.azimuth()),
+        cos(vertex.inclination())};
+}
+
+// the angle (rad) between two unit vectors, accurate also when they are nearly parallel
+double angle_between(const Point &t_1, const Point &t_2)
+{
+    auto const cross =
+        Point{t_1.y * t_2.z - t_1.z * t_2.y, t_1.z * t_2.x - t_1.x * t_2.z, t_1.x * t_2.y - t_1.y * t_2.x};
+    return std::atan2(
+        std::sqrt(cross.x * cross.x + cross.y * cross.y + cross.z * cross.z),
+        t_1.x * t_2.x + t_1.y * t_2.y + t_1.z * t_2.z);
+}
+
+// the distance between point and the chord from first to last
+double chord_distance(const Point &first, const Point &last, const Point &point)
+{
+    auto const chord = Point{last.x - first.x, last.y - first.y, last.z - first.z};
+    auto const offset = Point{point.x - first.x, point.y - first.y, point.z - first.z};
+    auto const squared_length = chord.x * chord.x + chord.y * chord.y + chord.z * chord.z;
+    auto const projection = offset.x * chord.x + offset.y * chord.y + offset.z * chord.z;
+    auto const t = squared_length > 0.0 ? std::clamp(projection / squared_length, 0.0, 1.0) : 0.0;
+    auto const distance = Point{offset.x - t * chord.x, offset.y - t * chord.y, offset.z - t * chord.z};
+    return std::sqrt(distance.x * distance.x + distance.y * distance.y + distance.z * distance.z);
+}
+
+void include(IntervalAggregates &aggregates, const Point &point)
+{
+    for (auto axis : {&Point::x, &Point::y, &Point::z})
+    {
+        aggregates.lower.*axis = std::min(aggregates.lower.*axis, point.*axis);
+        aggregates.upper.*axis = std::max(aggregates.upper.*axis, point.*axis);
+    }
+}
+
+IntervalAggregates translate(IntervalAggregates aggregates, const Point &shift)
+{
+    for (auto axis : {&Point::x, &Point::y, &Point::z})
+    {
+        aggregates.lower.*axis += shift.*axis;
+        aggregates.upper.*axis += shift.*axis;
+    }
+    return aggregates;
+}
+
+} // namespace
+
 BaseInterpolator::BaseInterpolator(const Vertices &trajectory)
     : _trajectory(trajectory)
 {
@@ -11,47 +67,77 @@ BaseInterpolator::BaseInterpolator(const Vertices &trajectory)
 
 BaseInterpolator::BaseInterpolator(BaseInterpolator &&other)
     : _trajectory(std::move(other._trajectory))
+    , _cumulative_projections(std::move(other._cumulative_projections))
+    , _projections_offset(other._projections_offset)
+    , _segment_aggregates(std::move(other._segment_aggregates))
 {
 }
 
 BaseInterpolator &BaseInterpolator::operator=(BaseInterpolator &&rhs)
 {
     this->_trajectory = std::move(rhs._trajectory);
+    this->_cumulative_projections = std::move(rhs._cumulative_projections);
+    this->_projections_offset = rhs._projections_offset;
+    this->_segment_aggregates = std::move(rhs._segment_aggregates);
     return *this;
 }
 
 BaseInterpolator::BaseInterpolator(const BaseInterpolator &other)
     : _trajectory(other._trajectory)
+    , _cumulative_projections(other._cumulative_projections)
+    , _projections_offset(other._projections_offset)
+    , _segment_aggregates(other._segment_aggregates)
 {
 }
 
 BaseInterpolator &BaseInterpolator::operator=(const BaseInterpolator &rhs)
 {
     this->_trajectory = rhs._trajectory;
+    this->_cumulative_projections = rhs._cumulative_projections;
+    this->_projections_offset = rhs._projections_offset;
+    this->_segment_aggregates = rhs._segment_aggregates;
     return *this;
 }
 
-const Vertices &BaseInterpolator::trajectory() const
-{
-    return this->_trajectory;
-}
-
 void BaseInterpolator::set_trajectory(const Vertices &trajectory)
 {
     this->_trajectory = trajectory;
+    this->update_cumulative_projections();
 }
 
 AdjacentVertices BaseInterpolator::calculate_adjacent_vertices(double position) const
 {
-    auto upper_vertex = this->_trajectory.vertices().upper_bound(position);
+    return this->calculate_adjacent_vertices(this->_trajectory.upper_bound_index(position));
+}
+
+std::size_t BaseInterpolator::calculate_upper_index(double position, std::size_t hint) const
+{
+    auto const positions = this->_trajectory.positions_view();
+    auto const is_upper_index = [&positions, position](std::size_t index) {
+        return index <= positions.size() && (index == 0 || positions[index - 1] <= position) &&
+               (index == positions.size() || position < positions[index]);
+    };
 
-    if (std::fabs(upper_vertex->position()) > std::numeric_limits<double>::epsilon())
+    if (is_upper_index(hint))
+    {
+        return hint;
+    }
+    else if (hint < positions.size() && positions[hint] <= position)
     {
-        return {*std::prev(upper_vertex), *upper_vertex};
+        // gallop forward from the hint: a monotone walk costs O(log distance) instead of O(log size)
+        std::size_t bound = 1;
+        while (hint + bound < positions.size() && positions[hint + bound] <= position)
+        {
+            bound *= 2;
+        }
+
+        auto const first = positions.begin() + (hint + bound / 2 + 1);
+        auto const last = positions.begin() + std::min(hint + bound, positions.size());
+        return static_cast<std::size_t>(std::upper_bound(first, last, position) - positions.begin());
     }
     else
     {
-        return {*std::prev(upper_vertex), *std::prev(upper_vertex)};
+        return this->_trajectory.upper_bound_index(position);
     }
 }
 
@@ -61,146 +147,729 @@ double BaseInterpolator::calculate_delta_angle(double angle_1, double angle_2) c
     return delta_angle > 0.0 ? acos(cos(delta_angle)) : -acos(cos(delta_angle));
 }
 
+BaseInterpolator::Bend BaseInterpolator::calculate_direction_bend(
+    double length, double delta_s_star, double first_derivative, double second_derivative)
+{
+    // the points are delta_s_star * d, so their second derivative is 2 d' + delta_s_star d''. Their first derivative
+    // d + delta_s_star d' is not shorter than d, since a unit vector is orthogonal to its derivative, so the tangent
+    // turns at most the second derivative times the length. The points deviate from the line interpolating the ends
+    // at most the second derivative times length^2 / 8
+    auto const points_second_derivative = 2.0 * first_derivative + delta_s_star * second_derivative;
+    return {points_second_derivative * length, points_second_derivative * length * length / 8.0};
+}
+
 Vertex BaseInterpolator::vertex_at_position(double position) const
 {
-    if (position < this->_trajectory.vertices().begin()->position() ||
-        std::fabs(position - this->_trajectory.vertices().begin()->position()) < std::numeric_limits<double>::epsilon())
+    return this->vertex_at_position(position, this->_trajectory.upper_bound_index(position));
+}
+
+void BaseInterpolator::add_n_drop(const Vertex &vertex)
+{
+    // the same of Vertices::add_n_drop, but the tables are updated after each change
+    if (auto const index = this->_trajectory.insert(vertex))
     {
-        return *this->_trajectory.vertices().begin();
+        this->update_cumulative_projections(*index, VertexChange::insertion);
     }
-    else if (
-        position > this->_trajectory.vertices().rbegin()->position() ||
-        std::fabs(this->_trajectory.vertices().rbegin()->position() - position) <
-            std::numeric_limits<double>::epsilon())
+
+    auto const last_index = this->_trajectory.size() - 1;
+    this->_trajectory.erase(last_index);
+    this->update_cumulative_projections(last_index, VertexChange::erasure);
+}
+
+void BaseInterpolator::drop_n_add(const Vertex &vertex)
+{
+    // the same of Vertices::drop_n_add, but the tables are updated after each change
+    this->_trajectory.erase(0);
+    this->update_cumulative_projections(0, VertexChange::erasure);
+
+    if (auto const index = this->_trajectory.insert(vertex))
     {
-        return *this->_trajectory.vertices().rbegin();
+        this->update_cumulative_projections(*index, VertexChange::insertion);
     }
-    else
+}
+
+void BaseInterpolator::slide(const Vertex &vertex)
+{
+    // the same of Vertices::slide, but the tables are updated after each change
+    if (auto const index = this->_trajectory.insert(vertex))
     {
+        this->update_cumulative_projections(*index, VertexChange::insertion);
+    }
 
-        auto const &adjacent_vertices = this->calculate_adjacent_vertices(position);
+    auto const capacity = this->_trajectory.capacity();
+    if (capacity && this->_trajectory.size() > capacity)
+    {
+        this->_trajectory.erase(0);
+        this->update_cumulative_projections(0, VertexChange::erasure);
+    }
+}
 
-        auto inclination_interpolated = this->inclination_at_position(position, adjacent_vertices);
-        auto azimuth_interpolated = this->azimuth_at_position(position, adjacent_vertices);
+TrajectoryPoint BaseInterpolator::point_at_position(double position) const
+{
+    return this->point_at_position(position, this->_trajectory.upper_bound_index(position));
+}
 
-        return {position, inclination_interpolated, azimuth_interpolated};
+std::vector<Vertex> BaseInterpolator::generate_vertices(std::size_t num_vertices, unsigned num_threads) const
+{
+    if (num_vertices < _trajectory.size())
+    {
+        return _trajectory.vertices_python();
     }
+
+    return this->generate_vertices(this->generate_grid(num_vertices), num_threads);
 }
 
-double BaseInterpolator::inclination_at_position(double position) const
+std::vector<Vertex> BaseInterpolator::generate_vertices(const PositionGrid &grid, unsigned num_threads) const
 {
-    return this->inclination_at_position(position, this->calculate_adjacent_vertices(position));
+    std::vector<Vertex> vertices(num_threads ? grid.size() : 0);
+    this->generate_blocks(
+        grid, true, false, num_threads,
+        [&vertices](std::size_t offset, std::span<const Vertex> block_vertices, std::span<const Point>) {
+            std::copy(block_vertices.begin(), block_vertices.end(), vertices.begin() + offset);
+        });
+    return vertices;
 }
 
-double BaseInterpolator::azimuth_at_position(double position) const
+std::vector<double> BaseInterpolator::generate_x_projections(std::size_t num_points, unsigned num_threads) const
 {
-    return this->azimuth_at_position(position, this->calculate_adjacent_vertices(position));
+    return this->generate_projections(&Point::x, num_points, num_threads);
 }
 
-void BaseInterpolator::add_n_drop(const Vertex &vertex)
+std::vector<double> BaseInterpolator::generate_y_projections(std::size_t num_points, unsigned num_threads) const
 {
-    this->_trajectory.add_n_drop(vertex);
+    return this->generate_projections(&Point::y, num_points, num_threads);
 }
 
-void BaseInterpolator::drop_n_add(const Vertex &vertex)
+std::vector<double> BaseInterpolator::generate_z_projections(std::size_t num_points, unsigned num_threads) const
 {
-    this->_trajectory.drop_n_add(vertex);
+    return this->generate_projections(&Point::z, num_points, num_threads);
 }
 
-double BaseInterpolator::x_at_position(double position) const
+std::vector<TrajectoryPoint> BaseInterpolator::generate_points(std::size_t num_points, unsigned num_threads) const
 {
-    return this->projection_at_position(&BaseInterpolator::calculate_delta_x_projection, position);
+    return this->generate_points(this->generate_grid(num_points), num_threads);
 }
 
-double BaseInterpolator::y_at_position(double position) const
+std::vector<TrajectoryPoint> BaseInterpolator::generate_points(const PositionGrid &grid, unsigned num_threads) const
 {
-    return this->projection_at_position(&BaseInterpolator::calculate_delta_y_projection, position);
+    std::vector<TrajectoryPoint> points(num_threads ? grid.size() : 0);
+    this->generate_blocks(
+        grid, true, true, num_threads,
+        [&points](std::size_t offset, std::span<const Vertex> block_vertices, std::span<const Point> block_points) {
+            for (std::size_t i = 0; i < block_vertices.size(); ++i)
+            {
+                points[offset + i] = {block_vertices[i], block_points[i]};
+            }
+        });
+    return points;
 }
 
-double BaseInterpolator::z_at_position(double position) const
+void BaseInterpolator::generate_chunks(
+    std::size_t num_points, std::size_t chunk_size, const ChunkConsumer &consumer, unsigned num_threads,
+    bool prefetch) const
 {
-    return this->projection_at_position(&BaseInterpolator::calculate_delta_z_projection, position);
+    this->generate_chunks(this->generate_grid(num_points), chunk_size, consumer, num_threads, prefetch);
 }
 
-std::vector<Vertex> BaseInterpolator::generate_vertices(std::size_t num_vertices, unsigned num_threads) const
+void BaseInterpolator::generate_chunks(
+    const PositionGrid &grid, std::size_t chunk_size, const ChunkConsumer &consumer, unsigned num_threads,
+    bool prefetch) const
 {
-    if (num_vertices < _trajectory.vertices().size())
+    if (!chunk_size)
     {
-        return _trajectory.vertices_python();
+        throw std::invalid_argument("generate_chunks: the chunk size must be positive");
+    }
+    if (grid.empty() || !num_threads)
+    {
+        return;
     }
 
-    std::vector<double> positions = this->generate_positions(num_vertices);
-    return utils::Multithreading::run<Vertex>(
-        positions.begin(), positions.end(), num_threads, [this](double pos) { return this->vertex_at_position(pos); });
+    struct Chunk
+    {
+        std::size_t offset = 0;
+        std::vector<double> positions;
+        std::vector<Vertex> vertices;
+        std::vector<Point> points;
+    };
+
+    // only the positions of the chunk are computed, so the points are the same of generate_points
+    auto const num_points = grid.size();
+    std::size_t next_offset = 0;
+
+    auto const fill = [&, this](Chunk &chunk) {
+        auto const size = std::min(chunk_size, num_points - next_offset);
+        chunk.offset = next_offset;
+        chunk.positions.resize(size);
+        chunk.vertices.resize(size);
+        chunk.points.resize(size);
+        grid.fill(next_offset, chunk.positions);
+        next_offset += size;
+
+        this->evaluate(chunk.positions, chunk.vertices, chunk.points, num_threads);
+    };
+
+    Chunk chunks[2];
+    fill(chunks[0]);
+    for (std::size_t current = 0;; current ^= 1)
+    {
+        auto const has_next = next_offset < num_points;
+
+        // the task must finish before the chunks go out of scope, which AsyncTask guarantees
+        utils::AsyncTask next_chunk;
+        if (has_next && prefetch)
+        {
+            next_chunk =
+                utils::ThreadPool::instance().async([&fill, &chunks, current]() { fill(chunks[current ^ 1]); });
+        }
+
+        auto const &chunk = chunks[current];
+        consumer(chunk.offset, chunk.vertices, chunk.points);
+
+        if (!has_next)
+        {
+            break;
+        }
+        else if (prefetch)
+        {
+            next_chunk.wait();
+        }
+        else
+        {
+            fill(chunks[current ^ 1]);
+        }
+    }
 }
 
-std::vector<double> BaseInterpolator::generate_x_projections(std::size_t num_points, unsigned num_threads) const
+void BaseInterpolator::evaluate(
+    std::span<const double> positions, std::span<Vertex> vertices, std::span<Point> points,
+    unsigned num_threads) const
 {
-    std::vector<double> positions = this->generate_positions(num_points);
-    return utils::Multithreading::run<double>(
-        positions.begin(), positions.end(), num_threads, [this](double pos) { return this->x_at_position(pos); });
+    if ((!vertices.empty() && vertices.size() != positions.size()) ||
+        (!points.empty() && points.size() != positions.size()))
+    {
+        throw std::invalid_argument("evaluate: the outputs must be empty or have the same size of positions");
+    }
+
+    utils::Multithreading::run_chunks(
+        positions.size(), num_threads,
+        [this, &positions, &vertices, &points](std::size_t chunk_first, std::size_t chunk_last) {
+            auto const size = chunk_last - chunk_first;
+            std::size_t upper_index = 0;
+            this->evaluate_sequence(
+                positions.subspan(chunk_first, size), vertices.empty() ? vertices : vertices.subspan(chunk_first, size),
+                points.empty() ? points : points.subspan(chunk_first, size), upper_index);
+        });
 }
 
-std::vector<double> BaseInterpolator::generate_y_projections(std::size_t num_points, unsigned num_threads) const
+std::vector<TrajectoryPoint> BaseInterpolator::generate_adaptive_points(
+    double max_chord_deviation, double max_angle, unsigned num_threads) const
 {
-    std::vector<double> positions = this->generate_positions(num_points);
-    return utils::Multithreading::run<double>(
-        positions.begin(), positions.end(), num_threads, [this](double pos) { return this->y_at_position(pos); });
+    if (!(max_chord_deviation > 0.0) || !(max_angle > 0.0))
+    {
+        throw std::invalid_argument("generate_adaptive_points: the tolerances must be positive");
+    }
+    if (this->_trajectory.empty() || !num_threads)
+    {
+        return {};
+    }
+
+    // the points of every chunk of segments, in the chunk order
+    auto const num_segments = this->_trajectory.size() - 1;
+    auto const num_chunks = utils::Multithreading::num_chunks(num_segments, num_threads);
+    auto const chunk_size = num_chunks ? num_segments / num_chunks : 0;
+    std::vector<std::vector<TrajectoryPoint>> chunk_points(num_chunks);
+    utils::Multithreading::run_chunks(
+        num_segments, num_threads, [&, this](std::size_t chunk_first, std::size_t chunk_last) {
+            auto &points = chunk_points[chunk_first / chunk_size];
+
+            // the stations are the points of point_at_position, so a segment ends where the next one starts
+            auto first = this->point_at_position(this->_trajectory[chunk_first].position(), chunk_first + 1);
+            for (auto i = chunk_first; i < chunk_last; ++i)
+            {
+                auto const first_position = first.vertex.position();
+                auto const last_position = this->_trajectory[i + 1].position();
+                auto const last = this->point_at_position(last_position);
+                this->tessellate(
+                    first, this->point_at_position((first_position + last_position) / 2.0, i + 1), last, i + 1,
+                    max_chord_deviation, max_angle, 0, points);
+                first = last;
+            }
+        });
+
+    std::size_t num_points = 1;
+    for (auto const &points : chunk_points)
+    {
+        num_points += points.size();
+    }
+
+    std::vector<TrajectoryPoint> points;
+    points.reserve(num_points);
+    for (auto const &chunk : chunk_points)
+    {
+        points.insert(points.end(), chunk.begin(), chunk.end());
+    }
+    points.push_back(this->point_at_position(this->_trajectory.back().position()));
+    return points;
 }
 
-std::vector<double> BaseInterpolator::generate_z_projections(std::size_t num_points, unsigned num_threads) const
+IntervalAggregates BaseInterpolator::interval_aggregates(double first_position, double last_position) const
+{
+    if (this->_trajectory.empty())
+    {
+        throw std::invalid_argument("interval_aggregates: the trajectory is empty");
+    }
+
+    if (first_position > last_position)
+    {
+        throw std::invalid_argument("interval_aggregates: the first position must not be greater than the last one");
+    }
+
+    auto const positions = this->_trajectory.positions_view();
+    first_position = std::clamp(first_position, positions.front(), positions.back());
+    last_position = std::clamp(last_position, positions.front(), positions.back());
+
+    // the segments [first_segment, last_vertex) are inside the range
+    auto const first_segment = static_cast<std::size_t>(
+        std::lower_bound(positions.begin(), positions.end(), first_position) - positions.begin());
+    auto const last_vertex = this->_trajectory.upper_bound_index(last_position) - 1;
+
+    IntervalAggregates aggregates;
+    if (first_segment < last_vertex)
+    {
+        aggregates = translate(
+            this->_segment_aggregates.accumulate(first_segment, last_vertex), this->_projections_offset);
+    }
+
+    // the parts of the segments at the ends of the range
+    auto const aggregate_part = [&aggregates, this](double first_position, double last_position) {
+        auto const upper_index = this->_trajectory.upper_bound_index(first_position);
+        auto const part = this->calculate_interval_aggregates(
+            this->point_at_position(first_position, upper_index),
+            this->point_at_position(last_position, this->calculate_upper_index(last_position, upper_index)),
+            upper_index);
+        aggregates = MergeIntervalAggregates()(aggregates, part);
+    };
+
+    if (first_segment > last_vertex)
+    {
+        aggregate_part(first_position, last_position);
+        return aggregates;
+    }
+
+    if (first_position < positions[first_segment])
+    {
+        aggregate_part(first_position, positions[first_segment]);
+    }
+    if (last_position > positions[last_vertex])
+    {
+        aggregate_part(positions[last_vertex], last_position);
+    }
+
+    // a range on a single vertex
+    if (aggregates.upper.x < aggregates.lower.x)
+    {
+        include(aggregates, this->point_at_position(first_position).point);
+    }
+    return aggregates;
+}
+
+std::size_t BaseInterpolator::calculate_batch_size(std::span<const double> positions, std::size_t upper_index) const
+{
+    auto const trajectory_positions = this->_trajectory.positions_view();
+    if (upper_index == 0 || upper_index >= trajectory_positions.size())
+    {
+        return 0;
+    }
+
+    // the boundary conditions of vertex_at_position and calculate_projection_index
+    auto const first = trajectory_positions[upper_index - 1];
+    auto const last = trajectory_positions[upper_index];
+    auto const back = trajectory_positions.back();
+    auto const is_inside = [first, last, back](double position) {
+        return position < last && position - first > std::numeric_limits<double>::epsilon() &&
+               back - position >= std::numeric_limits<double>::epsilon();
+    };
+
+    std::size_t size = 0;
+    while (size < positions.size() && is_inside(positions[size]))
+    {
+        ++size;
+    }
+    return size;
+}
+
+std::vector<double> BaseInterpolator::generate_projections(
+    double Point::*axis, std::size_t num_points, unsigned num_threads) const
 {
-    std::vector<double> positions = this->generate_positions(num_points);
-    return utils::Multithreading::run<double>(
-        positions.begin(), positions.end(), num_threads, [this](double pos) { return this->z_at_position(pos); });
+    auto const grid = this->generate_grid(num_points);
+    std::vector<double> projections(num_threads ? grid.size() : 0);
+    this->generate_blocks(
+        grid, false, true, num_threads,
+        [&projections, axis](std::size_t offset, std::span<const Vertex>, std::span<const Point> block_points) {
+            for (std::size_t i = 0; i < block_points.size(); ++i)
+            {
+                projections[offset + i] = block_points[i].*axis;
+            }
+        });
+    return projections;
 }
 
-std::vector<double> BaseInterpolator::generate_positions(std::size_t num_positions) const
+template <typename BlockHandler>
+void BaseInterpolator::generate_blocks(
+    const PositionGrid &grid, bool with_vertices, bool with_points, unsigned num_threads,
+    const BlockHandler &handler) const
 {
-    double first_trajectory_position = _trajectory.cbegin()->position();
-    double last_trajectory_position = std::prev(_trajectory.cend())->position();
-    double trajectory_length = last_trajectory_position - first_trajectory_position;
-    double increment = trajectory_length / static_cast<double>(num_positions);
+    utils::Multithreading::run_chunks(
+        num_threads ? grid.size() : 0, num_threads, [&, this](std::size_t chunk_first, std::size_t chunk_last) {
+            double block_positions[utils::BatchKernels::block_size];
+            Vertex block_vertices[utils::BatchKernels::block_size];
+            Point block_points[utils::BatchKernels::block_size];
+
+            std::size_t upper_index = 0;
+            for (auto first = chunk_first; first < chunk_last; first += utils::BatchKernels::block_size)
+            {
+                auto const size = std::min(utils::BatchKernels::block_size, chunk_last - first);
+                auto const positions = std::span(block_positions, size);
+                auto const vertices = with_vertices ? std::span(block_vertices, size) : std::span<Vertex>();
+                auto const points = with_points ? std::span(block_points, size) : std::span<Point>();
+
+                grid.fill(first, positions);
+                this->evaluate_sequence(positions, vertices, points, upper_index);
+                handler(first, std::span<const Vertex>(vertices), std::span<const Point>(points));
+            }
+        });
+}
 
-    std::vector<double> positions(num_positions);
-    positions[0] = first_trajectory_position;
-    for (std::size_t i = 1; i < positions.size(); ++i)
+PositionGrid BaseInterpolator::generate_grid(std::size_t num_positions) const
+{
+    if (!num_positions)
     {
-        positions[i] = positions[i - 1] + increment;
+        return PositionGrid::uniform(0.0, 0.0, 0);
     }
 
-    double &last_position = positions[positions.size() - 1];
-    if (last_position > last_trajectory_position)
+    auto const positions = this->_trajectory.positions_view();
+    return PositionGrid::uniform(
+        positions.front(), (positions.back() - positions.front()) / static_cast<double>(num_positions), num_positions);
+}
+
+void BaseInterpolator::update_segments()
+{
+}
+
+void BaseInterpolator::update_segments(std::size_t /*vertex_index*/, VertexChange /*vertex_change*/)
+{
+    this->update_segments();
+}
+
+void BaseInterpolator::update_cumulative_projections()
+{
+    this->update_segments();
+
+    this->_projections_offset = {};
+    this->_cumulative_projections.clear();
+    this->reserve_table(this->_cumulative_projections);
+
+    auto previous_vertex = Vertex{0.0, 0.0, 0.0};
+    auto projection = Point{};
+    std::size_t index = 0;
+    for (auto const &vertex : this->_trajectory)
     {
-        last_position = last_trajectory_position;
+        auto const delta_projections =
+            this->calculate_delta_projections(vertex.position(), AdjacentVertices{previous_vertex, vertex}, index++);
+        projection.x += delta_projections.x;
+        projection.y += delta_projections.y;
+        projection.z += delta_projections.z;
+
+        this->_cumulative_projections.push_back(projection);
+        previous_vertex = vertex;
     }
 
-    return positions;
+    this->update_interval_aggregates();
 }
 
-double BaseInterpolator::projection_at_position(DeltaCalculator delta_calculator, double position) const
+void BaseInterpolator::update_cumulative_projections(std::size_t vertex_index, VertexChange vertex_change)
 {
+    this->update_segments(vertex_index, vertex_change);
 
-    auto sum_delta = 0.0;
-    for (auto it_v = this->_trajectory.vertices().begin(); it_v != this->_trajectory.vertices().end(); ++it_v)
+    auto &table = this->_cumulative_projections;
+    if (this->_trajectory.empty())
     {
-        if (it_v->position() > position || fabs(position - it_v->position()) < std::numeric_limits<double>::epsilon())
+        table.clear();
+        this->_projections_offset = {};
+        this->_segment_aggregates.clear();
+        return;
+    }
+
+    // the vertex which follows the changed one accumulates from a new previous vertex: its accumulated projections,
+    // and so the ones of every vertex beyond it, change by the same amount
+    auto const calculate_shift = [this](const Point &previous_projection, std::size_t index, std::size_t old_index) {
+        auto const delta_projections = this->calculate_vertex_delta_projections(index);
+        auto const old_projection = this->cumulative_projection(old_index);
+        return Point{
+            previous_projection.x + delta_projections.x - old_projection.x,
+            previous_projection.y + delta_projections.y - old_projection.y,
+            previous_projection.z + delta_projections.z - old_projection.z};
+    };
+    auto const shift_table = [&table](std::size_t first, const Point &shift) {
+        for (auto it = table.begin() + first; it != table.end(); ++it)
         {
-            auto const &adjacent_vertices = AdjacentVertices{
-                it_v != this->_trajectory.vertices().begin() ? *std::prev(it_v) : Vertex{0.0, 0.0, 0.0},
-                this->vertex_at_position(position)};
+            it->x += shift.x;
+            it->y += shift.y;
+            it->z += shift.z;
+        }
+    };
 
-            sum_delta += std::invoke(delta_calculator, *this, adjacent_vertices.second.position(), adjacent_vertices);
+    // the shift of the table entries beyond the change, which the segment aggregates follow
+    auto table_shift = Point{};
+    auto const previous_projection = vertex_index ? this->cumulative_projection(vertex_index - 1) : Point{};
+    if (vertex_change == VertexChange::insertion)
+    {
+        auto const delta_projections = this->calculate_vertex_delta_projections(vertex_index);
+        auto const projection = Point{
+            previous_projection.x + delta_projections.x, previous_projection.y + delta_projections.y,
+            previous_projection.z + delta_projections.z};
 
-            break;
+        if (vertex_index + 1 < this->_trajectory.size())
+        {
+            // the following vertex still has the table entry vertex_index
+            table_shift = calculate_shift(projection, vertex_index + 1, vertex_index);
+            shift_table(vertex_index, table_shift);
         }
 
-        auto const &adjacent_vertices = AdjacentVertices{
-            it_v != this->_trajectory.vertices().begin() ? *std::prev(it_v) : Vertex{0.0, 0.0, 0.0}, *it_v};
-        sum_delta += std::invoke(delta_calculator, *this, it_v->position(), adjacent_vertices);
+        auto const &offset = this->_projections_offset;
+        table.insert(
+            table.begin() + vertex_index,
+            Point{projection.x - offset.x, projection.y - offset.y, projection.z - offset.z});
+    }
+    else if (vertex_index == this->_trajectory.size())
+    {
+        // the last vertex does not take part in the accumulation up to the others
+        table.pop_back();
     }
+    else
+    {
+        // the following vertex still has the table entry vertex_index + 1
+        auto const shift = calculate_shift(previous_projection, vertex_index, vertex_index + 1);
+        if (vertex_index)
+        {
+            table_shift = shift;
+            shift_table(vertex_index + 1, shift);
+        }
+        else
+        {
+            // every remaining vertex is beyond the first one: the offset is shifted instead of the whole table
+            this->_projections_offset.x += shift.x;
+            this->_projections_offset.y += shift.y;
+            this->_projections_offset.z += shift.z;
+        }
+        table.erase(table.begin() + vertex_index);
+    }
+
+    this->update_interval_aggregates(vertex_index, vertex_change, table_shift);
+}
+
+void BaseInterpolator::update_interval_aggregates()
+{
+    auto const num_segments = this->_trajectory.size() > 1 ? this->_trajectory.size() - 1 : 0;
+
+    // a trajectory window slides without allocation (@see reserve_table)
+    this->_segment_aggregates.reserve(this->_trajectory.capacity());
+    this->_segment_aggregates.generate(
+        num_segments, [this](std::size_t index) { return this->calculate_segment_aggregates(index); });
+}
+
+void BaseInterpolator::update_interval_aggregates(
+    std::size_t vertex_index, VertexChange vertex_change, const Point &shift)
+{
+    auto &segments = this->_segment_aggregates;
+    auto const num_vertices = this->_trajectory.size();
+    if (num_vertices < 2)
+    {
+        segments.clear();
+        return;
+    }
+
+    // the same entries of update_segment_table. At the ends of the trajectory the tree costs O(log n)
+    if (vertex_change == VertexChange::insertion)
+    {
+        segments.insert(std::min(vertex_index, num_vertices - 2), IntervalAggregates{});
+    }
+    else
+    {
+        segments.erase(std::min(vertex_index, num_vertices - 1));
+    }
+
+    auto const first = vertex_index ? vertex_index - 1 : 0;
+    auto const last =
+        std::min(vertex_change == VertexChange::insertion ? vertex_index + 1 : vertex_index, num_vertices - 1);
+    if (shift.x != 0.0 || shift.y != 0.0 || shift.z != 0.0)
+    {
+        segments.transform(last, num_vertices - 1, [&shift](const IntervalAggregates &aggregates) {
+            return translate(aggregates, shift);
+        });
+    }
+
+    for (auto i = first; i < last; ++i)
+    {
+        segments.set(i, this->calculate_segment_aggregates(i));
+    }
+}
+
+Point BaseInterpolator::calculate_vertex_delta_projections(std::size_t index) const
+{
+    auto const vertex = this->_trajectory[index];
+    return this->calculate_delta_projections(
+        vertex.position(), AdjacentVertices{index ? this->_trajectory[index - 1] : Vertex{0.0, 0.0, 0.0}, vertex},
+        index);
+}
 
-    return sum_delta;
+void BaseInterpolator::tessellate(
+    const TrajectoryPoint &first, const TrajectoryPoint &middle, const TrajectoryPoint &last, std::size_t upper_index,
+    double max_chord_deviation, double max_angle, std::size_t depth, std::vector<TrajectoryPoint> &points) const
+{
+    auto const middle_position = middle.vertex.position();
+    auto const first_quarter = this->point_at_position((first.vertex.position() + middle_position) / 2.0, upper_index);
+    auto const last_quarter = this->point_at_position((middle_position + last.vertex.position()) / 2.0, upper_index);
+
+    // the turn is measured through the middle, so a tangent which turns and comes back is not missed
+    auto const middle_tangent = tangent(middle.vertex);
+    auto const turn = angle_between(tangent(first.vertex), middle_tangent) +
+                      angle_between(middle_tangent, tangent(last.vertex));
+    auto const deviation = std::max(
+        {chord_distance(first.point, last.point, first_quarter.point),
+         chord_distance(first.point, last.point, middle.point),
+         chord_distance(first.point, last.point, last_quarter.point)});
+
+    // a chord much longer than its part crosses a jump of the interpolation (e.g. the cubic one at a station), which
+    // halving does not bring nearer
+    auto const chord = Point{last.point.x - first.point.x, last.point.y - first.point.y, last.point.z - first.point.z};
+    auto const chord_length = std::sqrt(chord.x * chord.x + chord.y * chord.y + chord.z * chord.z);
+    auto const is_jump = chord_length > 4.0 * (last.vertex.position() - first.vertex.position()) + max_chord_deviation;
+
+    if (depth == max_tessellation_depth || is_jump || (deviation <= max_chord_deviation && turn <= max_angle))
+    {
+        points.push_back(first);
+        return;
+    }
+
+    this->tessellate(first, first_quarter, middle, upper_index, max_chord_deviation, max_angle, depth + 1, points);
+    this->tessellate(middle, last_quarter, last, upper_index, max_chord_deviation, max_angle, depth + 1, points);
+}
+
+IntervalAggregates BaseInterpolator::calculate_interval_aggregates(
+    const TrajectoryPoint &first, const TrajectoryPoint &last, std::size_t upper_index) const
+{
+    IntervalAggregates aggregates;
+    include(aggregates, first.point);
+    include(aggregates, last.point);
+
+    auto const first_position = first.vertex.position();
+    auto const delta_s = last.vertex.position() - first_position;
+    if (!(delta_s > 0.0))
+    {
+        return aggregates;
+    }
+
+    auto const point_at = [upper_index, this](double position) {
+        return this->point_at_position(position, this->calculate_upper_index(position, upper_index));
+    };
+
+    auto const dogleg = angle_between(tangent(first.vertex), tangent(last.vertex));
+    aggregates.max_dogleg = dogleg;
+    aggregates.max_dogleg_severity = dogleg / delta_s;
+
+    // the extremum of a projection inside [a, b], sign 1 for the maximum and -1 for the minimum
+    auto const search_extremum = [&point_at](double a, double b, double Point::*axis, double sign) {
+        static constexpr double golden_ratio = 0.3819660112501051;
+        auto const value_at = [&point_at, axis, sign](double position) {
+            return sign * point_at(position).point.*axis;
+        };
+
+        auto const tolerance = std::sqrt(std::numeric_limits<double>::epsilon()) * std::fabs(b) + 1E-10;
+        auto c = a + golden_ratio * (b - a);
+        auto d = b - golden_ratio * (b - a);
+        auto value_c = value_at(c);
+        auto value_d = value_at(d);
+        while (b - a > tolerance)
+        {
+            if (value_c > value_d)
+            {
+                b = d;
+                d = c;
+                value_d = value_c;
+                c = a + golden_ratio * (b - a);
+                value_c = value_at(c);
+            }
+            else
+            {
+                a = c;
+                c = d;
+                value_c = value_d;
+                d = b - golden_ratio * (b - a);
+                value_d = value_at(d);
+            }
+        }
+        return sign * std::max(value_c, value_d);
+    };
+
+    // every piece bends little, so a projection has at most one extremum inside it. The linear and cubic angles may
+    // sweep more than the dogleg between the ends, e.g. an azimuth turning the long way round
+    static constexpr double max_piece_dogleg = M_PI / 16.0;
+    auto const sweep = std::max(
+        dogleg, std::fabs(last.vertex.inclination() - first.vertex.inclination()) +
+                    std::fabs(last.vertex.azimuth() - first.vertex.azimuth()));
+    auto const num_pieces = static_cast<std::size_t>(std::max(1.0, std::ceil(sweep / max_piece_dogleg)));
+
+    // the ends and the midpoint of every piece, in order: a sample beyond both of its neighbours brackets an extremum
+    // between them
+    auto previous = first;
+    auto current = point_at(first_position + delta_s / (2 * num_pieces));
+    for (std::size_t i = 2; i <= 2 * num_pieces; ++i)
+    {
+        auto const next = i == 2 * num_pieces ? last : point_at(first_position + delta_s * i / (2 * num_pieces));
+        include(aggregates, current.point);
+
+        auto const a = previous.vertex.position();
+        auto const b = next.vertex.position();
+        for (auto axis : {&Point::x, &Point::y, &Point::z})
+        {
+            auto const value = current.point.*axis;
+            if (value >= std::max(previous.point.*axis, next.point.*axis))
+            {
+                aggregates.upper.*axis = std::max(aggregates.upper.*axis, search_extremum(a, b, axis, 1.0));
+            }
+            if (value <= std::min(previous.point.*axis, next.point.*axis))
+            {
+                aggregates.lower.*axis = std::min(aggregates.lower.*axis, search_extremum(a, b, axis, -1.0));
+            }
+        }
+        previous = current;
+        current = next;
+    }
+    return aggregates;
+}
+
+IntervalAggregates BaseInterpolator::calculate_segment_aggregates(std::size_t index) const
+{
+    auto const &offset = this->_projections_offset;
+    auto const aggregates = this->calculate_interval_aggregates(
+        {this->_trajectory[index], this->cumulative_projection(index)},
+        {this->_trajectory[index + 1], this->cumulative_projection(index + 1)}, index + 1);
+    return translate(aggregates, {-offset.x, -offset.y, -offset.z});
+}
+
+IntervalAggregates BaseInterpolator::MergeIntervalAggregates::operator()(
+    const IntervalAggregates &lhs, const IntervalAggregates &rhs) const
+{
+    auto merged = lhs;
+    for (auto axis : {&Point::x, &Point::y, &Point::z})
+    {
+        merged.lower.*axis = std::min(lhs.lower.*axis, rhs.lower.*axis);
+        merged.upper.*axis = std::max(lhs.upper.*axis, rhs.upper.*axis);
+    }
+    merged.max_dogleg = std::max(lhs.max_dogleg, rhs.max_dogleg);
+    merged.max_dogleg_severity = std::max(lhs.max_dogleg_severity, rhs.max_dogleg_severity);
+    return merged;
 }
 
 } // namespace splines
@@ -0,0 +1,235 @@
+#include "interpolator/utils/BatchKernels.hpp"
+#include "interpolator/utils/VectorMath.hpp"
+
+#include <limits>
+
+namespace splines::utils
+{
+
+namespace
+{
+
+constexpr double epsilon = std::numeric_limits<double>::epsilon();
+
+// the loops below are vectorised: they must stay free of branches (only selects) and of libm calls. The arrays are
+// restrict parameters, so the compiler knows they do not overlap, and the segment flags are template parameters, since
+// selects on loop invariant conditions are not vectorised. They are inlined into every clone of the public kernels
+
+template <bool with_points>
+SPLINES_ALWAYS_INLINE void cubic_loop(
+    const BatchKernels::Cubic &segment, std::size_t size, const double *__restrict position,
+    double *__restrict inclinations, double *__restrict azimuths, double *__restrict x, double *__restrict y,
+    double *__restrict z)
+{
+    // the segment values are copied, so they are not reloaded after every store
+    auto const position_1 = segment.position;
+    auto const delta_s = segment.delta_s;
+    auto const cx0 = segment.x[0], cx1 = segment.x[1], cx2 = segment.x[2], cx3 = segment.x[3];
+    auto const cz0 = segment.z[0], cz1 = segment.z[1], cz2 = segment.z[2], cz3 = segment.z[3];
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        auto const delta_s_star = position[i] - position_1;
+        auto const ep = delta_s_star / delta_s;
+        auto const delta_x = ((cx3 * ep + cx2) * ep + cx1) * ep + cx0;
+        auto const delta_z = ((cz3 * ep + cz2) * ep + cz1) * ep + cz0;
+
+        // sin(acos(delta_z)) and, for the projections, cos(acos(delta_x / sin_inc_star)) without trigonometry. The
+        // inclination is atan2(sin_inc_star, delta_z), which is cheaper than acos(delta_z) once sin_inc_star is known
+        auto const sin_inc_star = std::sqrt((1.0 - delta_z) * (1.0 + delta_z));
+        auto const inc_star = VectorMath::atan2(sin_inc_star, delta_z);
+        auto const azimuth_defined = sin_inc_star >= epsilon && inc_star >= epsilon;
+        auto const cos_azm_star = delta_x / sin_inc_star;
+
+        inclinations[i] = inc_star;
+        azimuths[i] = azimuth_defined ? VectorMath::acos(cos_azm_star) : 0.0;
+
+        if constexpr (with_points)
+        {
+            auto const cos_azm = azimuth_defined ? cos_azm_star : 1.0;
+            auto const sin_azm = azimuth_defined ? std::sqrt((1.0 - cos_azm_star) * (1.0 + cos_azm_star)) : 0.0;
+            x[i] = sin_inc_star * cos_azm * delta_s_star;
+            y[i] = sin_inc_star * sin_azm * delta_s_star;
+            z[i] = delta_z * delta_s_star;
+        }
+    }
+}
+
+template <bool with_points, bool azimuth_interpolated>
+SPLINES_ALWAYS_INLINE void minimum_curvature_loop(
+    const BatchKernels::MinimumCurvature &segment, std::size_t size, const double *__restrict position,
+    double *__restrict inclinations, double *__restrict azimuths, double *__restrict x, double *__restrict y,
+    double *__restrict z)
+{
+    // the segment values are copied, so they are not reloaded after every store
+    auto const position_1 = segment.position;
+    auto const delta_s = segment.delta_s;
+    auto const alpha = segment.alpha;
+    auto const d1 = segment.direction_1;
+    auto const d2 = segment.direction_2;
+    auto const azimuth = segment.azimuth;
+    auto const sin_azimuth = segment.sin_azimuth;
+    auto const cos_azimuth = segment.cos_azimuth;
+
+    // the tangent at the position (spherical linear interpolation), scaled by sin(alpha), is
+    // sin((1 - weight) alpha) d1 + sin(weight alpha) d2
+    //     = sin(alpha / 2) cos(h) (d1 + d2) + cos(alpha / 2) sin(h) (d2 - d1)
+    // with h = (weight - 1 / 2) alpha, so a single sincos is computed per position
+    auto const sin_half_alpha = std::sin(alpha / 2.0);
+    auto const cos_half_alpha = std::cos(alpha / 2.0);
+    auto const sum =
+        Point{sin_half_alpha * (d1.x + d2.x), sin_half_alpha * (d1.y + d2.y), sin_half_alpha * (d1.z + d2.z)};
+    auto const difference =
+        Point{cos_half_alpha * (d2.x - d1.x), cos_half_alpha * (d2.y - d1.y), cos_half_alpha * (d2.z - d1.z)};
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        auto const delta_s_star = position[i] - position_1;
+        auto ds_star = delta_s_star > delta_s ? delta_s - epsilon : delta_s_star;
+        ds_star = ds_star < epsilon ? epsilon : ds_star;
+
+        auto const weight = ds_star / delta_s;
+        auto const [sin_h, cos_h] = VectorMath::sincos((weight - 0.5) * alpha);
+        auto const tangent_x = sum.x * cos_h + difference.x * sin_h;
+        auto const tangent_y = sum.y * cos_h + difference.y * sin_h;
+        auto const tangent_z = sum.z * cos_h + difference.z * sin_h;
+        auto const rho = std::sqrt(tangent_x * tangent_x + tangent_y * tangent_y);
+
+        auto const inc_star = VectorMath::atan2(rho, tangent_z);
+        auto azm_star = VectorMath::atan2(tangent_y, tangent_x);
+        azm_star = azm_star < 0 ? (azm_star + M_PI * 2) : azm_star;
+
+        inclinations[i] = inc_star;
+        azimuths[i] = azimuth_interpolated ? azm_star : azimuth;
+
+        if constexpr (with_points)
+        {
+            // the unit tangent of the interpolated vertex, as calculate_delta_projections gets it from its angles
+            auto const norm = std::sqrt(rho * rho + tangent_z * tangent_z);
+            auto const sin_inc = rho / norm;
+            auto const cos_inc_star = tangent_z / norm;
+            auto const cos_azm = azimuth_interpolated ? (rho > 0.0 ? tangent_x / rho : 1.0) : cos_azimuth;
+            auto const sin_azm = azimuth_interpolated ? (rho > 0.0 ? tangent_y / rho : 0.0) : sin_azimuth;
+            auto const d_star = Point{sin_inc * cos_azm, sin_inc * sin_azm, cos_inc_star};
+
+            // the interpolated vertex lies on the segment arc: its dogleg from the first vertex is alpha weighted by
+            // the distance, as in MinimumCurvatureInterpolator::calculate_common_delta_projection
+            auto alpha_star = alpha * (delta_s_star / delta_s);
+            alpha_star = alpha_star > epsilon ? alpha_star : epsilon;
+            auto const [sin_half_alpha_star, cos_half_alpha_star] = VectorMath::sincos(alpha_star / 2.0);
+            auto const factor_f = (2.0 / alpha_star) * (sin_half_alpha_star / cos_half_alpha_star);
+
+            x[i] = (delta_s_star / 2.0) * (d_star.x + d1.x) * factor_f;
+            y[i] = (delta_s_star / 2.0) * (d_star.y + d1.y) * factor_f;
+            z[i] = (delta_s_star / 2.0) * (d_star.z + d1.z) * factor_f;
+        }
+    }
+}
+
+template <bool with_points, bool azimuth_interpolated>
+SPLINES_ALWAYS_INLINE void linear_loop(
+    const BatchKernels::Linear &segment, std::size_t size, const double *__restrict position,
+    double *__restrict inclinations, double *__restrict azimuths, double *__restrict x, double *__restrict y,
+    double *__restrict z)
+{
+
+    // the segment values are copied, so they are not reloaded after every store
+    auto const position_1 = segment.position_1;
+    auto const position_2 = segment.position_2;
+    auto const inc_1 = segment.inclination_1;
+    auto const inc_2 = segment.inclination_2;
+    auto const azm_1 = segment.azimuth_1;
+    auto const azm_2 = segment.azimuth_2;
+    auto const delta_p = position_2 - position_1;
+    auto const linear_spline = [=](double angle_1, double angle_2, double position) {
+        auto const res = (angle_1 * (position_2 - position) + angle_2 * (position - position_1)) / delta_p;
+
+        // the same of fmod(res, 2 pi) for res in [0, 4 pi): the subtraction is exact
+        return res >= M_PI * 2.0 ? res - M_PI * 2.0 : res;
+    };
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        auto const inc_star = linear_spline(inc_1, inc_2, position[i]);
+        auto const azm_star = azimuth_interpolated ? linear_spline(azm_1, azm_2, position[i]) : azm_2;
+
+        inclinations[i] = inc_star;
+        azimuths[i] = azm_star;
+
+        if constexpr (with_points)
+        {
+            auto const delta_s = position[i] - position_1;
+            auto const sin_inc = VectorMath::sin(inc_star);
+            x[i] = delta_s * sin_inc * VectorMath::cos(azm_star);
+            y[i] = delta_s * sin_inc * VectorMath::sin(azm_star);
+            z[i] = delta_s * VectorMath::cos(inc_star);
+        }
+    }
+}
+
+} // namespace
+
+SPLINES_TARGET_CLONES
+void BatchKernels::cubic(const Cubic &segment, std::span<const double> positions, const BatchOutput &output)
+{
+    auto const &[inclinations, azimuths, x, y, z] = output;
+    if (x)
+    {
+        cubic_loop<true>(segment, positions.size(), positions.data(), inclinations, azimuths, x, y, z);
+    }
+    else
+    {
+        cubic_loop<false>(segment, positions.size(), positions.data(), inclinations, azimuths, x, y, z);
+    }
+}
+
+SPLINES_TARGET_CLONES
+void BatchKernels::minimum_curvature(
+    const MinimumCurvature &segment, std::span<const double> positions, const BatchOutput &output)
+{
+    auto const &[inclinations, azimuths, x, y, z] = output;
+    auto const size = positions.size();
+    auto const *const position = positions.data();
+
+    switch ((x ? 2 : 0) | (segment.azimuth_interpolated ? 1 : 0))
+    {
+    case 0:
+        minimum_curvature_loop<false, false>(segment, size, position, inclinations, azimuths, x, y, z);
+        break;
+    case 1:
+        minimum_curvature_loop<false, true>(segment, size, position, inclinations, azimuths, x, y, z);
+        break;
+    case 2:
+        minimum_curvature_loop<true, false>(segment, size, position, inclinations, azimuths, x, y, z);
+        break;
+    default:
+        minimum_curvature_loop<true, true>(segment, size, position, inclinations, azimuths, x, y, z);
+        break;
+    }
+}
+
+SPLINES_TARGET_CLONES
+void BatchKernels::linear(const Linear &segment, std::span<const double> positions, const BatchOutput &output)
+{
+    auto const &[inclinations, azimuths, x, y, z] = output;
+    auto const size = positions.size();
+    auto const *const position = positions.data();
+
+    switch ((x ? 2 : 0) | (segment.azimuth_interpolated ? 1 : 0))
+    {
+    case 0:
+        linear_loop<false, false>(segment, size, position, inclinations, azimuths, x, y, z);
+        break;
+    case 1:
+        linear_loop<false, true>(segment, size, position, inclinations, azimuths, x, y, z);
+        break;
+    case 2:
+        linear_loop<true, false>(segment, size, position, inclinations, azimuths, x, y, z);
+        break;
+    default:
+        linear_loop<true, true>(segment, size, position, inclinations, azimuths, x, y, z);
+        break;
+    }
+}
+
+} // namespace splines::utils
@@ -1,17 +1,100 @@
 #include "interpolator/CubicInterpolator.hpp"
+#include "interpolator/utils/BatchKernels.hpp"
+
+#include <array>
 
 namespace splines
 {
 
+namespace
+{
+
+/**
+ * @brief polynomial_range
+ * Bounds of coefficients[0] + coefficients[1] ep + coefficients[2] ep^2 + ... for ep in [first, last]. The
+ * polynomial restricted to the range, written in the Bernstein basis, is inside the convex hull of its coefficients
+ *
+ * @return
+ * The lower and the upper bounds
+ */
+template <std::size_t Size>
+std::pair<double, double> polynomial_range(const std::array<double, Size> &coefficients, double first, double last)
+{
+    // the Taylor coefficients at first (shifted by Horner's method), scaled by the range length, are the ones of
+    // the polynomial in t = (ep - first) / (last - first)
+    static constexpr std::size_t degree = Size - 1;
+    auto taylor = coefficients;
+    for (std::size_t i = 0; i < degree; ++i)
+    {
+        for (auto j = degree; j-- > i;)
+        {
+            taylor[j] += first * taylor[j + 1];
+        }
+    }
+    auto scale = 1.0;
+    for (auto &coefficient : taylor)
+    {
+        coefficient *= scale;
+        scale *= last - first;
+    }
+
+    // b_j = sum_k C(j, k) / C(degree, k) taylor_k
+    auto range = std::pair{std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest()};
+    for (std::size_t j = 0; j <= degree; ++j)
+    {
+        auto bernstein = 0.0;
+        auto ratio = 1.0;
+        for (std::size_t k = 0; k <= j; ++k)
+        {
+            bernstein += ratio * taylor[k];
+            if (k < j)
+            {
+                ratio *= static_cast<double>(j - k) / static_cast<double>(degree - k);
+            }
+        }
+        range = {std::min(range.first, bernstein), std::max(range.second, bernstein)};
+    }
+    return range;
+}
+
+/**
+ * @brief polynomial_bound
+ * The maximum absolute value of the polynomial for ep in [first, last] (@see polynomial_range)
+ */
+template <std::size_t Size>
+double polynomial_bound(const std::array<double, Size> &coefficients, double first, double last)
+{
+    auto const [lower, upper] = polynomial_range(coefficients, first, last);
+    return std::max(std::fabs(lower), std::fabs(upper));
+}
+
+/**
+ * @brief derivative
+ * The coefficients of the derivative of the polynomial by ep
+ */
+template <std::size_t Size> std::array<double, Size - 1> derivative(const std::array<double, Size> &coefficients)
+{
+    std::array<double, Size - 1> result{};
+    for (std::size_t k = 1; k < Size; ++k)
+    {
+        result[k - 1] = static_cast<double>(k) * coefficients[k];
+    }
+    return result;
+}
+
+} // namespace
+
 CubicInterpolator::CubicInterpolator(const Vertices &trajectory)
-    : BaseInterpolator(trajectory)
+    : InterpolatorEngine(trajectory)
 {
+    this->update_cumulative_projections();
 }
 
 template <typename Interpolator>
 CubicInterpolator::CubicInterpolator(Interpolator &&other)
     requires std::same_as<Interpolator, CubicInterpolator>
-    : BaseInterpolator(std::forward<Interpolator>(other))
+    : InterpolatorEngine(std::forward<Interpolator>(other))
+    , _polynomials(std::forward<Interpolator>(other)._polynomials)
 {
 }
 
@@ -23,101 +106,191 @@ CubicInterpolator &CubicInterpolator::operator=(Interpolator &&rhs)
     return *this;
 }
 
-double CubicInterpolator::inclination_at_position(double position, const AdjacentVertices &adjacent_vertices) const
+double CubicInterpolator::inclination_at_position(
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t /*upper_index*/) const
 {
     return this->angle_at_position(position, adjacent_vertices, AngleType::inclination);
 }
 
-double CubicInterpolator::azimuth_at_position(double position, const AdjacentVertices &adjacent_vertices) const
+double CubicInterpolator::azimuth_at_position(
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t /*upper_index*/) const
 {
     return this->angle_at_position(position, adjacent_vertices, AngleType::azimuth);
 }
 
 double CubicInterpolator::angle_at_position(
     double position, const AdjacentVertices &adjacent_vertices, BaseInterpolator::AngleType angle_type) const
+{
+    auto const vertex =
+        this->calculate_vertex(position, adjacent_vertices, this->calculate_polynomial(adjacent_vertices));
+    return angle_type == AngleType::inclination ? vertex.inclination() : vertex.azimuth();
+}
+
+Vertex CubicInterpolator::calculate_vertex(
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t segment_index) const
+{
+    return this->calculate_vertex(position, adjacent_vertices, this->_polynomials[segment_index]);
+}
+
+Vertex CubicInterpolator::calculate_vertex(
+    double position, const AdjacentVertices &adjacent_vertices, const Polynomial &polynomial) const
 {
     auto const delta_s_star = position - adjacent_vertices.first.position();
-    if (angle_type == AngleType::inclination)
+    if (fabs(delta_s_star) <= std::numeric_limits<double>::epsilon())
     {
-        return fabs(delta_s_star) > std::numeric_limits<double>::epsilon()
-                   ? acos(this->calculate_delta_z_projection(position, adjacent_vertices) / delta_s_star)
-                   : adjacent_vertices.first.inclination();
+        auto const inc_star = adjacent_vertices.first.inclination();
+        auto const azimuth_defined = sin(inc_star) >= std::numeric_limits<double>::epsilon() &&
+                                     fabs(inc_star) >= std::numeric_limits<double>::epsilon();
+        return {position, inc_star, azimuth_defined ? adjacent_vertices.first.azimuth() : 0.0};
     }
-    else // azimuth
+
+    // only the x and z variations are needed, both divided by delta_s_star
+    auto const &[c0, c1, c2, c3] = polynomial;
+    auto const ep = this->calculate_ep(position, adjacent_vertices);
+    auto const delta_x = ((c3.x * ep + c2.x) * ep + c1.x) * ep + c0.x;
+    auto const delta_z = ((c3.z * ep + c2.z) * ep + c1.z) * ep + c0.z;
+
+    auto const inc_star = acos(delta_z);
+    auto const sin_inc_star = sin(inc_star);
+    if (sin_inc_star < std::numeric_limits<double>::epsilon() ||
+        fabs(inc_star) < std::numeric_limits<double>::epsilon() /*azimuth not defined*/)
     {
-        auto const inc_star = this->inclination_at_position(position, adjacent_vertices);
-        auto const sin_inc_star = sin(inc_star);
-        if (sin_inc_star < std::numeric_limits<double>::epsilon() ||
-            fabs(inc_star) < std::numeric_limits<double>::epsilon() /*azimuth not defined*/)
-        {
-            return 0.0;
-        }
-        else
-        {
-            return fabs(delta_s_star) > std::numeric_limits<double>::epsilon()
-                       ? acos(
-                             (this->calculate_delta_x_projection(position, adjacent_vertices) / delta_s_star) /
-                             sin_inc_star)
-                       : adjacent_vertices.first.azimuth();
-        }
+        return {position, inc_star, 0.0};
     }
+
+    return {position, inc_star, acos(delta_x / sin_inc_star)};
 }
 
-double CubicInterpolator::calculate_delta_x_projection(double position, const AdjacentVertices &adjacent_vertices) const
+void CubicInterpolator::calculate_batch(
+    std::span<const double> positions, const AdjacentVertices &adjacent_vertices, std::size_t segment_index,
+    std::span<Vertex> vertices, std::span<Point> points) const
 {
-    return this->calculate_delta_projection(position, adjacent_vertices, ProjectionType::x);
+    auto const &[c0, c1, c2, c3] = this->_polynomials[segment_index];
+    auto const segment = utils::BatchKernels::Cubic{
+        adjacent_vertices.first.position(), adjacent_vertices.second.position() - adjacent_vertices.first.position(),
+        {c0.x, c1.x, c2.x, c3.x}, {c0.z, c1.z, c2.z, c3.z}};
+
+    utils::BatchKernels::run(
+        positions, vertices, points, [&segment](std::span<const double> block, const utils::BatchOutput &output) {
+            utils::BatchKernels::cubic(segment, block, output);
+        });
 }
 
-double CubicInterpolator::calculate_delta_y_projection(double position, const AdjacentVertices &adjacent_vertices) const
+void CubicInterpolator::update_segments()
 {
-    return this->calculate_delta_projection(position, adjacent_vertices, ProjectionType::y);
+    auto const &trajectory = this->trajectory();
+
+    this->_polynomials.clear();
+    this->reserve_table(this->_polynomials);
+    for (std::size_t i = 1; i < trajectory.size(); ++i)
+    {
+        this->_polynomials.push_back(this->calculate_polynomial({trajectory[i - 1], trajectory[i]}));
+    }
 }
 
-double CubicInterpolator::calculate_delta_z_projection(double position, const AdjacentVertices &adjacent_vertices) const
+void CubicInterpolator::update_segments(std::size_t vertex_index, VertexChange vertex_change)
 {
-    return this->calculate_delta_projection(position, adjacent_vertices, ProjectionType::z);
+    this->update_segment_table(
+        this->_polynomials, vertex_index, vertex_change,
+        [this](const AdjacentVertices &adjacent_vertices) { return this->calculate_polynomial(adjacent_vertices); });
 }
 
-double CubicInterpolator::calculate_ep(double position, const AdjacentVertices &adjacent_vertices) const
+double CubicInterpolator::calculate_delta_x_projection(
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const
 {
-    auto const delta_s = adjacent_vertices.second.position() - adjacent_vertices.first.position();
-    return delta_s > std::numeric_limits<double>::epsilon()
-               ? (position - adjacent_vertices.first.position()) / (delta_s)
-               : 0.0;
+    return this->calculate_delta_projections(position, adjacent_vertices, projection_index).x;
 }
 
-double CubicInterpolator::calculate_f1(double position, const AdjacentVertices &adjacent_vertices) const
+double CubicInterpolator::calculate_delta_y_projection(
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const
 {
-    auto const ep = this->calculate_ep(position, adjacent_vertices);
-    return 1 + (2 * ep - 3) * ep * ep;
+    return this->calculate_delta_projections(position, adjacent_vertices, projection_index).y;
 }
 
-double CubicInterpolator::calculate_f2(double position, const AdjacentVertices &adjacent_vertices) const
+double CubicInterpolator::calculate_delta_z_projection(
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const
 {
-    auto const ep = this->calculate_ep(position, adjacent_vertices);
-    return ep * (ep - 1) * (ep - 1) * (adjacent_vertices.second.position() - adjacent_vertices.first.position());
+    return this->calculate_delta_projections(position, adjacent_vertices, projection_index).z;
 }
 
-double CubicInterpolator::calculate_f3(double position, const AdjacentVertices &adjacent_vertices) const
+BaseInterpolator::Bend CubicInterpolator::calculate_bend(
+    double first_position, double last_position, std::size_t segment_index) const
 {
-    auto const ep = this->calculate_ep(position, adjacent_vertices);
-    return (3 - 2 * ep) * ep * ep;
+    auto const positions = this->trajectory().positions_view();
+    auto const delta_s = positions[segment_index + 1] - positions[segment_index];
+    if (delta_s <= std::numeric_limits<double>::epsilon())
+    {
+        return {};
+    }
+
+    // the direction of the interpolated vertex is d = (q_x, y, q_z) with y = sqrt(r) and r = 1 - q_x^2 - q_z^2
+    // (@see calculate_vertex), where q = c0 + c1 ep + c2 ep^2 + c3 ep^3. The polynomials and their derivatives by the
+    // position are bounded over the range
+    auto const first = (first_position - positions[segment_index]) / delta_s;
+    auto const last = (last_position - positions[segment_index]) / delta_s;
+    auto const &[c0, c1, c2, c3] = this->_polynomials[segment_index];
+    auto const q_x = std::array{c0.x, c1.x, c2.x, c3.x};
+    auto const q_z = std::array{c0.z, c1.z, c2.z, c3.z};
+
+    auto r = std::array<double, 7>{1.0};
+    for (std::size_t i = 0; i < q_x.size(); ++i)
+    {
+        for (std::size_t j = 0; j < q_z.size(); ++j)
+        {
+            r[i + j] -= q_x[i] * q_x[j] + q_z[i] * q_z[j];
+        }
+    }
+
+    auto const planar_bound = [first, last](const auto &x, const auto &z) {
+        return std::hypot(polynomial_bound(x, first, last), polynomial_bound(z, first, last));
+    };
+    auto const planar_first = planar_bound(derivative(q_x), derivative(q_z)) / delta_s;
+    auto const planar_second =
+        planar_bound(derivative(derivative(q_x)), derivative(derivative(q_z))) / (delta_s * delta_s);
+    auto const r_first = polynomial_bound(derivative(r), first, last) / delta_s;
+    auto const r_second = polynomial_bound(derivative(derivative(r)), first, last) / (delta_s * delta_s);
+
+    // |y(s) - y(t)| <= sqrt(|r(s) - r(t)|) bounds the deviation even where y vanishes: the direction folds back
+    // there, so the tangent of the points jumps
+    auto const length = last_position - first_position;
+    auto const delta_s_star = last_position - positions[segment_index];
+    auto const deviation = length + delta_s_star * (planar_first * length + std::sqrt(r_first * length));
+
+    auto const [r_min, r_max] = polynomial_range(r, first, last);
+    if (r_max <= std::numeric_limits<double>::epsilon())
+    {
+        // the direction stays in the xz plane (a vertical or a north-south part) up to y <= sqrt(epsilon), which is
+        // below the tolerance of the refinement: the plane curve bends as a unit direction, and y adds a band around it
+        auto bend = this->calculate_direction_bend(length, delta_s_star, planar_first, planar_second);
+        bend.deviation = std::min(bend.deviation, deviation) + delta_s_star * std::sqrt(std::max(r_max, 0.0));
+        return bend;
+    }
+    if (!(r_min > 0.0))
+    {
+        return {std::numeric_limits<double>::infinity(), deviation};
+    }
+
+    // y' = r' / (2 y) and y'' = (r'' / 2 - y'^2) / y
+    auto const y = std::sqrt(r_min);
+    auto const y_first = r_first / (2.0 * y);
+    auto const y_second = (r_second / 2.0 + y_first * y_first) / y;
+
+    auto bend = this->calculate_direction_bend(
+        length, delta_s_star, std::hypot(planar_first, y_first), std::hypot(planar_second, y_second));
+    bend.deviation = std::min(bend.deviation, deviation);
+    return bend;
 }
 
-double CubicInterpolator::calculate_f4(double position, const AdjacentVertices &adjacent_vertices) const
+double CubicInterpolator::calculate_ep(double position, const AdjacentVertices &adjacent_vertices) const
 {
-    auto const ep = this->calculate_ep(position, adjacent_vertices);
-    return ep * ep * (ep - 1) * (adjacent_vertices.second.position() - adjacent_vertices.first.position());
+    auto const delta_s = adjacent_vertices.second.position() - adjacent_vertices.first.position();
+    return delta_s > std::numeric_limits<double>::epsilon()
+               ? (position - adjacent_vertices.first.position()) / (delta_s)
+               : 0.0;
 }
 
-double CubicInterpolator::calculate_delta_projection(
-    double position, const AdjacentVertices &adjacent_vertices, ProjectionType projection_type) const
+CubicInterpolator::Polynomial CubicInterpolator::calculate_polynomial(const AdjacentVertices &adjacent_vertices) const
 {
-    auto const f1 = this->calculate_f1(position, adjacent_vertices);
-    auto const f2 = this->calculate_f2(position, adjacent_vertices);
-    auto const f3 = this->calculate_f3(position, adjacent_vertices);
-    auto const f4 = this->calculate_f4(position, adjacent_vertices);
-
     auto const &v_1 = adjacent_vertices.first;
     auto const &v_2 = adjacent_vertices.second;
 
@@ -126,79 +299,80 @@ double CubicInterpolator::calculate_delta_projection(
     auto const sin_azm_1 = sin(v_1.azimuth());
     auto const sin_azm_2 = sin(v_2.azimuth());
 
+    auto const cos_inc_1 = cos(v_1.inclination());
+    auto const cos_inc_2 = cos(v_2.inclination());
     auto const cos_azm_1 = cos(v_1.azimuth());
     auto const cos_azm_2 = cos(v_2.azimuth());
 
-    auto a1 = 0.0;
-    auto a2 = 0.0;
-    auto a3 = 0.0;
-    auto a4 = 0.0;
+    auto const a1 = Point{sin_inc_1 * cos_azm_1, sin_inc_1 * sin_azm_1, cos_inc_1};
+    auto const a3 = Point{sin_inc_2 * cos_azm_2, sin_inc_2 * sin_azm_2, cos_inc_2};
+    auto a2 = Point{};
+    auto a4 = Point{};
 
     auto const delta_s = v_2.position() - v_1.position();
-    if (projection_type == ProjectionType::x)
+    if (fabs(delta_s) > std::numeric_limits<double>::epsilon())
     {
-        a1 = sin_inc_1 * cos_azm_1;
-        a3 = sin_inc_2 * cos_azm_2;
-
-        if (fabs(delta_s) > std::numeric_limits<double>::epsilon())
-        {
-            auto const cos_inc_1 = cos(v_1.inclination());
-            auto const cos_inc_2 = cos(v_2.inclination());
+        auto const dinc_ds = this->calculate_delta_angle(v_1.inclination(), v_2.inclination()) / delta_s;
+        auto const dazm_ds = this->calculate_delta_angle(v_1.azimuth(), v_1.azimuth()) / delta_s;
+        auto const dinc_ds_z = (v_2.inclination() - v_1.inclination()) / delta_s;
 
-            auto const dinc_ds = this->calculate_delta_angle(v_1.inclination(), v_2.inclination()) / delta_s;
-            auto const dazm_ds = this->calculate_delta_angle(v_1.azimuth(), v_1.azimuth()) / delta_s;
-            a2 = (cos_inc_1 * cos_azm_1 * dinc_ds - sin_inc_1 * sin_azm_1 * dazm_ds);
-            a4 = (cos_inc_2 * cos_azm_2 * dinc_ds - sin_inc_2 * sin_azm_2 * dazm_ds);
-        }
-        else
-        {
-            // for delta_s -> 0; delta_inc -> delta_azm -> 0
-            a2 = cos(v_1.inclination() + v_1.azimuth());
-            a4 = cos(v_2.inclination() + v_2.azimuth());
-        }
+        a2 = {
+            (cos_inc_1 * cos_azm_1 * dinc_ds - sin_inc_1 * sin_azm_1 * dazm_ds),
+            (cos_inc_1 * sin_azm_1 * dinc_ds + sin_inc_1 * cos_azm_1 * dazm_ds), -sin_inc_1 * dinc_ds_z};
+        a4 = {
+            (cos_inc_2 * cos_azm_2 * dinc_ds - sin_inc_2 * sin_azm_2 * dazm_ds),
+            (cos_inc_2 * sin_azm_2 * dinc_ds + sin_inc_2 * cos_azm_2 * dazm_ds), -sin_inc_2 * dinc_ds_z};
     }
-    else if (projection_type == ProjectionType::y)
+    else
     {
-        a1 = sin_inc_1 * sin_azm_1;
-        a3 = sin_inc_2 * sin_azm_2;
+        // for delta_s -> 0; delta_inc -> delta_azm -> 0
+        a2 = {cos(v_1.inclination() + v_1.azimuth()), sin(v_1.inclination() + v_1.azimuth()), -sin_inc_1};
+        a4 = {cos(v_2.inclination() + v_2.azimuth()), sin(v_2.inclination() + v_2.azimuth()), -sin_inc_2};
+    }
 
-        if (fabs(delta_s) > std::numeric_limits<double>::epsilon())
-        {
-            auto const cos_inc_1 = cos(v_1.inclination());
-            auto const cos_inc_2 = cos(v_2.inclination());
+    // f2 and f4 are scaled by delta_s, but ep is 0 (f1 = 1) if delta_s vanishes
+    auto const h = delta_s > std::numeric_limits<double>::epsilon() ? delta_s : 0.0;
 
-            auto const dinc_ds = this->calculate_delta_angle(v_1.inclination(), v_2.inclination()) / delta_s;
-            auto const dazm_ds = this->calculate_delta_angle(v_1.azimuth(), v_1.azimuth()) / delta_s;
-            a2 = (cos_inc_1 * sin_azm_1 * dinc_ds + sin_inc_1 * cos_azm_1 * dazm_ds);
-            a4 = (cos_inc_2 * sin_azm_2 * dinc_ds + sin_inc_2 * cos_azm_2 * dazm_ds);
-        }
-        else
-        {
-            // for delta_s -> 0; delta_inc -> delta_azm -> 0
-            a2 = sin(v_1.inclination() + v_1.azimuth());
-            a4 = sin(v_2.inclination() + v_2.azimuth());
-        }
-    }
-    else // z
+    // a1 * f1 + a2 * f2 + a3 * f3 + a4 * f4 with f1 = 1 - 3 ep^2 + 2 ep^3, f2 = h (ep - 2 ep^2 + ep^3),
+    // f3 = 3 ep^2 - 2 ep^3 and f4 = h (ep^3 - ep^2)
+    Polynomial polynomial;
+    for (auto axis : {&Point::x, &Point::y, &Point::z})
     {
-        a1 = cos(v_1.inclination());
-        a3 = cos(v_2.inclination());
+        polynomial.c0.*axis = a1.*axis;
+        polynomial.c1.*axis = h * a2.*axis;
+        polynomial.c2.*axis = 3.0 * (a3.*axis - a1.*axis) - h * (2.0 * a2.*axis + a4.*axis);
+        polynomial.c3.*axis = 2.0 * (a1.*axis - a3.*axis) + h * (a2.*axis + a4.*axis);
+    }
 
-        if (fabs(delta_s) > std::numeric_limits<double>::epsilon())
-        {
-            auto const dinc_ds = (v_2.inclination() - v_1.inclination()) / delta_s;
-            a2 = -sin(v_1.inclination()) * dinc_ds;
-            a4 = -sin(v_2.inclination()) * dinc_ds;
-        }
-        else
-        {
-            // for delta_s -> 0; delta_inc -> delta_azm -> 0
-            a2 = -sin(v_1.inclination());
-            a4 = -sin(v_2.inclination());
-        }
+    return polynomial;
+}
+
+Point CubicInterpolator::calculate_delta_projections(
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t /*projection_index*/) const
+{
+    auto const &[v_1, v_2] = adjacent_vertices;
+    auto const delta_s_star = position - v_1.position();
+
+    // the segment ends at the position (ep = 1; f3 = 1, f1 = f2 = f4 = 0): only the last direction is needed. It is
+    // the case of the cumulative projections and of the segment ending at an interpolated vertex
+    if (v_2.position() - v_1.position() > std::numeric_limits<double>::epsilon() && position == v_2.position())
+    {
+        auto const sin_inc_2 = sin(v_2.inclination());
+        return {
+            sin_inc_2 * cos(v_2.azimuth()) * delta_s_star, sin_inc_2 * sin(v_2.azimuth()) * delta_s_star,
+            cos(v_2.inclination()) * delta_s_star};
     }
 
-    return (a1 * f1 + a2 * f2 + a3 * f3 + a4 * f4) * (position - v_1.position());
+    auto const &[c0, c1, c2, c3] = this->calculate_polynomial(adjacent_vertices);
+    auto const ep = this->calculate_ep(position, adjacent_vertices);
+
+    return {
+        (((c3.x * ep + c2.x) * ep + c1.x) * ep + c0.x) * delta_s_star,
+        (((c3.y * ep + c2.y) * ep + c1.y) * ep + c0.y) * delta_s_star,
+        (((c3.z * ep + c2.z) * ep + c1.z) * ep + c0.z) * delta_s_star};
 }
 
+// the engine is instantiated next to the kernels, so its loops inline them
+template class InterpolatorEngine<CubicInterpolator>;
+
 } // namespace splines
@@ -1,17 +1,19 @@
 #include "interpolator/LinearInterpolator.hpp"
+#include "interpolator/utils/BatchKernels.hpp"
 
 namespace splines
 {
 
 LinearInterpolator::LinearInterpolator(const Vertices &trajectory)
-    : BaseInterpolator(trajectory)
+    : InterpolatorEngine(trajectory)
 {
+    this->update_cumulative_projections();
 }
 
 template <typename Interpolator>
 LinearInterpolator::LinearInterpolator(Interpolator &&other)
     requires std::same_as<Interpolator, LinearInterpolator>
-    : BaseInterpolator(std::forward<Interpolator>(other))
+    : InterpolatorEngine(std::forward<Interpolator>(other))
 {
 }
 
@@ -23,18 +25,20 @@ LinearInterpolator &LinearInterpolator::operator=(Interpolator &&rhs)
     return *this;
 }
 
-double LinearInterpolator::inclination_at_position(double position, const AdjacentVertices &adjacent_vertices) const
+double LinearInterpolator::inclination_at_position(
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t /*upper_index*/) const
 {
     return this->angle_at_position(position, adjacent_vertices, AngleType::inclination);
 }
 
-double LinearInterpolator::azimuth_at_position(double position, const AdjacentVertices &adjacent_vertices) const
+double LinearInterpolator::azimuth_at_position(
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t /*upper_index*/) const
 {
     return this->angle_at_position(position, adjacent_vertices, AngleType::azimuth);
 }
 
 double LinearInterpolator::calculate_delta_x_projection(
-    double position, const AdjacentVertices &adjacent_vertices) const
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t /*projection_index*/) const
 {
     auto const &[v_1, v_2] = adjacent_vertices;
     auto delta_s = position - v_1.position();
@@ -43,7 +47,7 @@ double LinearInterpolator::calculate_delta_x_projection(
 }
 
 double LinearInterpolator::calculate_delta_y_projection(
-    double position, const AdjacentVertices &adjacent_vertices) const
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t /*projection_index*/) const
 {
     auto const &[v_1, v_2] = adjacent_vertices;
     auto delta_s = position - v_1.position();
@@ -52,7 +56,7 @@ double LinearInterpolator::calculate_delta_y_projection(
 }
 
 double LinearInterpolator::calculate_delta_z_projection(
-    double position, const AdjacentVertices &adjacent_vertices) const
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t /*projection_index*/) const
 {
     auto const &[v_1, v_2] = adjacent_vertices;
     auto delta_s = position - v_1.position();
@@ -60,6 +64,49 @@ double LinearInterpolator::calculate_delta_z_projection(
     return delta_s * cos(v_2.inclination());
 }
 
+Point LinearInterpolator::calculate_delta_projections(
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t /*projection_index*/) const
+{
+    auto const &[v_1, v_2] = adjacent_vertices;
+    auto delta_s = position - v_1.position();
+    auto const sin_inc_2 = sin(v_2.inclination());
+
+    return {
+        delta_s * sin_inc_2 * cos(v_2.azimuth()), delta_s * sin_inc_2 * sin(v_2.azimuth()),
+        delta_s * cos(v_2.inclination())};
+}
+
+BaseInterpolator::Bend LinearInterpolator::calculate_bend(
+    double first_position, double last_position, std::size_t segment_index) const
+{
+    auto const &v_1 = this->trajectory()[segment_index];
+    auto const &v_2 = this->trajectory()[segment_index + 1];
+    auto const delta_s = v_2.position() - v_1.position();
+    if (delta_s < std::numeric_limits<double>::epsilon())
+    {
+        return {};
+    }
+
+    // the smallest path between the angles, @see angle_at_position
+    auto const angle_range = [](double angle_1, double angle_2) {
+        auto const d_angle = std::fabs(angle_2 - angle_1);
+        return d_angle > M_PI ? std::fabs(d_angle - M_PI * 2) : d_angle;
+    };
+
+    // the angles change at constant rates; the azimuth is not interpolated if the first inclination is zero
+    auto const inclination_rate = angle_range(v_1.inclination(), v_2.inclination()) / delta_s;
+    auto const azimuth_rate = std::fabs(v_1.inclination()) < std::numeric_limits<double>::epsilon()
+                                  ? 0.0
+                                  : angle_range(v_1.azimuth(), v_2.azimuth()) / delta_s;
+
+    // |d'|^2 = inclination'^2 + sin(inclination)^2 azimuth'^2, and the second derivatives of the direction by the
+    // angles are not longer than 1, so the square of the sum of the rates bounds |d''|
+    auto const rates = inclination_rate + azimuth_rate;
+    return this->calculate_direction_bend(
+        last_position - first_position, last_position - v_1.position(),
+        std::sqrt(inclination_rate * inclination_rate + azimuth_rate * azimuth_rate), rates * rates);
+}
+
 double LinearInterpolator::calculate_linear_spline(
     double position_1, double angle_1, double position_2, double angle_2, double position) const
 {
@@ -115,4 +162,55 @@ double LinearInterpolator::angle_at_position(
     return res < 0.0 ? (res + M_PI * 2.0) : res;
 }
 
+void LinearInterpolator::calculate_batch(
+    std::span<const double> positions, const AdjacentVertices &adjacent_vertices, std::size_t segment_index,
+    std::span<Vertex> vertices, std::span<Point> points) const
+{
+    auto const &[v_1, v_2] = adjacent_vertices;
+
+    // the kernel replaces fmod by a subtraction, which is the same only for angles in [0, 2 pi)
+    auto const in_turn = [](double angle) { return angle >= 0.0 && angle < M_PI * 2.0; };
+    if (!in_turn(v_1.inclination()) || !in_turn(v_2.inclination()) || !in_turn(v_1.azimuth()) ||
+        !in_turn(v_2.azimuth()))
+    {
+        InterpolatorEngine::calculate_batch(positions, adjacent_vertices, segment_index, vertices, points);
+        return;
+    }
+
+    // the smallest path between the angles, @see angle_at_position
+    auto const unwrap = [](double angle_1, double angle_2) {
+        auto const d_angle = angle_2 - angle_1;
+        if (fabs(d_angle) > M_PI)
+        {
+            if (d_angle > 0.0)
+            {
+                angle_1 += M_PI * 2;
+            }
+            else
+            {
+                angle_2 += M_PI * 2;
+            }
+        }
+        return std::pair{angle_1, angle_2};
+    };
+    auto const [inc_1, inc_2] = unwrap(v_1.inclination(), v_2.inclination());
+    auto const [azm_1, azm_2] = unwrap(v_1.azimuth(), v_2.azimuth());
+
+    // azimuth is undefined if inclination is zero
+    auto const azimuth_interpolated = std::fabs(v_1.inclination()) >= std::numeric_limits<double>::epsilon();
+    auto const azimuth = std::fabs(v_2.inclination()) > std::numeric_limits<double>::epsilon() ? v_2.azimuth() : 0.0;
+
+    auto const segment = utils::BatchKernels::Linear{
+        v_1.position(), v_2.position(), inc_1, inc_2, azimuth_interpolated, azm_1,
+        azimuth_interpolated ? azm_2 : azimuth};
+
+    utils::BatchKernels::run(
+        positions, vertices, points, [&segment](std::span<const double> block, const utils::BatchOutput &output) {
+            utils::BatchKernels::linear(segment, block, output);
+        });
+}
+
+// the engine is instantiated next to the kernels, so its loops inline them
+template class InterpolatorEngine<LinearInterpolator>;
+
 } // namespace splines
@@ -1,17 +1,20 @@
 #include "interpolator/MinimumCurvatureInterpolator.hpp"
+#include "interpolator/utils/BatchKernels.hpp"
 
 namespace splines
 {
 
 MinimumCurvatureInterpolator::MinimumCurvatureInterpolator(const Vertices &trajectory)
-    : BaseInterpolator(trajectory)
+    : InterpolatorEngine(trajectory)
 {
+    this->update_cumulative_projections();
 }
 
 template <typename Interpolator>
 MinimumCurvatureInterpolator::MinimumCurvatureInterpolator(Interpolator &&other)
     requires std::same_as<Interpolator, MinimumCurvatureInterpolator>
-    : BaseInterpolator(std::forward<Interpolator>(other))
+    : InterpolatorEngine(std::forward<Interpolator>(other))
+    , _segments(std::forward<Interpolator>(other)._segments)
 {
 }
 
@@ -24,15 +27,15 @@ MinimumCurvatureInterpolator &MinimumCurvatureInterpolator::operator=(Interpolat
 }
 
 double MinimumCurvatureInterpolator::inclination_at_position(
-    double position, const AdjacentVertices &adjacent_vertices) const
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t upper_index) const
 {
-    return this->angle_at_position(position, adjacent_vertices, AngleType::inclination);
+    return this->angle_at_position(position, adjacent_vertices, upper_index, AngleType::inclination);
 }
 
 double MinimumCurvatureInterpolator::azimuth_at_position(
-    double position, const AdjacentVertices &adjacent_vertices) const
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t upper_index) const
 {
-    return this->angle_at_position(position, adjacent_vertices, AngleType::azimuth);
+    return this->angle_at_position(position, adjacent_vertices, upper_index, AngleType::azimuth);
 }
 
 double MinimumCurvatureInterpolator::calculate_alpha(const AdjacentVertices &adjacent_vertices) const
@@ -58,37 +61,152 @@ double MinimumCurvatureInterpolator::calculate_alpha(const AdjacentVertices &adj
     }
 }
 
+MinimumCurvatureInterpolator::Segment MinimumCurvatureInterpolator::calculate_segment(
+    const AdjacentVertices &adjacent_vertices) const
+{
+    auto const &[v_1, v_2] = adjacent_vertices;
+    auto const direction = [](const Vertex &vertex) -> Point {
+        auto const sin_inc = sin(vertex.inclination());
+        return {sin_inc * cos(vertex.azimuth()), sin_inc * sin(vertex.azimuth()), cos(vertex.inclination())};
+    };
+
+    auto const alpha = this->calculate_alpha(adjacent_vertices);
+    return {alpha, sin(alpha), direction(v_1), direction(v_2)};
+}
+
+void MinimumCurvatureInterpolator::calculate_batch(
+    std::span<const double> positions, const AdjacentVertices &adjacent_vertices, std::size_t segment_index,
+    std::span<Vertex> vertices, std::span<Point> points) const
+{
+    auto const &[v_1, v_2] = adjacent_vertices;
+    auto const &segment = this->_segments[segment_index];
+    if (segment.alpha < std::numeric_limits<double>::epsilon())
+    {
+        // straight segment: the inclination is not interpolated, @see calculate_vertex
+        InterpolatorEngine::calculate_batch(positions, adjacent_vertices, segment_index, vertices, points);
+        return;
+    }
+
+    // the azimuth conditions of calculate_vertex
+    auto const azimuth_defined = std::fabs(v_2.inclination()) >= std::numeric_limits<double>::epsilon();
+    auto const azimuth = azimuth_defined ? v_2.azimuth() : 0.0;
+    auto const kernel_segment = utils::BatchKernels::MinimumCurvature{
+        v_1.position(),
+        v_2.position() - v_1.position(),
+        segment.alpha,
+        segment.direction_1,
+        segment.direction_2,
+        azimuth_defined && std::fabs(v_2.azimuth() - v_1.azimuth()) >= std::numeric_limits<double>::epsilon(),
+        azimuth,
+        sin(azimuth),
+        cos(azimuth)};
+
+    utils::BatchKernels::run(
+        positions, vertices, points,
+        [&kernel_segment](std::span<const double> block, const utils::BatchOutput &output) {
+            utils::BatchKernels::minimum_curvature(kernel_segment, block, output);
+        });
+}
+
+void MinimumCurvatureInterpolator::update_segments()
+{
+    auto const &trajectory = this->trajectory();
+
+    this->_segments.clear();
+    this->reserve_table(this->_segments);
+    for (std::size_t i = 1; i < trajectory.size(); ++i)
+    {
+        this->_segments.push_back(this->calculate_segment({trajectory[i - 1], trajectory[i]}));
+    }
+}
+
+void MinimumCurvatureInterpolator::update_segments(std::size_t vertex_index, VertexChange vertex_change)
+{
+    this->update_segment_table(
+        this->_segments, vertex_index, vertex_change,
+        [this](const AdjacentVertices &adjacent_vertices) { return this->calculate_segment(adjacent_vertices); });
+}
+
 double MinimumCurvatureInterpolator::calculate_delta_x_projection(
-    double position, const AdjacentVertices &adjacent_vertices) const
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const
 {
     auto const &[v_1, v_2] = adjacent_vertices;
-    auto const [delta_s, factor_f] = this->calculate_common_delta_projection(position, adjacent_vertices);
+    auto const [delta_s, factor_f] =
+        this->calculate_common_delta_projection(position, adjacent_vertices, projection_index);
 
     return (delta_s / 2.0) *
            (sin(v_2.inclination()) * cos(v_2.azimuth()) + sin(v_1.inclination()) * cos(v_1.azimuth())) * factor_f;
 }
 
 double MinimumCurvatureInterpolator::calculate_delta_y_projection(
-    double position, const AdjacentVertices &adjacent_vertices) const
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const
 {
     auto const &[v_1, v_2] = adjacent_vertices;
-    auto const [delta_s, factor_f] = this->calculate_common_delta_projection(position, adjacent_vertices);
+    auto const [delta_s, factor_f] =
+        this->calculate_common_delta_projection(position, adjacent_vertices, projection_index);
 
     return (delta_s / 2.0) *
            (sin(v_2.inclination()) * sin(v_2.azimuth()) + sin(v_1.inclination()) * sin(v_1.azimuth())) * factor_f;
 }
 
 double MinimumCurvatureInterpolator::calculate_delta_z_projection(
-    double position, const AdjacentVertices &adjacent_vertices) const
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const
 {
     auto const &[v_1, v_2] = adjacent_vertices;
-    auto const [delta_s, factor_f] = this->calculate_common_delta_projection(position, adjacent_vertices);
+    auto const [delta_s, factor_f] =
+        this->calculate_common_delta_projection(position, adjacent_vertices, projection_index);
 
     return (delta_s / 2.0) * (cos(v_2.inclination()) + cos(v_1.inclination())) * factor_f;
 }
 
+Point MinimumCurvatureInterpolator::calculate_delta_projections(
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const
+{
+    auto const &[v_1, v_2] = adjacent_vertices;
+    auto const [delta_s, factor_f] =
+        this->calculate_common_delta_projection(position, adjacent_vertices, projection_index);
+
+    auto const sin_inc_1 = sin(v_1.inclination());
+    auto const sin_inc_2 = sin(v_2.inclination());
+
+    return {
+        (delta_s / 2.0) * (sin_inc_2 * cos(v_2.azimuth()) + sin_inc_1 * cos(v_1.azimuth())) * factor_f,
+        (delta_s / 2.0) * (sin_inc_2 * sin(v_2.azimuth()) + sin_inc_1 * sin(v_1.azimuth())) * factor_f,
+        (delta_s / 2.0) * (cos(v_2.inclination()) + cos(v_1.inclination())) * factor_f};
+}
+
+BaseInterpolator::Bend MinimumCurvatureInterpolator::calculate_bend(
+    double first_position, double last_position, std::size_t segment_index) const
+{
+    // the points lie on an arc with the dogleg of the segment, whose curvature is constant
+    auto const &v_1 = this->trajectory()[segment_index];
+    auto const &v_2 = this->trajectory()[segment_index + 1];
+    auto const delta_s = v_2.position() - v_1.position();
+    auto const curvature =
+        delta_s > std::numeric_limits<double>::epsilon() ? this->_segments[segment_index].alpha / delta_s : 0.0;
+    auto const length = last_position - first_position;
+    if (std::fabs(v_2.inclination()) >= std::numeric_limits<double>::epsilon() || curvature == 0.0)
+    {
+        return {curvature * length, curvature * length * length / 8.0};
+    }
+
+    // unless the segment ends vertical: the interpolated vertices take the azimuth 0 (@see calculate_vertex), i.e.
+    // the directions of the arc rotated by -azimuth_1 about z. So the points are the rotated arc plus
+    // g(u) = u F / 2 = tan(curvature u / 2) / curvature times the rotated e = R(azimuth_1) d_1 - d_1, where u is the
+    // distance to the first vertex, and g', g'' grow with u
+    auto const half_angle = std::min(curvature * (last_position - v_1.position()) / 2.0, M_PI / 2.0);
+    auto const secant_2 = 1.0 / (cos(half_angle) * cos(half_angle));
+    auto const e = 2.0 * std::fabs(sin(v_1.inclination()) * sin(v_1.azimuth() / 2.0));
+    auto const second_derivative = curvature + e * curvature * secant_2 * tan(half_angle) / 2.0;
+    auto const min_first_derivative = 1.0 - e * secant_2 / 2.0;
+    return {
+        min_first_derivative > 0.0 ? second_derivative * length / min_first_derivative
+                                   : std::numeric_limits<double>::infinity(),
+        second_derivative * length * length / 8.0};
+}
+
 std::pair<double, double> MinimumCurvatureInterpolator::calculate_common_delta_projection(
-    double position, const AdjacentVertices &adjacent_vertices) const
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t projection_index) const
 {
     auto const &v_1 = adjacent_vertices.first;
     auto const delta_s = position - v_1.position();
@@ -97,16 +215,44 @@ std::pair<double, double> MinimumCurvatureInterpolator::calculate_common_delta_p
         return {0.0, 0.0};
     }
 
-    auto const alpha = std::max(this->calculate_alpha(adjacent_vertices), std::numeric_limits<double>::epsilon());
+    // the second vertex lies on the arc of the segment, so its dogleg is the segment one weighted by the distance.
+    // The segment from the origin to the first vertex is not in the table
+    auto alpha = 0.0;
+    if (projection_index)
+    {
+        auto const ds = this->trajectory().positions_view()[projection_index] - v_1.position();
+        alpha = this->_segments[projection_index - 1].alpha * (delta_s / ds);
+    }
+    else
+    {
+        alpha = this->calculate_alpha(adjacent_vertices);
+    }
+    alpha = std::max(alpha, std::numeric_limits<double>::epsilon());
     auto factor_f = (2.0 / alpha) * tan(alpha / 2.0);
 
     return {delta_s, factor_f};
 }
 
 double MinimumCurvatureInterpolator::angle_at_position(
-    double position, const AdjacentVertices &adjacent_vertices, AngleType angle_type) const
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t upper_index, AngleType angle_type) const
 {
-    auto const alpha = this->calculate_alpha(adjacent_vertices);
+    // beyond the trajectory both adjacent vertices are the same one (@see calculate_adjacent_vertices): no dogleg
+    auto const vertex = upper_index == 0 || upper_index == this->trajectory().size()
+                            ? this->calculate_vertex(position, adjacent_vertices, Segment{})
+                            : this->calculate_vertex(position, adjacent_vertices, upper_index - 1);
+    return angle_type == AngleType::inclination ? vertex.inclination() : vertex.azimuth();
+}
+
+Vertex MinimumCurvatureInterpolator::calculate_vertex(
+    double position, const AdjacentVertices &adjacent_vertices, std::size_t segment_index) const
+{
+    return this->calculate_vertex(position, adjacent_vertices, this->_segments[segment_index]);
+}
+
+Vertex MinimumCurvatureInterpolator::calculate_vertex(
+    double position, const AdjacentVertices &adjacent_vertices, const Segment &segment) const
+{
+    auto const alpha = segment.alpha;
 
     auto const &v_1 = adjacent_vertices.first;
     auto const &v_2 = adjacent_vertices.second;
@@ -125,55 +271,43 @@ double MinimumCurvatureInterpolator::angle_at_position(
         ds_star = std::numeric_limits<double>::epsilon();
     }
 
-    if (angle_type == AngleType::inclination)
+    auto inc_star = v_1.inclination();
+    if (alpha >= std::numeric_limits<double>::epsilon())
     {
-
         auto const weight = ds_star / ds;
         auto const comp_weight = 1 - weight;
 
-        if (alpha < std::numeric_limits<double>::epsilon())
-        {
-            return v_1.inclination();
-        }
-        else
-        {
-            auto const numerator =
-                (sin(comp_weight * alpha) * cos(v_1.inclination()) + sin(weight * alpha) * cos(v_2.inclination()));
+        auto const numerator =
+            (sin(comp_weight * alpha) * segment.direction_1.z + sin(weight * alpha) * segment.direction_2.z);
 
-            return acos(numerator / sin(alpha));
-        }
+        // the quotient may exceed 1 by rounding next to a vertical vertex
+        inc_star = acos(std::clamp(numerator / segment.sin_alpha, -1.0, 1.0));
     }
-    else
+
+    auto azm_star = 0.0;
+    if (std::fabs(v_2.inclination()) >= std::numeric_limits<double>::epsilon())
     {
-        if (std::fabs(v_2.inclination()) < std::numeric_limits<double>::epsilon())
-        {
-            return 0.0;
+        if (std::fabs(v_2.azimuth() - v_1.azimuth()) < std::numeric_limits<double>::epsilon())
+        { // straight hole condition
+            azm_star = v_2.azimuth();
         }
         else
         {
-            if (std::fabs(v_2.azimuth() - v_1.azimuth()) < std::numeric_limits<double>::epsilon())
-            { // straight hole condition
-                return v_2.azimuth();
-            }
-            else
-            {
-                auto const sin_inc_1 = sin(v_1.inclination());
-                auto const sin_azm_1 = sin(v_1.azimuth());
-                auto const cos_azm_1 = cos(v_1.azimuth());
-                auto const sin_inc_2 = sin(v_2.inclination());
-                auto const sin_azm_2 = sin(v_2.azimuth());
-                auto const cos_azm_2 = cos(v_2.azimuth());
-
-                auto azm_star = atan2(
-                    sin_inc_1 * sin_azm_1 * sin((1 - ds_star / ds) * alpha) +
-                        sin_inc_2 * sin_azm_2 * (sin(ds_star * alpha / ds)),
-                    sin_inc_1 * cos_azm_1 * sin((1 - ds_star / ds) * alpha) +
-                        sin_inc_2 * cos_azm_2 * (sin(ds_star * alpha / ds)));
-
-                return azm_star < 0 ? (azm_star + M_PI * 2) : azm_star;
-            }
+            auto const &direction_1 = segment.direction_1;
+            auto const &direction_2 = segment.direction_2;
+
+            azm_star = atan2(
+                direction_1.y * sin((1 - ds_star / ds) * alpha) + direction_2.y * (sin(ds_star * alpha / ds)),
+                direction_1.x * sin((1 - ds_star / ds) * alpha) + direction_2.x * (sin(ds_star * alpha / ds)));
+
+            azm_star = azm_star < 0 ? (azm_star + M_PI * 2) : azm_star;
         }
     }
+
+    return {position, inc_star, azm_star};
 }
 
+// the engine is instantiated next to the kernels, so its loops inline them
+template class InterpolatorEngine<MinimumCurvatureInterpolator>;
+
 } // namespace splines
@@ -0,0 +1,165 @@
+#include "interpolator/PositionGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace splines
+{
+
+PositionGrid::PositionGrid(Spacing spacing, double first, double step, std::size_t grid_size, double last)
+    : _spacing(spacing)
+    , _first(first)
+    , _step(step)
+    , _grid_size(grid_size)
+    , _last(last)
+{
+}
+
+PositionGrid PositionGrid::uniform(double first, double step, std::size_t size)
+{
+    if (!(step >= 0.0))
+    {
+        throw std::invalid_argument("PositionGrid: the step must not be negative");
+    }
+
+    auto const last = size ? first + static_cast<double>(size - 1) * step : first;
+    return PositionGrid(Spacing::linear, first, step, size, last);
+}
+
+PositionGrid PositionGrid::fixed_step(double first, double last, double step)
+{
+    if (!(step > 0.0) || !(last >= first))
+    {
+        throw std::invalid_argument("PositionGrid: the step must be positive and last not less than first");
+    }
+
+    // the tolerance keeps last when (last - first) / step is an integer rounded down
+    auto const size = static_cast<std::size_t>(std::floor((last - first) / step + 1E-9)) + 1;
+    return PositionGrid(Spacing::linear, first, step, size, last);
+}
+
+PositionGrid PositionGrid::logarithmic(double first, double last, std::size_t size)
+{
+    if (!(first > 0.0) || !(last > first) || size < 2)
+    {
+        throw std::invalid_argument("PositionGrid: a logarithmic grid needs 0 < first < last and two positions");
+    }
+
+    return PositionGrid(
+        Spacing::logarithmic, first, std::log(last / first) / static_cast<double>(size - 1), size, last);
+}
+
+PositionGrid PositionGrid::with_stations(std::span<const double> stations) const
+{
+    // the stations of this grid are merged with the new ones
+    std::vector<double> all_stations(this->_stations);
+    all_stations.insert(all_stations.end(), stations.begin(), stations.end());
+    std::sort(all_stations.begin(), all_stations.end());
+
+    auto grid = PositionGrid(this->_spacing, this->_first, this->_step, this->_grid_size, this->_last);
+    for (auto const station : all_stations)
+    {
+        if (station < this->_first || station > this->_last ||
+            (!grid._stations.empty() &&
+             std::fabs(station - grid._stations.back()) < std::numeric_limits<double>::epsilon()))
+        {
+            continue;
+        }
+
+        auto const rank = this->grid_rank(station);
+        if (rank < this->_grid_size &&
+            std::fabs(this->grid_position(rank) - station) < std::numeric_limits<double>::epsilon())
+        {
+            continue;
+        }
+
+        grid._station_indices.push_back(rank + grid._stations.size());
+        grid._stations.push_back(station);
+    }
+    return grid;
+}
+
+std::size_t PositionGrid::size() const
+{
+    return this->_grid_size + this->_stations.size();
+}
+
+bool PositionGrid::empty() const
+{
+    return this->size() == 0;
+}
+
+double PositionGrid::operator[](std::size_t index) const
+{
+    auto const station = std::lower_bound(this->_station_indices.begin(), this->_station_indices.end(), index);
+    auto const num_stations = static_cast<std::size_t>(station - this->_station_indices.begin());
+    if (station != this->_station_indices.end() && *station == index)
+    {
+        return this->_stations[num_stations];
+    }
+    return this->grid_position(index - num_stations);
+}
+
+void PositionGrid::fill(std::size_t first, std::span<double> positions) const
+{
+    // the stations before first are found once, then the grid and the stations are merged
+    auto num_stations = static_cast<std::size_t>(
+        std::lower_bound(this->_station_indices.begin(), this->_station_indices.end(), first) -
+        this->_station_indices.begin());
+
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        auto const index = first + i;
+        if (num_stations < this->_stations.size() && this->_station_indices[num_stations] == index)
+        {
+            positions[i] = this->_stations[num_stations++];
+        }
+        else
+        {
+            positions[i] = this->grid_position(index - num_stations);
+        }
+    }
+}
+
+double PositionGrid::grid_position(std::size_t index) const
+{
+    if (this->_spacing == Spacing::linear)
+    {
+        return this->_first + static_cast<double>(index) * this->_step;
+    }
+
+    // the last position is exact, so the range is closed
+    return index + 1 == this->_grid_size ? this->_last
+                                         : this->_first * std::exp(static_cast<double>(index) * this->_step);
+}
+
+std::size_t PositionGrid::grid_rank(double position) const
+{
+    // the inverse of grid_position gives a guess, which is fixed against the rounding of the closed form
+    auto const estimate = this->_spacing == Spacing::linear ? (position - this->_first) / this->_step
+                                                            : std::log(position / this->_first) / this->_step;
+
+    std::size_t rank = 0;
+    if (estimate >= static_cast<double>(this->_grid_size))
+    {
+        rank = this->_grid_size;
+    }
+    else if (estimate > 0.0)
+    {
+        rank = static_cast<std::size_t>(std::ceil(estimate));
+    }
+
+    while (rank > 0 && this->grid_position(rank - 1) >= position)
+    {
+        --rank;
+    }
+    while (rank < this->_grid_size && this->grid_position(rank) < position)
+    {
+        ++rank;
+    }
+    return rank;
+}
+
+} // namespace splines
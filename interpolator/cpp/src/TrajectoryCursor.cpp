@@ -0,0 +1,38 @@
+#include "interpolator/TrajectoryCursor.hpp"
+
+namespace splines
+{
+
+TrajectoryCursor::TrajectoryCursor(const BaseInterpolator &interpolator)
+    : _interpolator(&interpolator)
+{
+}
+
+Vertex TrajectoryCursor::vertex_at_position(double position)
+{
+    this->move_to(position);
+    return this->_interpolator->vertex_at_position(position, this->_upper_index);
+}
+
+TrajectoryPoint TrajectoryCursor::point_at_position(double position)
+{
+    this->move_to(position);
+    return this->_interpolator->point_at_position(position, this->_upper_index);
+}
+
+void TrajectoryCursor::reset()
+{
+    this->_upper_index = 0;
+}
+
+std::size_t TrajectoryCursor::upper_index() const
+{
+    return this->_upper_index;
+}
+
+void TrajectoryCursor::move_to(double position)
+{
+    this->_upper_index = this->_interpolator->calculate_upper_index(position, this->_upper_index);
+}
+
+} // namespace splines
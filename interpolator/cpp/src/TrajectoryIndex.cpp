@@ -0,0 +1,812 @@
+#include "interpolator/TrajectoryIndex.hpp"
+#include "interpolator/utils/Multithreading.hpp"
+
+namespace splines
+{
+
+namespace
+{
+
+double distance(const Point &lhs, const Point &rhs)
+{
+    return std::sqrt(
+        (lhs.x - rhs.x) * (lhs.x - rhs.x) + (lhs.y - rhs.y) * (lhs.y - rhs.y) + (lhs.z - rhs.z) * (lhs.z - rhs.z));
+}
+
+/**
+ * @brief closest_on_chord
+ * The point of the chord [first, last] nearest to point and its parameter t in [0, 1] (first + t (last - first))
+ */
+std::pair<Point, double> closest_on_chord(const Point &first, const Point &last, const Point &point)
+{
+    auto const chord = Point{last.x - first.x, last.y - first.y, last.z - first.z};
+    auto const squared_length = chord.x * chord.x + chord.y * chord.y + chord.z * chord.z;
+    auto const projection =
+        (point.x - first.x) * chord.x + (point.y - first.y) * chord.y + (point.z - first.z) * chord.z;
+    auto const t = squared_length > 0.0 ? std::clamp(projection / squared_length, 0.0, 1.0) : 0.0;
+
+    return {{first.x + t * chord.x, first.y + t * chord.y, first.z + t * chord.z}, t};
+}
+
+double dot(const Point &lhs, const Point &rhs)
+{
+    return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+}
+
+/**
+ * @brief crossing_tolerance
+ * The precision of the positions where the trajectory crosses a plane
+ */
+double crossing_tolerance(double position)
+{
+    return 4.0 * std::numeric_limits<double>::epsilon() * std::fabs(position) + 1E-10;
+}
+
+} // namespace
+
+TrajectoryIndex::TrajectoryIndex(const BaseInterpolator &interpolator)
+    : _interpolator(&interpolator)
+{
+    this->update();
+}
+
+void TrajectoryIndex::update()
+{
+    this->_pieces.clear();
+    this->_nodes.clear();
+
+    auto const &trajectory = this->_interpolator->trajectory();
+    if (trajectory.empty())
+    {
+        return;
+    }
+
+    // the interpolations may jump at the vertices (the cubic one; the minimum curvature one at a vertex followed by a
+    // vertical one takes its azimuth as 0), so every vertex is a piece without length, part of the segment which it
+    // starts (or of the last segment), and the pieces of a segment lie strictly between its vertices
+    for (std::size_t i = 0; i < trajectory.size(); ++i)
+    {
+        auto const &v_1 = trajectory[i];
+        if (i + 1 == trajectory.size())
+        {
+            this->_pieces.push_back(
+                this->make_piece(v_1.position(), v_1.position(), std::max<std::size_t>(trajectory.size() - 1, 1)));
+            break;
+        }
+
+        auto const &v_2 = trajectory[i + 1];
+        if (v_2.position() - v_1.position() < std::numeric_limits<double>::epsilon())
+        {
+            continue;
+        }
+
+        this->_pieces.push_back(this->make_piece(v_1.position(), v_1.position(), i + 1));
+        auto const first_position = std::nextafter(v_1.position(), v_2.position());
+        auto const last_position = std::nextafter(v_2.position(), v_1.position());
+        if (first_position <= last_position)
+        {
+            this->add_pieces(first_position, last_position, i, 0);
+        }
+    }
+
+    this->_nodes.reserve(2 * this->_pieces.size());
+    this->build(0, this->_pieces.size());
+}
+
+ClosestPoint TrajectoryIndex::closest_point(const Point &point, double max_distance) const
+{
+    if (this->_nodes.empty())
+    {
+        throw std::invalid_argument("TrajectoryIndex: the trajectory is empty");
+    }
+
+    auto const max_squared_distance =
+        max_distance < std::sqrt(std::numeric_limits<double>::max()) ? max_distance * max_distance
+                                                                    : std::numeric_limits<double>::max();
+    ClosestPoint closest{{}, std::numeric_limits<double>::max()};
+    this->search(
+        point,
+        [&closest, max_squared_distance]() {
+            return std::min(closest.distance * closest.distance, max_squared_distance);
+        },
+        [&closest, &point, this](const Piece &piece, double max_squared_distance) {
+            auto const candidate = this->refine(piece, point, max_squared_distance);
+            if (candidate.distance < closest.distance)
+            {
+                closest = candidate;
+            }
+        });
+    return closest.distance <= max_distance ? closest : ClosestPoint{{}, std::numeric_limits<double>::max()};
+}
+
+std::vector<ClosestPoint> TrajectoryIndex::closest_points(std::span<const Point> points, unsigned num_threads) const
+{
+    return utils::Multithreading::run<ClosestPoint>(
+        points.begin(), points.end(), num_threads, [this](const Point &point) { return this->closest_point(point); });
+}
+
+std::vector<ClosestPoint> TrajectoryIndex::nearest_segments(const Point &point, std::size_t k) const
+{
+    if (this->_nodes.empty())
+    {
+        throw std::invalid_argument("TrajectoryIndex: the trajectory is empty");
+    }
+
+    if (!k)
+    {
+        return {};
+    }
+
+    // the best point of each segment found so far, sorted by distance, with the segment upper index
+    std::vector<std::pair<ClosestPoint, std::size_t>> nearest;
+
+    this->search(
+        point,
+        [&nearest, k]() {
+            auto const distance =
+                nearest.size() < k ? std::numeric_limits<double>::max() : nearest.back().first.distance;
+            return distance * distance;
+        },
+        [&nearest, &point, k, this](const Piece &piece, double max_squared_distance) {
+            // a segment already found must be refined by any of its pieces which may be nearer
+            auto segment = std::find_if(nearest.begin(), nearest.end(), [&piece](const auto &segment) {
+                return segment.second == piece.upper_index;
+            });
+            if (segment != nearest.end())
+            {
+                max_squared_distance = segment->first.distance * segment->first.distance;
+            }
+
+            auto const candidate = this->refine(piece, point, max_squared_distance);
+            auto const by_distance = [](const auto &lhs, const auto &rhs) {
+                return lhs.first.distance < rhs.first.distance;
+            };
+
+            // the pieces of a segment replace each other
+            if (segment != nearest.end())
+            {
+                if (candidate.distance < segment->first.distance)
+                {
+                    segment->first = candidate;
+                    std::sort(nearest.begin(), nearest.end(), by_distance);
+                }
+                return;
+            }
+
+            if (nearest.size() < k || candidate.distance < nearest.back().first.distance)
+            {
+                auto const entry = std::pair{candidate, piece.upper_index};
+                nearest.insert(std::upper_bound(nearest.begin(), nearest.end(), entry, by_distance), entry);
+                if (nearest.size() > k)
+                {
+                    nearest.pop_back();
+                }
+            }
+        });
+
+    std::vector<ClosestPoint> segments;
+    segments.reserve(nearest.size());
+    for (auto const &[closest, upper_index] : nearest)
+    {
+        segments.push_back(closest);
+    }
+    return segments;
+}
+
+std::vector<double> TrajectoryIndex::positions_at_plane(const Plane &plane) const
+{
+    if (this->_nodes.empty())
+    {
+        throw std::invalid_argument("TrajectoryIndex: the trajectory is empty");
+    }
+
+    if (!(dot(plane.normal, plane.normal) > 0.0))
+    {
+        throw std::invalid_argument("TrajectoryIndex: the plane normal must not be null");
+    }
+
+    std::vector<double> positions;
+    this->visit_cut(
+        plane, [&plane, &positions, this](const Piece &piece) { this->solve_crossings(piece, plane, positions); });
+
+    // the pieces are visited out of order, and a crossing at the end of a piece is found by both neighbours
+    std::sort(positions.begin(), positions.end());
+    positions.erase(
+        std::unique(
+            positions.begin(), positions.end(),
+            [](double lhs, double rhs) { return rhs - lhs <= crossing_tolerance(rhs); }),
+        positions.end());
+    return positions;
+}
+
+std::vector<std::vector<double>> TrajectoryIndex::positions_at_plane(
+    std::span<const Plane> planes, unsigned num_threads) const
+{
+    return utils::Multithreading::run<std::vector<double>>(
+        planes.begin(), planes.end(), num_threads,
+        [this](const Plane &plane) { return this->positions_at_plane(plane); });
+}
+
+std::vector<std::vector<double>> TrajectoryIndex::positions_at_x(
+    std::span<const double> values, unsigned num_threads) const
+{
+    std::vector<Plane> planes(values.size());
+    std::transform(values.begin(), values.end(), planes.begin(), [](double x) { return Plane{{1.0, 0.0, 0.0}, x}; });
+    return this->positions_at_plane(planes, num_threads);
+}
+
+std::vector<std::vector<double>> TrajectoryIndex::positions_at_y(
+    std::span<const double> values, unsigned num_threads) const
+{
+    std::vector<Plane> planes(values.size());
+    std::transform(values.begin(), values.end(), planes.begin(), [](double y) { return Plane{{0.0, 1.0, 0.0}, y}; });
+    return this->positions_at_plane(planes, num_threads);
+}
+
+std::vector<std::vector<double>> TrajectoryIndex::positions_at_z(
+    std::span<const double> values, unsigned num_threads) const
+{
+    std::vector<Plane> planes(values.size());
+    std::transform(values.begin(), values.end(), planes.begin(), [](double z) { return Plane{{0.0, 0.0, 1.0}, z}; });
+    return this->positions_at_plane(planes, num_threads);
+}
+
+void TrajectoryIndex::Box::merge(const Box &other)
+{
+    for (auto axis : {&Point::x, &Point::y, &Point::z})
+    {
+        this->lower.*axis = std::min(this->lower.*axis, other.lower.*axis);
+        this->upper.*axis = std::max(this->upper.*axis, other.upper.*axis);
+    }
+}
+
+Point TrajectoryIndex::Box::center() const
+{
+    return {
+        (this->lower.x + this->upper.x) / 2.0, (this->lower.y + this->upper.y) / 2.0,
+        (this->lower.z + this->upper.z) / 2.0};
+}
+
+double TrajectoryIndex::Box::squared_distance(const Point &point) const
+{
+    auto squared_distance = 0.0;
+    for (auto axis : {&Point::x, &Point::y, &Point::z})
+    {
+        auto const delta = std::max({this->lower.*axis - point.*axis, 0.0, point.*axis - this->upper.*axis});
+        squared_distance += delta * delta;
+    }
+    return squared_distance;
+}
+
+std::size_t TrajectoryIndex::build(std::size_t first, std::size_t last)
+{
+    auto const index = this->_nodes.size();
+    this->_nodes.emplace_back();
+
+    Box box, centers;
+    for (auto i = first; i < last; ++i)
+    {
+        box.merge(this->_pieces[i].box);
+        auto const center = this->_pieces[i].box.center();
+        centers.merge({center, center});
+    }
+    this->_nodes[index].box = box;
+
+    static constexpr std::size_t leaf_size = 2;
+    if (last - first <= leaf_size)
+    {
+        this->_nodes[index].first = first;
+        this->_nodes[index].size = last - first;
+        return index;
+    }
+
+    // the pieces are split at the median of the axis along which their centers spread the most
+    auto axis = &Point::x;
+    for (auto other : {&Point::y, &Point::z})
+    {
+        if (centers.upper.*other - centers.lower.*other > centers.upper.*axis - centers.lower.*axis)
+        {
+            axis = other;
+        }
+    }
+
+    auto const middle = first + (last - first) / 2;
+    std::nth_element(
+        this->_pieces.begin() + first, this->_pieces.begin() + middle, this->_pieces.begin() + last,
+        [axis](const Piece &lhs, const Piece &rhs) { return lhs.box.center().*axis < rhs.box.center().*axis; });
+
+    this->build(first, middle);
+    auto const right = this->build(middle, last);
+    this->_nodes[index].right = right;
+    return index;
+}
+
+void TrajectoryIndex::add_pieces(
+    double first_position, double last_position, std::size_t segment_index, std::size_t depth)
+{
+    // the bend is bounded tighter over the halves, so a part which may turn too much is halved, down to a depth
+    auto const bend = this->_interpolator->calculate_bend(first_position, last_position, segment_index);
+    if (bend.turn > max_piece_turn && depth < max_piece_depth)
+    {
+        auto const middle = (first_position + last_position) / 2.0;
+        this->add_pieces(first_position, middle, segment_index, depth + 1);
+        this->add_pieces(middle, last_position, segment_index, depth + 1);
+        return;
+    }
+
+    this->_pieces.push_back(this->make_piece(first_position, last_position, segment_index + 1));
+}
+
+TrajectoryIndex::Piece TrajectoryIndex::make_piece(
+    double first_position, double last_position, std::size_t upper_index) const
+{
+    auto const point_at = [upper_index, this](double position) {
+        return this->_interpolator
+            ->point_at_position(position, this->_interpolator->calculate_upper_index(position, upper_index))
+            .point;
+    };
+
+    Piece piece;
+    piece.upper_index = upper_index;
+
+    auto const delta_s = (last_position - first_position) / piece_samples;
+    for (std::size_t i = 0; i <= piece_samples; ++i)
+    {
+        piece.positions[i] = i == piece_samples ? last_position : first_position + delta_s * static_cast<double>(i);
+        piece.points[i] = point_at(piece.positions[i]);
+    }
+
+    for (std::size_t i = 0; i < piece_samples; ++i)
+    {
+        auto const &previous = piece.points[i];
+        auto const &next = piece.points[i + 1];
+
+        // the piece of the last vertex has no length
+        piece.radii[i] = piece.positions[i + 1] > piece.positions[i]
+                             ? this->_interpolator
+                                   ->calculate_bend(piece.positions[i], piece.positions[i + 1], upper_index - 1)
+                                   .deviation
+                             : 0.0;
+
+        for (auto axis : {&Point::x, &Point::y, &Point::z})
+        {
+            piece.box.lower.*axis =
+                std::min(piece.box.lower.*axis, std::min(previous.*axis, next.*axis) - piece.radii[i]);
+            piece.box.upper.*axis =
+                std::max(piece.box.upper.*axis, std::max(previous.*axis, next.*axis) + piece.radii[i]);
+        }
+    }
+    return piece;
+}
+
+template <typename Bound, typename Visit>
+void TrajectoryIndex::search(const Point &point, const Bound &bound, const Visit &visit) const
+{
+    // depth first, the nearer child first, so the bound shrinks early. The tree is balanced (@see build), so the
+    // stack holds at most two nodes per level
+    std::array<std::pair<std::size_t, double>, 128> stack;
+    std::size_t stack_size = 0;
+    stack[stack_size++] = {0, this->_nodes.front().box.squared_distance(point)};
+    while (stack_size)
+    {
+        auto const [index, squared_distance] = stack[--stack_size];
+        if (squared_distance >= bound())
+        {
+            continue;
+        }
+
+        auto const &node = this->_nodes[index];
+        if (node.size)
+        {
+            for (auto i = node.first; i < node.first + node.size; ++i)
+            {
+                auto const max_squared_distance = bound();
+                if (this->_pieces[i].box.squared_distance(point) < max_squared_distance)
+                {
+                    visit(this->_pieces[i], max_squared_distance);
+                }
+            }
+            continue;
+        }
+
+        auto near = std::pair{index + 1, this->_nodes[index + 1].box.squared_distance(point)};
+        auto far = std::pair{node.right, this->_nodes[node.right].box.squared_distance(point)};
+        if (far.second < near.second)
+        {
+            std::swap(near, far);
+        }
+        stack[stack_size++] = far;
+        stack[stack_size++] = near;
+    }
+}
+
+template <typename Visit> void TrajectoryIndex::visit_cut(const Plane &plane, const Visit &visit) const
+{
+    // the plane cuts the box if the box corners are not all on the same side
+    auto const is_cut = [&plane](const Box &box) {
+        auto lower = -plane.offset;
+        auto upper = -plane.offset;
+        for (auto axis : {&Point::x, &Point::y, &Point::z})
+        {
+            auto const normal = plane.normal.*axis;
+            lower += normal * (normal > 0.0 ? box.lower.*axis : box.upper.*axis);
+            upper += normal * (normal > 0.0 ? box.upper.*axis : box.lower.*axis);
+        }
+        return lower <= 0.0 && upper >= 0.0;
+    };
+
+    // the tree is balanced (@see build), so the stack holds at most two nodes per level
+    std::array<std::size_t, 128> stack;
+    std::size_t stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size)
+    {
+        auto const index = stack[--stack_size];
+        auto const &node = this->_nodes[index];
+        if (!is_cut(node.box))
+        {
+            continue;
+        }
+
+        if (node.size)
+        {
+            for (auto i = node.first; i < node.first + node.size; ++i)
+            {
+                if (is_cut(this->_pieces[i].box))
+                {
+                    visit(this->_pieces[i]);
+                }
+            }
+            continue;
+        }
+
+        stack[stack_size++] = node.right;
+        stack[stack_size++] = index + 1;
+    }
+}
+
+void TrajectoryIndex::solve_crossings(const Piece &piece, const Plane &plane, std::vector<double> &positions) const
+{
+    // the signed distance to the plane (scaled by the normal length) and its derivative
+    auto const crossing_at = [&piece, &plane, this](double position) {
+        auto const trajectory_point = this->_interpolator->point_at_position(
+            position, this->_interpolator->calculate_upper_index(position, piece.upper_index));
+        auto const &vertex = trajectory_point.vertex;
+        auto const tangent = Point{
+            sin(vertex.inclination()) * cos(vertex.azimuth()), sin(vertex.inclination()) * sin(vertex.azimuth()),
+            cos(vertex.inclination())};
+        return std::pair{dot(plane.normal, trajectory_point.point) - plane.offset, dot(plane.normal, tangent)};
+    };
+
+    auto const normal_length = std::sqrt(dot(plane.normal, plane.normal));
+
+    // Newton's method inside the bracket [a, b], whose ends are on opposite sides of the plane. The tangent is the
+    // derivative only for the interpolations parametrised by the curve length (minimum curvature), so the slope
+    // through the last two iterates replaces it when they disagree. The step falls back to the bisection when it
+    // leaves the bracket or does not halve the previous one
+    auto const solve = [&crossing_at, &positions, normal_length](
+                           double a, double distance_a, double b, double distance_b) {
+        auto const a_is_below = distance_a < 0.0;
+        auto x = a - distance_a * (b - a) / (distance_b - distance_a);
+        auto previous_x = x;
+        auto previous_distance = 0.0;
+        auto previous_step = b - a;
+        for (std::size_t iteration = 0; iteration < 100; ++iteration)
+        {
+            auto [distance, derivative] = crossing_at(x);
+            if (distance == 0.0)
+            {
+                break;
+            }
+            ((distance < 0.0) == a_is_below ? a : b) = x;
+            ((distance < 0.0) == a_is_below ? distance_a : distance_b) = distance;
+
+            if (iteration > 0)
+            {
+                auto const slope = (distance - previous_distance) / (x - previous_x);
+                if (std::fabs(slope - derivative) > 1E-2 * std::fabs(slope))
+                {
+                    derivative = slope;
+                }
+            }
+            previous_x = x;
+            previous_distance = distance;
+
+            auto next = derivative != 0.0 ? x - distance / derivative : a;
+            if (!(next > a && next < b) || 2.0 * std::fabs(next - x) > std::fabs(previous_step))
+            {
+                next = (a + b) / 2.0;
+            }
+            previous_step = next - x;
+            x = next;
+            if (std::fabs(previous_step) <= crossing_tolerance(x) || b - a <= crossing_tolerance(x))
+            {
+                break;
+            }
+        }
+
+        // the ends of a bracket around a crossing are not farther from the plane than the curve length between
+        // them (with a margin for the interpolations not parametrised by it): otherwise the sign change is a jump of
+        // the interpolation, as the cubic one at the last vertex
+        if (std::fabs(distance_a) + std::fabs(distance_b) <= 4.0 * normal_length * (b - a) + crossing_tolerance(x))
+        {
+            positions.push_back(x);
+        }
+    };
+
+    // the pieces of a segment lie strictly between its vertices (@see update), so a crossing next to a vertex is
+    // bracketed by the vertex and the end of the piece next to it
+    if (piece.positions.back() > piece.positions.front())
+    {
+        auto const &trajectory = this->_interpolator->trajectory();
+        for (auto const &[a, b] : {std::pair{trajectory[piece.upper_index - 1].position(), piece.positions.front()},
+                                   std::pair{piece.positions.back(), trajectory[piece.upper_index].position()}})
+        {
+            if (std::nextafter(a, b) != b)
+            {
+                continue;
+            }
+
+            auto const distance_a = crossing_at(a).first;
+            auto const distance_b = crossing_at(b).first;
+            if (distance_a != 0.0 && distance_b != 0.0 && (distance_a < 0.0) != (distance_b < 0.0))
+            {
+                solve(a, distance_a, b, distance_b);
+            }
+        }
+    }
+
+    std::array<double, piece_samples + 1> distances{};
+    for (std::size_t i = 0; i <= piece_samples; ++i)
+    {
+        distances[i] = dot(plane.normal, piece.points[i]) - plane.offset;
+        if (distances[i] == 0.0)
+        {
+            positions.push_back(piece.positions[i]);
+        }
+    }
+
+    for (std::size_t i = 0; i < piece_samples; ++i)
+    {
+        auto const a = piece.positions[i];
+        auto const b = piece.positions[i + 1];
+        auto const distance_a = distances[i];
+        auto const distance_b = distances[i + 1];
+        if (!(b > a) || distance_a == 0.0 || distance_b == 0.0)
+        {
+            continue;
+        }
+
+        if ((distance_a < 0.0) != (distance_b < 0.0))
+        {
+            solve(a, distance_a, b, distance_b);
+            continue;
+        }
+
+        // both ends on the same side: the sub-piece is not farther than its radius from the chord, so it only
+        // reaches the plane if an end is that near
+        if (std::min(std::fabs(distance_a), std::fabs(distance_b)) > normal_length * piece.radii[i])
+        {
+            continue;
+        }
+
+        // golden section search of the extremum toward the plane, which splits the sub-piece into two monotone
+        // brackets once it is beyond the plane
+        static constexpr double golden_ratio = 0.3819660112501051;
+        auto const side = distance_a > 0.0 ? 1.0 : -1.0;
+        auto lower = a;
+        auto upper = b;
+        auto c = lower + golden_ratio * (upper - lower);
+        auto d = upper - golden_ratio * (upper - lower);
+        auto distance_c = side * crossing_at(c).first;
+        auto distance_d = side * crossing_at(d).first;
+        auto const tolerance = std::sqrt(std::numeric_limits<double>::epsilon()) * std::fabs(a) + 1E-10;
+        while (distance_c > 0.0 && distance_d > 0.0 && upper - lower > tolerance)
+        {
+            if (distance_c < distance_d)
+            {
+                upper = d;
+                d = c;
+                distance_d = distance_c;
+                c = lower + golden_ratio * (upper - lower);
+                distance_c = side * crossing_at(c).first;
+            }
+            else
+            {
+                lower = c;
+                c = d;
+                distance_c = distance_d;
+                d = upper - golden_ratio * (upper - lower);
+                distance_d = side * crossing_at(d).first;
+            }
+        }
+
+        auto const [extremum, distance_extremum] =
+            distance_c <= distance_d ? std::pair{c, distance_c} : std::pair{d, distance_d};
+        if (distance_extremum == 0.0)
+        {
+            positions.push_back(extremum);
+        }
+        else if (distance_extremum < 0.0)
+        {
+            solve(a, distance_a, extremum, side * distance_extremum);
+            solve(extremum, side * distance_extremum, b, distance_b);
+        }
+    }
+}
+
+ClosestPoint TrajectoryIndex::refine(const Piece &piece, const Point &point, double max_squared_distance) const
+{
+    auto const squared_distance = [&point](const Point &other) {
+        return (other.x - point.x) * (other.x - point.x) + (other.y - point.y) * (other.y - point.y) +
+               (other.z - point.z) * (other.z - point.z);
+    };
+
+    // the chords give a lower bound of the distance and a guess of the position
+    auto lower_bound = std::numeric_limits<double>::max();
+    auto guess_distance = std::numeric_limits<double>::max();
+    auto guess = piece.positions.front();
+    for (std::size_t i = 0; i < piece_samples; ++i)
+    {
+        auto const [nearest, t] = closest_on_chord(piece.points[i], piece.points[i + 1], point);
+        auto const chord_distance = distance(nearest, point);
+        lower_bound = std::min(lower_bound, std::max(chord_distance - piece.radii[i], 0.0));
+        if (chord_distance < guess_distance)
+        {
+            guess_distance = chord_distance;
+            guess = piece.positions[i] + t * (piece.positions[i + 1] - piece.positions[i]);
+        }
+    }
+
+    if (lower_bound * lower_bound >= max_squared_distance)
+    {
+        return {{}, std::numeric_limits<double>::max()};
+    }
+
+    auto const closest_at = [&piece, &squared_distance, this](double position) {
+        auto const trajectory_point = this->_interpolator->point_at_position(
+            position, this->_interpolator->calculate_upper_index(position, piece.upper_index));
+        return ClosestPoint{trajectory_point, squared_distance(trajectory_point.point)};
+    };
+
+    // the distances are squared until the end; the ends are compared with the stored samples
+    auto const first_distance = squared_distance(piece.points.front());
+    auto const last_distance = squared_distance(piece.points.back());
+    auto const end = first_distance <= last_distance ? piece.positions.front() : piece.positions.back();
+    auto const end_distance = std::min(first_distance, last_distance);
+
+    auto a = piece.positions.front();
+    auto b = piece.positions.back();
+    if (!(b > a))
+    {
+        auto closest = closest_at(a);
+        closest.distance = std::sqrt(closest.distance);
+        return closest;
+    }
+
+    auto const relative_tolerance = std::sqrt(std::numeric_limits<double>::epsilon());
+    auto const absolute_tolerance = 1E-10;
+
+    // the point is beyond an end of the chords: the end is the minimum, unless a step inside the piece gets nearer
+    if (guess <= a || guess >= b)
+    {
+        auto const step = 2.0 * (relative_tolerance * std::fabs(guess) + absolute_tolerance);
+        auto closest = closest_at(guess <= a ? a : b);
+        if (closest_at(guess <= a ? a + step : b - step).distance >= closest.distance)
+        {
+            closest.distance = std::sqrt(closest.distance);
+            return closest;
+        }
+    }
+
+    // Brent's method: parabolic steps through the three best points, golden section steps when they fail
+    static constexpr double golden_ratio = 0.3819660112501051;
+
+    // the start is kept off the ends, which are compared apart
+    auto const margin = (b - a) * 1E-3;
+    auto x = std::clamp(guess, a + margin, b - margin);
+    auto best = closest_at(x);
+    auto f_x = best.distance;
+    auto w = x;
+    auto v = x;
+    auto f_w = f_x;
+    auto f_v = f_x;
+
+    // the last step and the step before it
+    auto d = 0.0;
+    auto e = 0.0;
+
+    // the guess is usually near the minimum, then the first step is already parabolic, through the ends
+    if (f_x < end_distance)
+    {
+        w = end;
+        f_w = end_distance;
+        v = end == a ? b : a;
+        f_v = std::max(first_distance, last_distance);
+        d = b - a;
+        e = b - a;
+    }
+
+    for (std::size_t iteration = 0; iteration < 100 && b > a; ++iteration)
+    {
+        auto const middle = (a + b) / 2.0;
+        auto const tolerance = relative_tolerance * std::fabs(x) + absolute_tolerance;
+        if (std::fabs(x - middle) <= 2.0 * tolerance - (b - a) / 2.0)
+        {
+            break;
+        }
+
+        auto parabolic = false;
+        if (std::fabs(e) > tolerance)
+        {
+            auto r = (x - w) * (f_x - f_v);
+            auto q = (x - v) * (f_x - f_w);
+            auto p = (x - v) * q - (x - w) * r;
+            q = 2.0 * (q - r);
+            if (q > 0.0)
+            {
+                p = -p;
+            }
+            q = std::fabs(q);
+            r = e;
+            e = d;
+
+            if (std::fabs(p) < std::fabs(q * r / 2.0) && p > q * (a - x) && p < q * (b - x))
+            {
+                d = p / q;
+                parabolic = true;
+
+                // the parabola through the three best points has its minimum at the best one
+                if (std::fabs(d) < tolerance)
+                {
+                    break;
+                }
+                if (x + d - a < 2.0 * tolerance || b - (x + d) < 2.0 * tolerance)
+                {
+                    d = x < middle ? tolerance : -tolerance;
+                }
+            }
+        }
+        if (!parabolic)
+        {
+            e = (x < middle ? b : a) - x;
+            d = golden_ratio * e;
+        }
+
+        auto const u = x + (std::fabs(d) >= tolerance ? d : (d > 0.0 ? tolerance : -tolerance));
+        auto const candidate = closest_at(u);
+        if (candidate.distance <= f_x)
+        {
+            (u < x ? b : a) = x;
+            v = w;
+            f_v = f_w;
+            w = x;
+            f_w = f_x;
+            x = u;
+            f_x = candidate.distance;
+            best = candidate;
+        }
+        else
+        {
+            (u < x ? a : b) = u;
+            if (candidate.distance <= f_w || w == x)
+            {
+                v = w;
+                f_v = f_w;
+                w = u;
+                f_w = candidate.distance;
+            }
+            else if (candidate.distance <= f_v || v == x || v == w)
+            {
+                v = u;
+                f_v = candidate.distance;
+            }
+        }
+    }
+
+    auto closest = best.distance < end_distance ? best : closest_at(end);
+    closest.distance = std::sqrt(closest.distance);
+    return closest;
+}
+
+} // namespace splines
@@ -1,20 +1,10 @@
 #include "interpolator/Vertex.hpp"
 
+#include <sstream>
+
 namespace splines
 {
 
-Vertex::Vertex(double position, double inclination, double azimuth, AngleUnit angle_unit)
-    : _position(position)
-    , _inclination(inclination)
-    , _azimuth(azimuth)
-{
-    if (angle_unit != AngleUnit::rad)
-    {
-        this->_inclination = this->angle_in(inclination, angle_unit);
-        this->_azimuth = this->angle_in(azimuth, angle_unit);
-    }
-}
-
 std::partial_ordering Vertex::operator<=>(const Vertex &other) const
 {
     return this->_position <=> other._position;
@@ -90,9 +80,32 @@ double Vertex::angle_out(double angle, AngleUnit angle_unit) const
     }
 }
 
-std::string Vertex::delimiter() const
+VertexFormatter::VertexFormatter(std::string delimiter)
+    : _delimiter(std::move(delimiter))
+{
+}
+
+const std::string &VertexFormatter::delimiter() const
 {
     return this->_delimiter;
 }
 
+std::ostream &VertexFormatter::write(std::ostream &os, const Vertex &vt) const
+{
+    os << vt.position() << this->_delimiter << vt.inclination() << this->_delimiter << vt.azimuth();
+    return os;
+}
+
+std::string VertexFormatter::to_string(const Vertex &vt) const
+{
+    std::stringstream ss;
+    this->write(ss, vt);
+    return ss.str();
+}
+
+std::ostream &operator<<(std::ostream &os, const Vertex &vt)
+{
+    return VertexFormatter().write(os, vt);
+}
+
 } // namespace splines
@@ -1,5 +1,8 @@
 #include "interpolator/Vertices.hpp"
 
+#include <functional>
+#include <stdexcept>
+
 namespace splines
 {
 
@@ -18,59 +21,206 @@ Vertices::Vertices(const std::vector<Vertex> &vertices, AngleUnit angle_unit)
     set_vertices(vertices, angle_unit);
 }
 
-const std::set<Vertex> &Vertices::vertices() const
+Vertices::Vertices(
+    std::span<const double> positions, std::span<const double> inclinations, std::span<const double> azimuths,
+    AngleUnit angle_unit)
+{
+    if (inclinations.size() != positions.size() || azimuths.size() != positions.size())
+    {
+        throw std::invalid_argument("Vertices: positions, inclinations and azimuths must have the same size");
+    }
+
+    if (std::adjacent_find(positions.begin(), positions.end(), std::greater_equal<double>()) != positions.end())
+    {
+        std::vector<Vertex> vertices;
+        vertices.reserve(positions.size());
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            vertices.emplace_back(positions[i], inclinations[i], azimuths[i], angle_unit);
+        }
+        this->set_vertices(vertices);
+        return;
+    }
+
+    this->_positions.assign(positions.begin(), positions.end());
+    this->_inclinations.resize(positions.size());
+    this->_azimuths.resize(positions.size());
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        auto const vertex = Vertex(positions[i], inclinations[i], azimuths[i], angle_unit);
+        this->_inclinations[i] = vertex.inclination();
+        this->_azimuths[i] = vertex.azimuth();
+    }
+}
+
+const Vertices &Vertices::vertices() const
 {
-    return this->_vertices;
+    return *this;
 }
 
 std::vector<Vertex> Vertices::vertices_python() const
 {
-    auto vertices_p = std::vector<Vertex>(this->_vertices.size());
-    std::copy(this->_vertices.begin(), this->_vertices.end(), vertices_p.begin());
+    auto vertices_p = std::vector<Vertex>(this->size());
+    std::copy(this->cbegin(), this->cend(), vertices_p.begin());
     return vertices_p;
 }
 
 template <typename VerticesContainer>
 void Vertices::set_vertices(const VerticesContainer &vertices, AngleUnit angle_unit)
 {
-    for (auto &vertex : vertices)
+    // the stored vertices come first, so they win against new vertices at the same position
+    auto merged = this->vertices_python();
+    merged.reserve(merged.size() + std::size(vertices));
+    for (const auto &vertex : vertices)
+    {
+        merged.emplace_back(vertex.position(), vertex.inclination(), vertex.azimuth(), angle_unit);
+    }
+
+    std::stable_sort(merged.begin(), merged.end(), [](const Vertex &v_1, const Vertex &v_2) { return v_1 < v_2; });
+    merged.erase(
+        std::unique(
+            merged.begin(), merged.end(),
+            [](const Vertex &v_1, const Vertex &v_2) { return v_1.position() == v_2.position(); }),
+        merged.end());
+
+    this->_positions.resize(merged.size());
+    this->_inclinations.resize(merged.size());
+    this->_azimuths.resize(merged.size());
+    for (std::size_t i = 0; i < merged.size(); ++i)
     {
-        this->_vertices.emplace(Vertex(vertex.position(), vertex.inclination(), vertex.azimuth(), angle_unit));
+        this->_positions[i] = merged[i].position();
+        this->_inclinations[i] = merged[i].inclination();
+        this->_azimuths[i] = merged[i].azimuth();
     }
+    this->fit_capacity();
 }
 
+template void Vertices::set_vertices(const std::initializer_list<Vertex> &, AngleUnit);
+template void Vertices::set_vertices(const std::set<Vertex> &, AngleUnit);
+template void Vertices::set_vertices(const std::vector<Vertex> &, AngleUnit);
+template void Vertices::set_vertices(const Vertices &, AngleUnit);
+
 void Vertices::add_n_drop(const Vertex &vertex)
 {
-    this->_vertices.emplace(vertex);
-    this->_vertices.erase(*this->_vertices.rbegin());
+    this->insert(vertex);
+    this->erase(this->size() - 1);
 }
 
 void Vertices::drop_n_add(const Vertex &vertex)
 {
-    this->_vertices.erase(*this->_vertices.begin());
-    this->_vertices.emplace(vertex);
+    this->erase(0);
+    this->insert(vertex);
+}
+
+void Vertices::slide(const Vertex &vertex)
+{
+    this->insert(vertex);
+    this->fit_capacity();
+}
+
+void Vertices::set_capacity(std::size_t capacity)
+{
+    this->_capacity = capacity;
+    this->fit_capacity();
+    if (capacity)
+    {
+        // one more than the capacity, since add_n_drop inserts before dropping
+        this->_positions.reserve_window(capacity + 1);
+        this->_inclinations.reserve_window(capacity + 1);
+        this->_azimuths.reserve_window(capacity + 1);
+    }
+}
+
+std::size_t Vertices::capacity() const
+{
+    return this->_capacity;
+}
+
+void Vertices::fit_capacity()
+{
+    while (this->_capacity && this->size() > this->_capacity)
+    {
+        this->erase(0);
+    }
+}
+
+std::optional<std::size_t> Vertices::insert(const Vertex &vertex)
+{
+    auto const it_position = std::lower_bound(this->_positions.begin(), this->_positions.end(), vertex.position());
+    if (it_position != this->_positions.end() && *it_position == vertex.position())
+    {
+        return std::nullopt;
+    }
+
+    auto const index = std::distance(this->_positions.begin(), it_position);
+    this->_positions.insert(it_position, vertex.position());
+    this->_inclinations.insert(this->_inclinations.begin() + index, vertex.inclination());
+    this->_azimuths.insert(this->_azimuths.begin() + index, vertex.azimuth());
+    return static_cast<std::size_t>(index);
+}
+
+void Vertices::erase(std::size_t index)
+{
+    this->_positions.erase(this->_positions.begin() + index);
+    this->_inclinations.erase(this->_inclinations.begin() + index);
+    this->_azimuths.erase(this->_azimuths.begin() + index);
 }
 
 size_t Vertices::size() const
 {
-    return this->_vertices.size();
+    return this->_positions.size();
 }
 
-std::vector<double> Vertices::positions() const
+bool Vertices::empty() const
 {
-    auto res = std::vector<double>(this->_vertices.size());
-    std::transform(this->_vertices.begin(), this->_vertices.end(), res.begin(), [](const Vertex &vt) -> double {
-        return vt.position();
-    });
+    return this->_positions.empty();
+}
 
-    return res;
+Vertex Vertices::operator[](std::size_t index) const
+{
+    return {this->_positions[index], this->_inclinations[index], this->_azimuths[index]};
+}
+
+Vertex Vertices::front() const
+{
+    return (*this)[0];
+}
+
+Vertex Vertices::back() const
+{
+    return (*this)[this->size() - 1];
+}
+
+std::size_t Vertices::upper_bound_index(double position) const
+{
+    auto const *first = this->_positions.data();
+    auto length = this->_positions.size();
+    if (!length)
+    {
+        return 0;
+    }
+
+    // the loop has a fixed number of iterations for a given size and the conditional is a select, not a branch
+    while (length > 1)
+    {
+        auto const half = length / 2;
+        first = first[half] <= position ? first + half : first;
+        length -= half;
+    }
+
+    return static_cast<std::size_t>(first - this->_positions.data()) + (*first <= position);
+}
+
+std::vector<double> Vertices::positions() const
+{
+    return {this->_positions.begin(), this->_positions.end()};
 }
 
 std::vector<double> Vertices::inclinations(AngleUnit angle_unit) const
 {
-    auto res = std::vector<double>(this->_vertices.size());
+    auto res = std::vector<double>(this->size());
     std::transform(
-        this->_vertices.begin(), this->_vertices.end(), res.begin(),
+        this->cbegin(), this->cend(), res.begin(),
         [angle_unit = angle_unit](const Vertex &vt) -> double { return vt.inclination(angle_unit); });
 
     return res;
@@ -78,9 +228,9 @@ std::vector<double> Vertices::inclinations(AngleUnit angle_unit) const
 
 std::vector<double> Vertices::azimuths(AngleUnit angle_unit) const
 {
-    auto res = std::vector<double>(this->_vertices.size());
+    auto res = std::vector<double>(this->size());
     std::transform(
-        this->_vertices.begin(), this->_vertices.end(), res.begin(),
+        this->cbegin(), this->cend(), res.begin(),
         [angle_unit = angle_unit](const Vertex &vt) -> double { return vt.azimuth(angle_unit); });
 
     return res;
@@ -89,33 +239,58 @@ std::vector<double> Vertices::azimuths(AngleUnit angle_unit) const
 bool Vertices::approx_equal(const Vertices &other, double tol_radius) const
 {
     return std::equal(
-        this->_vertices.cbegin(), this->_vertices.cend(), other.cbegin(), other.cend(),
+        this->cbegin(), this->cend(), other.cbegin(), other.cend(),
         [tol_radius = tol_radius](const Vertex &v1, const Vertex &v2) { return v1.approx_equal(v2, tol_radius); });
 }
 
 std::string Vertices::delimiter() const
 {
-    return this->_vertices.cbegin()->delimiter();
+    return VertexFormatter().delimiter();
+}
+
+std::span<const double> Vertices::positions_view() const
+{
+    return {this->_positions.data(), this->_positions.size()};
+}
+
+std::span<const double> Vertices::inclinations_view() const
+{
+    return {this->_inclinations.data(), this->_inclinations.size()};
+}
+
+std::span<const double> Vertices::azimuths_view() const
+{
+    return {this->_azimuths.data(), this->_azimuths.size()};
+}
+
+Vertices::const_iterator Vertices::begin() const
+{
+    return {this, 0};
+}
+
+Vertices::const_iterator Vertices::end() const
+{
+    return {this, this->size()};
 }
 
-std::set<Vertex>::iterator Vertices::begin()
+Vertices::const_iterator Vertices::cbegin() const
 {
-    return this->_vertices.begin();
+    return this->begin();
 }
 
-std::set<Vertex>::iterator Vertices::end()
+Vertices::const_iterator Vertices::cend() const
 {
-    return this->_vertices.end();
+    return this->end();
 }
 
-std::set<Vertex>::const_iterator Vertices::cbegin() const
+Vertices::const_reverse_iterator Vertices::rbegin() const
 {
-    return this->_vertices.cbegin();
+    return const_reverse_iterator(this->end());
 }
 
-std::set<Vertex>::const_iterator Vertices::cend() const
+Vertices::const_reverse_iterator Vertices::rend() const
 {
-    return this->_vertices.cend();
+    return const_reverse_iterator(this->begin());
 }
 
 } // namespace splines
@@ -1,6 +1,10 @@
 from _interpolator import (
     AngleUnit,
+    AntiCollisionScan,
+    IInterpolator,
     InterpolatorFactory,
+    PositionGrid,
+    TrajectoryIndex,
     Vertex,
     Vertices,
 )
@@ -43,13 +47,61 @@ def interpolation_samples_SPE84246():
     )
 
 
-def _make_interpolator(trajectory, interpolation_type):
+def _make_interpolator(trajectory, interpolation_type, capacity=0):
     if interpolation_type == InterpolationType.Linear:
-        return InterpolatorFactory.MakeLinearInterpolator(trajectory)
+        return InterpolatorFactory.MakeLinearInterpolator(trajectory, capacity)
     elif interpolation_type == InterpolationType.MinimumCurvature:
-        return InterpolatorFactory.MakeMinimumCurvatureInterpolator(trajectory)
+        return InterpolatorFactory.MakeMinimumCurvatureInterpolator(
+            trajectory, capacity
+        )
     elif interpolation_type == InterpolationType.Cubic:
-        return InterpolatorFactory.MakeCubicInterpolator(trajectory)
+        return InterpolatorFactory.MakeCubicInterpolator(trajectory, capacity)
+
+
+class _PythonInterpolator(IInterpolator):
+    """
+    An interpolator extended in Python: it forwards to a C++ interpolator and records
+    the overrides called from C++
+    """
+
+    def __init__(self, interpolator):
+        IInterpolator.__init__(self)
+        self.interpolator = interpolator
+        self.calls = []
+
+    def Evaluate(self, positions, num_threads):
+        self.calls.append("Evaluate")
+        return self.interpolator.Evaluate(positions, num_threads)
+
+    def GenerateVertices(self, num_vertices_or_grid, num_threads):
+        self.calls.append("GenerateVertices")
+        return self.interpolator.GenerateVertices(num_vertices_or_grid, num_threads)
+
+    def GeneratePoints(self, num_points_or_grid, num_threads):
+        self.calls.append("GeneratePoints")
+        return self.interpolator.GeneratePoints(num_points_or_grid, num_threads)
+
+    def GenerateChunks(
+        self, num_points_or_grid, chunk_size, consumer, num_threads, prefetch
+    ):
+        self.calls.append("GenerateChunks")
+        self.interpolator.GenerateChunks(
+            num_points_or_grid, chunk_size, consumer, num_threads, prefetch
+        )
+
+    def GenerateAdaptivePoints(self, max_chord_deviation, max_angle, num_threads):
+        self.calls.append("GenerateAdaptivePoints")
+        return self.interpolator.GenerateAdaptivePoints(
+            max_chord_deviation, max_angle, num_threads
+        )
+
+    def IntervalAggregates(self, first_position, last_position):
+        self.calls.append("IntervalAggregates")
+        return self.interpolator.IntervalAggregates(first_position, last_position)
+
+    def Slide(self, vertex):
+        self.calls.append("Slide")
+        self.interpolator.Slide(vertex)
 
 
 def test_readme_example():
@@ -230,9 +282,543 @@ def test_generate_vertices(
         interpolator.GenerateVertices(num_vertices, 8),
     ]
 
-    def vertices_cmp(v_1, v_2):
-        for i, _ in enumerate(v_1):
-            assert v_1[i].ApproxEqual(v_2[i])
+    assert vertices_expected.shape == (num_vertices, 3)
 
     for vertices in vertices_mt:
-        vertices_cmp(vertices_expected, vertices)
+        assert np.allclose(vertices_expected, vertices)
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_numpy_arrays(trajectory_SPE84246, interpolation_type):
+    num_points = 100
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type)
+
+    vertices = interpolator.GenerateVertices(num_points)
+    projections_x = interpolator.GenerateXProjections(num_points)
+    projections_z = interpolator.GenerateZProjections(num_points)
+
+    assert isinstance(projections_x, np.ndarray)
+    assert projections_x.shape == (num_points,)
+    assert projections_x.dtype == np.float64
+
+    for i in (0, num_points // 2, num_points - 1):
+        vertex = interpolator.VertexAtPosition(vertices[i, 0])
+        assert pytest.approx(vertices[i, 1]) == vertex.Inclination()
+        assert pytest.approx(vertices[i, 2]) == vertex.Azimuth()
+        assert pytest.approx(projections_x[i]) == interpolator.XAtPosition(vertices[i, 0])
+        assert pytest.approx(projections_z[i]) == interpolator.ZAtPosition(vertices[i, 0])
+
+    positions = trajectory_SPE84246.Positions()
+    assert np.allclose(positions, [v.Position() for v in trajectory_SPE84246.Vertices()])
+    assert np.allclose(
+        trajectory_SPE84246.Inclinations(AngleUnit.Deg),
+        np.degrees(trajectory_SPE84246.Inclinations(AngleUnit.Rad)),
+    )
+
+
+def test_trajectory_arrays_outlive_changes(trajectory_SPE84246):
+    positions = trajectory_SPE84246.Positions()
+    inclinations = trajectory_SPE84246.Inclinations(AngleUnit.Rad)
+    expected_positions = np.array(positions)
+    expected_inclinations = np.array(inclinations)
+
+    trajectory_SPE84246.SetVertices([Vertex(1.0, 0.1, 0.2), Vertex(2.0, 0.3, 0.4)])
+    trajectory_SPE84246.DropNAdd(Vertex(3.0, 0.5, 0.6))
+
+    assert np.array_equal(positions, expected_positions)
+    assert np.array_equal(inclinations, expected_inclinations)
+    assert np.allclose(trajectory_SPE84246.Positions(), [2.0, 3.0])
+
+
+def test_trajectory_from_arrays(trajectory_SPE84246):
+    positions = np.array(trajectory_SPE84246.Positions())
+    inclinations = trajectory_SPE84246.Inclinations(AngleUnit.Deg)
+    azimuths = trajectory_SPE84246.Azimuths(AngleUnit.Deg)
+
+    trajectory_columns = Vertices(positions, inclinations, azimuths, AngleUnit.Deg)
+    trajectory_table = Vertices(
+        np.column_stack([positions, inclinations, azimuths]), AngleUnit.Deg
+    )
+
+    assert trajectory_columns.ApproxEqual(trajectory_SPE84246)
+    assert trajectory_table.ApproxEqual(trajectory_SPE84246)
+
+    with pytest.raises(ValueError):
+        Vertices(positions, inclinations, azimuths[:-1])
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_evaluate_in_python_threads(trajectory_SPE84246, interpolation_type):
+    from concurrent.futures import ThreadPoolExecutor
+
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type)
+
+    positions = np.linspace(0.0, 3100.0, 1000)
+    vertices, points = interpolator.Evaluate(positions, 1)
+    assert vertices.shape == (positions.size, 3)
+    assert points.shape == (positions.size, 3)
+    for i in (0, 500, 999):
+        assert pytest.approx(points[i, 0]) == interpolator.XAtPosition(positions[i])
+        assert pytest.approx(vertices[i, 1]) == interpolator.InclinationAtPosition(
+            positions[i]
+        )
+
+    # the GIL is released while interpolating, so the calls may overlap
+    with ThreadPoolExecutor(max_workers=4) as executor:
+        results = list(
+            executor.map(lambda _: interpolator.Evaluate(positions, 1), range(8))
+        )
+    for vertices_mt, points_mt in results:
+        assert np.array_equal(vertices, vertices_mt)
+        assert np.array_equal(points, points_mt)
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+@pytest.mark.parametrize("prefetch", [False, True], ids=["sequential", "prefetch"])
+def test_generate_chunks(trajectory_SPE84246, interpolation_type, prefetch):
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type)
+
+    num_points = 1000
+    vertices = interpolator.GenerateVertices(num_points)
+    x_projections = interpolator.GenerateXProjections(num_points)
+
+    offsets = []
+
+    def consumer(offset, vertices_chunk, points_chunk):
+        offsets.append(offset)
+        size = vertices_chunk.shape[0]
+        assert points_chunk.shape == (size, 3)
+        assert np.allclose(vertices_chunk, vertices[offset : offset + size])
+        assert np.allclose(points_chunk[:, 0], x_projections[offset : offset + size])
+
+    interpolator.GenerateChunks(num_points, 128, consumer, prefetch=prefetch)
+    assert offsets == list(range(0, num_points, 128))
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_trajectory_window(trajectory_SPE84246, interpolation_type):
+    capacity = 8
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type, capacity)
+    assert interpolator.Trajectory().Capacity() == capacity
+
+    for i in range(1, 21):
+        interpolator.Slide(Vertex(3100.0 + 30.0 * i, 1.2, 4.9 - 0.02 * i))
+    positions = interpolator.Trajectory().Positions()
+    assert np.array_equal(positions, 3100.0 + 30.0 * np.arange(13, 21))
+
+    expected = _make_interpolator(interpolator.Trajectory(), interpolation_type)
+    for position in np.linspace(positions[0], positions[-1], 50):
+        assert pytest.approx(expected.XAtPosition(position)) == interpolator.XAtPosition(
+            position
+        )
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_position_grid(trajectory_SPE84246, interpolation_type):
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type)
+    stations = interpolator.Trajectory().Positions()
+
+    assert len(PositionGrid.FixedStep(0.0, 90.0, 30.0)) == 4
+    logarithmic = PositionGrid.Logarithmic(1.0, 1000.0, 4)
+    assert np.allclose(logarithmic.Positions(), [1.0, 10.0, 100.0, 1000.0])
+    with pytest.raises(ValueError):
+        PositionGrid.Logarithmic(0.0, 1000.0, 4)
+
+    grid = PositionGrid.FixedStep(stations[0], stations[-1], 30.0).WithStations(stations)
+    positions = grid.Positions()
+    assert len(positions) == grid.Size()
+    assert np.all(np.diff(positions) > 0.0)
+    assert np.all(np.isin(stations, positions))
+    assert grid[len(grid) - 1] == stations[-1]
+
+    points = interpolator.GeneratePoints(grid)
+    assert np.array_equal(points[:, 0], positions)
+    assert np.allclose(interpolator.GenerateVertices(grid), points[:, :3])
+    for i in range(0, len(grid), 17):
+        assert pytest.approx(interpolator.XAtPosition(positions[i])) == points[i, 3]
+
+    offsets = []
+    interpolator.GenerateChunks(
+        grid, 32, lambda offset, vertices, points: offsets.append(offset)
+    )
+    assert offsets == list(range(0, len(grid), 32))
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_trajectory_index(trajectory_SPE84246, interpolation_type):
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type)
+    index = TrajectoryIndex(interpolator)
+
+    points = interpolator.GeneratePoints(50)[:, 3:] + np.array([30.0, -20.0, 10.0])
+    closest = index.ClosestPoints(points)
+    assert closest.shape == (50, 7)
+
+    stations = interpolator.Trajectory().Positions()
+    step = (stations[-1] - stations[0]) / 100000
+    grid = PositionGrid.Uniform(stations[0], step, 100000).WithStations(stations)
+    dense = interpolator.GeneratePoints(grid)
+    for i in range(0, 50, 7):
+        x, y, z = points[i]
+        expected = np.min(np.linalg.norm(dense[:, 3:] - points[i], axis=1))
+        assert closest[i, 6] <= expected + 1e-4
+        assert closest[i, 6] == pytest.approx(expected, abs=0.1)
+
+        closest_point = index.ClosestPoint(x, y, z)
+        assert closest_point.distance == closest[i, 6]
+        assert closest_point.point.vertex.Position() == closest[i, 0]
+
+        segments = index.NearestSegments(x, y, z, 2)
+        assert len(segments) == 2
+        assert segments[0].distance == closest_point.distance
+        assert segments[0].distance <= segments[1].distance
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_positions_at_plane(trajectory_SPE84246, interpolation_type):
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type)
+    index = TrajectoryIndex(interpolator)
+
+    # formation tops, the deepest below the trajectory
+    tops = np.array([300.0, 1000.0, 1500.0, 5000.0])
+    crossings = index.PositionsAtZ(tops)
+    assert len(crossings) == len(tops)
+    for top, positions in zip(tops, crossings):
+        for position in positions:
+            assert interpolator.ZAtPosition(position) == pytest.approx(top, abs=1e-9)
+    assert len(crossings[0]) >= 1
+    assert len(crossings[-1]) == 0
+
+    positions = index.PositionsAtPlane(0.0, 0.0, 1.0, 1000.0)
+    assert np.array_equal(positions, crossings[1])
+
+    for position in index.PositionsAtX(np.array([100.0]))[0]:
+        assert interpolator.XAtPosition(position) == pytest.approx(100.0, abs=1e-9)
+    for position in index.PositionsAtY(np.array([250.0]))[0]:
+        assert interpolator.YAtPosition(position) == pytest.approx(250.0, abs=1e-9)
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_interval_aggregates(trajectory_SPE84246, interpolation_type):
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type)
+
+    stations = interpolator.Trajectory().Positions()
+    grid = PositionGrid.Uniform(1000.0, 0.01, 150001)
+    dense = interpolator.GeneratePoints(grid)[:, 3:]
+
+    aggregates = interpolator.IntervalAggregates(1000.0, 2500.0)
+    lower = np.array([aggregates.lower.x, aggregates.lower.y, aggregates.lower.z])
+    upper = np.array([aggregates.upper.x, aggregates.upper.y, aggregates.upper.z])
+    assert np.all(lower <= np.min(dense, axis=0) + 1e-9)
+    assert np.allclose(lower, np.min(dense, axis=0), atol=1e-3)
+    assert np.all(upper >= np.max(dense, axis=0) - 1e-9)
+    assert np.allclose(upper, np.max(dense, axis=0), atol=1e-3)
+    assert 0.0 < aggregates.max_dogleg <= np.pi
+    assert aggregates.max_dogleg_severity > 0.0
+
+    # the range is clamped to the trajectory
+    whole = interpolator.IntervalAggregates(stations[0], stations[-1])
+    clamped = interpolator.IntervalAggregates(-100.0, 5000.0)
+    assert clamped.max_dogleg == whole.max_dogleg
+    assert clamped.upper.z == whole.upper.z
+
+    with pytest.raises(ValueError):
+        interpolator.IntervalAggregates(2500.0, 1000.0)
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_generate_adaptive_points(trajectory_SPE84246, interpolation_type):
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type)
+    stations = interpolator.Trajectory().Positions()
+
+    points = interpolator.GenerateAdaptivePoints(0.05)
+    assert points.shape[1] == 6
+    assert np.all(np.diff(points[:, 0]) > 0.0)
+    assert np.all(np.isin(stations, points[:, 0]))
+    assert len(points) < (stations[-1] - stations[0]) / 4
+
+    # a tighter tolerance samples more, the threads do not change the points
+    assert len(interpolator.GenerateAdaptivePoints(0.01)) > len(points)
+    assert len(interpolator.GenerateAdaptivePoints(1e6, 0.01)) > len(stations)
+    assert np.array_equal(
+        interpolator.GenerateAdaptivePoints(0.05, num_threads=1),
+        interpolator.GenerateAdaptivePoints(0.05, num_threads=4),
+    )
+
+    with pytest.raises(ValueError):
+        interpolator.GenerateAdaptivePoints(0.0)
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_anti_collision_scan(trajectory_SPE84246, interpolation_type):
+    reference = _make_interpolator(trajectory_SPE84246, interpolation_type)
+    offset = _make_interpolator(trajectory_SPE84246, interpolation_type)
+
+    scan = AntiCollisionScan(reference, 500.0)
+    scan.AddOffset(offset, 30.0, -20.0, 10.0)
+    scan.AddOffset(offset, 10000.0)
+
+    stations = reference.Trajectory().Positions()
+    grid = PositionGrid.FixedStep(stations[0], stations[-1], 30.0)
+    near, far = scan.Scan(grid)
+
+    # the offset is the reference moved by its origin
+    separation = near.offset_points
+    assert separation.shape == (len(grid), 7)
+    assert np.all(separation[:, 6] <= np.linalg.norm([30.0, -20.0, 10.0]) + 1e-6)
+    assert separation[near.minimum_index, 6] == np.min(separation[:, 6])
+
+    # beyond the scan radius
+    assert np.all(far.offset_points[:, 6] == np.finfo(np.float64).max)
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_python_evaluate(trajectory_SPE84246, interpolation_type):
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type)
+    python_interpolator = _PythonInterpolator(interpolator)
+
+    # the C++ method dispatches to the override, which gets and returns arrays
+    positions = np.linspace(300.0, 3000.0, 100)
+    vertices, points = IInterpolator.Evaluate(python_interpolator, positions, 1)
+    assert python_interpolator.calls == ["Evaluate"]
+    expected_vertices, expected_points = interpolator.Evaluate(positions, 1)
+    assert np.array_equal(vertices, expected_vertices)
+    assert np.array_equal(points, expected_points)
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_python_generate_points(trajectory_SPE84246, interpolation_type):
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type)
+    python_interpolator = _PythonInterpolator(interpolator)
+
+    # the override returns the (N,6) table, which is copied back to C++
+    points = IInterpolator.GeneratePoints(python_interpolator, 100, 1)
+    assert python_interpolator.calls == ["GeneratePoints"]
+    assert points.shape == (100, 6)
+    assert np.array_equal(points, interpolator.GeneratePoints(100, 1))
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_python_generate_chunks(trajectory_SPE84246, interpolation_type):
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type)
+    python_interpolator = _PythonInterpolator(interpolator)
+
+    num_points = 1000
+    vertices = interpolator.GenerateVertices(num_points)
+    grid = PositionGrid.FixedStep(500.0, 2500.0, 7.0)
+    grid_vertices = interpolator.GenerateVertices(grid)
+
+    def make_consumer(expected, offsets):
+        def consumer(offset, vertices_chunk, points_chunk):
+            offsets.append(offset)
+            size = vertices_chunk.shape[0]
+            assert points_chunk.shape == (size, 3)
+            assert np.allclose(vertices_chunk, expected[offset : offset + size])
+
+        return consumer
+
+    # the override gets a consumer of the chunk tables, which calls the C++ consumer
+    offsets = []
+    IInterpolator.GenerateChunks(
+        python_interpolator, num_points, 128, make_consumer(vertices, offsets)
+    )
+    assert offsets == list(range(0, num_points, 128))
+
+    offsets = []
+    IInterpolator.GenerateChunks(
+        python_interpolator, grid, 128, make_consumer(grid_vertices, offsets)
+    )
+    assert offsets == list(range(0, len(grid), 128))
+    assert python_interpolator.calls == ["GenerateChunks", "GenerateChunks"]
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_python_slide(trajectory_SPE84246, interpolation_type):
+    capacity = 4
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type, capacity)
+    python_interpolator = _PythonInterpolator(interpolator)
+
+    # the override slides the window of the C++ interpolator
+    IInterpolator.Slide(python_interpolator, Vertex(3100.0, 2.0, 5.0))
+    assert python_interpolator.calls == ["Slide"]
+    positions = interpolator.Trajectory().Positions()
+    assert len(positions) == capacity
+    assert positions[0] == 598.800936
+    assert positions[-1] == 3100.0
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_python_generate_from_grid(trajectory_SPE84246, interpolation_type):
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type)
+    python_interpolator = _PythonInterpolator(interpolator)
+
+    stations = interpolator.Trajectory().Positions()
+    grid = PositionGrid.FixedStep(stations[0], stations[-1], 30.0)
+
+    # the overrides get the grid and return the tables
+    vertices = IInterpolator.GenerateVertices(python_interpolator, grid, 1)
+    points = IInterpolator.GeneratePoints(python_interpolator, grid, 1)
+    assert python_interpolator.calls == ["GenerateVertices", "GeneratePoints"]
+    assert vertices.shape == (len(grid), 3)
+    assert np.array_equal(vertices, interpolator.GenerateVertices(grid, 1))
+    assert np.array_equal(points, interpolator.GeneratePoints(grid, 1))
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_python_interval_aggregates(trajectory_SPE84246, interpolation_type):
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type)
+    python_interpolator = _PythonInterpolator(interpolator)
+
+    aggregates = IInterpolator.IntervalAggregates(python_interpolator, 1000.0, 2500.0)
+    assert python_interpolator.calls == ["IntervalAggregates"]
+    expected = interpolator.IntervalAggregates(1000.0, 2500.0)
+    assert aggregates.max_dogleg == expected.max_dogleg
+    assert aggregates.max_dogleg_severity == expected.max_dogleg_severity
+    assert aggregates.lower.z == expected.lower.z
+    assert aggregates.upper.z == expected.upper.z
+
+
+@pytest.mark.parametrize(
+    "interpolation_type",
+    [
+        InterpolationType.Linear,
+        InterpolationType.MinimumCurvature,
+        InterpolationType.Cubic,
+    ],
+    ids=["linear", "minimum_curvature", "cubic"],
+)
+def test_python_generate_adaptive_points(trajectory_SPE84246, interpolation_type):
+    interpolator = _make_interpolator(trajectory_SPE84246, interpolation_type)
+    python_interpolator = _PythonInterpolator(interpolator)
+
+    points = IInterpolator.GenerateAdaptivePoints(python_interpolator, 0.05, 0.01, 1)
+    assert python_interpolator.calls == ["GenerateAdaptivePoints"]
+    assert points.shape[1] == 6
+    assert np.array_equal(points, interpolator.GenerateAdaptivePoints(0.05, 0.01, 1))